@@ -0,0 +1,27 @@
+include(CMakeParseArguments)
+
+# sbmlsim_add_model(<target> <sbml> [NAMESPACE <namespace>])
+#
+# Generates <target>.h and <target>.cpp from an SBML file at build time with sbmlsim-model-compiler and builds
+# them into a static library. The header defines <namespace>::Model (namespace defaults to the target name)
+# and is added to the public include directories of the target.
+function(sbmlsim_add_model target sbml)
+  cmake_parse_arguments(MODEL "" "NAMESPACE" "" ${ARGN})
+  if(NOT MODEL_NAMESPACE)
+    string(MAKE_C_IDENTIFIER ${target} MODEL_NAMESPACE)
+  endif()
+
+  get_filename_component(sbml_path ${sbml} ABSOLUTE)
+  set(output_dir ${CMAKE_CURRENT_BINARY_DIR}/${target})
+
+  add_custom_command(
+    OUTPUT ${output_dir}/${target}.h ${output_dir}/${target}.cpp
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${output_dir}
+    COMMAND sbmlsim-model-compiler ${sbml_path} ${output_dir} ${target} ${MODEL_NAMESPACE}
+    DEPENDS sbmlsim-model-compiler ${sbml_path}
+    COMMENT "Generating model ${target} from ${sbml}"
+    )
+
+  add_library(${target} STATIC ${output_dir}/${target}.cpp)
+  target_include_directories(${target} PUBLIC ${output_dir} ${LIBSBMLSIM_INCLUDE_DIR} ${Boost_INCLUDE_DIRS})
+endfunction()
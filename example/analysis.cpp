@@ -0,0 +1,44 @@
+#include <iostream>
+#include <sbmlsim/SBMLSim.h>
+
+using namespace std;
+
+int main(int argc, const char* argv[]) {
+  double start = 0.0;
+  double duration = 10.0;
+  double dt = 0.1;
+  vector<OutputField> outputFiels {
+      OutputField("S1", OutputType::AMOUNT),
+      OutputField("S2", OutputType::AMOUNT)
+  };
+
+  RunConfiguration conf(start, duration, dt, outputFiels);
+
+  // steady state
+  SteadyState steadyState = SBMLSim::findSteadyState(argv[1], conf);
+  if (!steadyState.isConverged()) {
+    cerr << "no steady state found" << endl;
+    return 1;
+  }
+  for (auto i = 0; i < steadyState.ids.size(); i++) {
+    cout << steadyState.ids[i] << "," << steadyState.values[i] << endl;
+  }
+
+  // mean of 1000 SSA trajectories
+  conf.setIntegrationMethod(IntegrationMethod::SSA);
+  EnsembleStatistics statistics = SBMLSim::simulateEnsemble(argv[1], conf, 1000);
+  cout << "time";
+  for (auto &id : statistics.ids) {
+    cout << "," << id;
+  }
+  cout << endl;
+  for (auto k = 0; k < statistics.times.size(); k++) {
+    cout << statistics.times[k];
+    for (auto mean : statistics.means[k]) {
+      cout << "," << mean;
+    }
+    cout << endl;
+  }
+
+  return 0;
+}
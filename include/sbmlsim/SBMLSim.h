@@ -5,11 +5,21 @@
 #include <string>
 #include "sbmlsim/config/RunConfiguration.h"
 #include "sbmlsim/internal/wrapper/ModelWrapper.h"
+#include "sbmlsim/internal/system/SBMLSystem.h"
+#include "sbmlsim/internal/solver/SteadyStateSolver.h"
+#include "sbmlsim/internal/stochastic/CLESimulator.h"
+#include "sbmlsim/internal/stochastic/StochasticEnsemble.h"
 
 class SBMLSim {
  public:
   static void simulate(const std::string &filepath, const RunConfiguration &conf);
   static void simulate(const SBMLDocument *document, const RunConfiguration &conf);
+  static SteadyState findSteadyState(const std::string &filepath, const RunConfiguration &conf);
+  static SteadyState findSteadyState(const SBMLDocument *document, const RunConfiguration &conf);
+  static EnsembleStatistics simulateEnsemble(const std::string &filepath, const RunConfiguration &conf,
+                                             unsigned long numTrajectories, unsigned int numThreads = 0);
+  static EnsembleStatistics simulateEnsemble(const SBMLDocument *document, const RunConfiguration &conf,
+                                             unsigned long numTrajectories, unsigned int numThreads = 0);
  private:
   SBMLSim() {}
   ~SBMLSim() {}
@@ -18,6 +28,18 @@ class SBMLSim {
   static void simulateRungeKuttaDopri5(const ModelWrapper *model, const RunConfiguration &conf);
   static void simulateRungeKuttaFehlberg78(const ModelWrapper *model, const RunConfiguration &conf);
   static void simulateRosenbrock4(const ModelWrapper *model, const RunConfiguration &conf);
+  static void simulateBDF(const ModelWrapper *model, const RunConfiguration &conf);
+  static void simulateAutoSwitching(const ModelWrapper *model, const RunConfiguration &conf);
+  static void simulateSSA(const ModelWrapper *model, const RunConfiguration &conf);
+  static void simulateNextReaction(const ModelWrapper *model, const RunConfiguration &conf);
+  static void simulateTauLeaping(const ModelWrapper *model, const RunConfiguration &conf);
+  static void simulateHybrid(const ModelWrapper *model, const RunConfiguration &conf);
+  static void simulateCLE(const ModelWrapper *model, const RunConfiguration &conf, CLEScheme scheme);
+  static void simulateLNA(const ModelWrapper *model, const RunConfiguration &conf);
+  static SteadyState findSteadyState(const ModelWrapper *model, const RunConfiguration &conf);
+  static EnsembleStatistics simulateEnsemble(const ModelWrapper *model, const RunConfiguration &conf,
+                                             unsigned long numTrajectories, unsigned int numThreads);
+  static void prepareNativeModel(SBMLSystem &system, const RunConfiguration &conf);
 };
 
 #endif /* INCLUDE_SBMLSIM_SBMLSIM_H_ */
@@ -5,6 +5,9 @@
 #include <vector>
 #include "sbmlsim/config/OutputField.h"
 
+enum class IntegrationMethod;
+enum class JacobianMethod;
+
 class RunConfiguration {
  public:
   RunConfiguration(double duration, double stepInterval, std::vector<OutputField> outputFields,
@@ -18,6 +21,14 @@ class RunConfiguration {
   const std::vector<OutputField> &getOutputFields() const;
   double getAbsoluteTolerance() const;
   double getRelativeTolerance() const;
+  void setJitEnabled(bool jitEnabled);
+  bool isJitEnabled() const;
+  void setIntegrationMethod(IntegrationMethod integrationMethod);
+  IntegrationMethod getIntegrationMethod() const;
+  void setJacobianMethod(JacobianMethod jacobianMethod);
+  JacobianMethod getJacobianMethod() const;
+  void setSeed(unsigned long seed);
+  unsigned long getSeed() const;
  private:
   const double start;
   const double duration;
@@ -25,6 +36,33 @@ class RunConfiguration {
   const std::vector<OutputField> outputFields;
   const double absoluteTolerance;
   const double relativeTolerance;
+  bool jitEnabled;
+  IntegrationMethod integrationMethod;
+  JacobianMethod jacobianMethod;  // of ROSENBROCK4, BDF, AUTOMATIC, LNA and findSteadyState
+  unsigned long seed;  // of the random number generator of stochastic methods
+};
+
+enum class IntegrationMethod {
+  RUNGE_KUTTA_4,
+  RUNGE_KUTTA_DOPRI5,
+  RUNGE_KUTTA_FEHLBERG78,
+  ROSENBROCK4,
+  BDF,
+  AUTOMATIC,           // dopri5, switching to BDF while the model is stiff
+  SSA,                 // Gillespie's stochastic simulation algorithm, species in molecule counts
+  NEXT_REACTION,       // Gibson and Bruck's next reaction method, exact like SSA
+  TAU_LEAPING,         // adaptive tau-leaping, falling back to SSA steps near depletion
+  HYBRID,              // fast reactions as ODEs, slow ones fired stochastically, repartitioned as it runs
+  CLE_EULER_MARUYAMA,  // chemical Langevin equation, Euler-Maruyama
+  CLE_MILSTEIN,        // chemical Langevin equation, derivative-free Milstein
+  LNA                  // linear noise approximation, means followed by variances
+};
+
+// how the Jacobian of implicit methods is computed (see SBMLSystemJacobi)
+enum class JacobianMethod {
+  AUTOMATIC_DIFFERENTIATION,
+  SYMBOLIC_DIFFERENTIATION,
+  FINITE_DIFFERENCE
 };
 
 #endif /* INCLUDE_SBMLSIM_CONFIG_RUNCONFIGURATION_H_ */
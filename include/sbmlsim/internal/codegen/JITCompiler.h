@@ -0,0 +1,34 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_CODEGEN_JITCOMPILER_H_
+#define INCLUDE_SBMLSIM_INTERNAL_CODEGEN_JITCOMPILER_H_
+
+#include <memory>
+#include <string>
+#include "sbmlsim/internal/codegen/NativeModel.h"
+#include "sbmlsim/internal/system/SBMLSystem.h"
+
+/*
+ * Generates C++ source for an SBMLSystem, builds it into a shared object with the host compiler and loads it.
+ * Shared objects are cached on disk keyed by the SHA-256 of the generated source and the compiler command, so a
+ * model is compiled only once. The cache directory must be owned by the current user with mode 0700, and a cached
+ * object is loaded only if it is a regular file owned by the current user that nobody else can write.
+ * Returns nullptr when anything fails; the caller keeps using the interpreter.
+ *
+ * Environment variables:
+ *   SBMLSIM_JIT_CXX        compiler command (default: $CXX, then c++)
+ *   SBMLSIM_JIT_CACHE_DIR  cache directory (default: $XDG_CACHE_HOME/sbmlsim or $HOME/.cache/sbmlsim,
+ *                          then /tmp/sbmlsim-<uid>)
+ */
+class JITCompiler {
+ public:
+  static std::shared_ptr<NativeModel> compile(SBMLSystem &system);
+  static std::shared_ptr<NativeModel> compile(const std::string &source);
+ private:
+  JITCompiler() {}
+  ~JITCompiler() {}
+  static std::string getCompiler();
+  static std::string getCacheDirectory();
+  static bool createPrivateDirectory(const std::string &path);
+  static bool isTrustedFile(const std::string &path);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_CODEGEN_JITCOMPILER_H_ */
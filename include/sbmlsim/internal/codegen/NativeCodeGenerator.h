@@ -0,0 +1,32 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_CODEGEN_NATIVECODEGENERATOR_H_
+#define INCLUDE_SBMLSIM_INTERNAL_CODEGEN_NATIVECODEGENERATOR_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "sbmlsim/internal/compiler/CompiledExpression.h"
+#include "sbmlsim/internal/compiler/SymbolTable.h"
+#include "sbmlsim/internal/system/SBMLSystem.h"
+
+class NativeCodeGenerator {
+ public:
+  static std::string generate(SBMLSystem &system);
+  static void generateExpression(std::ostream &os, const CompiledExpression &expression, const std::string &result,
+                                 const std::string &label, const std::string &indent,
+                                 const std::string &constants = "k");
+  static void generateAssignment(std::ostream &os, const Symbol &symbol, const std::string &value,
+                                 const std::string &indent, const std::string &constants = "k");
+  static void generateConstants(std::ostream &os, const std::vector<double> &constants, const std::string &name,
+                                const std::string &qualifier);
+  static void generatePrelude(std::ostream &os);
+  static void generateHelpers(std::ostream &os);
+  static std::string literal(double value);
+ private:
+  NativeCodeGenerator() {}
+  ~NativeCodeGenerator() {}
+  static void generateRhs(std::ostream &os, SBMLSystem &system);
+  static void generateAssignmentRules(std::ostream &os, SBMLSystem &system);
+  static void generateTriggers(std::ostream &os, SBMLSystem &system);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_CODEGEN_NATIVECODEGENERATOR_H_ */
@@ -0,0 +1,32 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_CODEGEN_NATIVEMODEL_H_
+#define INCLUDE_SBMLSIM_INTERNAL_CODEGEN_NATIVEMODEL_H_
+
+#include <memory>
+#include <string>
+
+/*
+ * Entry points of a shared object generated by NativeCodeGenerator and loaded with dlopen.
+ */
+class NativeModel {
+ public:
+  using RhsFunction = void (*)(const double *x, double *dxdt, double t);
+  using AssignmentRuleFunction = void (*)(double *x, double t);
+  using TriggerFunction = double (*)(unsigned int event, const double *x, double t);
+ public:
+  static std::shared_ptr<NativeModel> load(const std::string &path);
+  ~NativeModel();
+  void rhs(const double *x, double *dxdt, double t) const;
+  void assignmentRules(double *x, double t) const;
+  double trigger(unsigned int event, const double *x, double t) const;
+ private:
+  NativeModel(void *handle, RhsFunction rhsFunction, AssignmentRuleFunction assignmentRuleFunction,
+              TriggerFunction triggerFunction);
+  NativeModel(const NativeModel &nativeModel) = delete;
+  NativeModel &operator=(const NativeModel &nativeModel) = delete;
+  void *handle;
+  RhsFunction rhsFunction;
+  AssignmentRuleFunction assignmentRuleFunction;
+  TriggerFunction triggerFunction;
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_CODEGEN_NATIVEMODEL_H_ */
@@ -0,0 +1,34 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_CODEGEN_STANDALONECODEGENERATOR_H_
+#define INCLUDE_SBMLSIM_INTERNAL_CODEGEN_STANDALONECODEGENERATOR_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "sbmlsim/internal/system/SBMLSystem.h"
+
+/*
+ * Generates a self-contained model for ahead-of-time compilation (see cmake/sbmlsim_add_model.cmake).
+ *
+ * The header defines a model class with a fixed-size std::array state, constexpr stoichiometry and inlined
+ * rate laws, usable as the System of sbmlsim::integrate_const. The source adds a simulate() driver built on
+ * the templated integrate_const. Neither depends on libSBML. Models with delayed events are rejected.
+ */
+class StandaloneCodeGenerator {
+ public:
+  static void generateHeader(std::ostream &os, SBMLSystem &system, const std::string &name,
+                             const std::string &ns);
+  static void generateSource(std::ostream &os, SBMLSystem &system, const std::string &name,
+                             const std::string &ns);
+ private:
+  StandaloneCodeGenerator() {}
+  ~StandaloneCodeGenerator() {}
+  static std::vector<std::string> getStateIds(SBMLSystem &system);
+  static std::vector<std::vector<double> > getStoichiometryMatrix(SBMLSystem &system);
+  static void generateRhs(std::ostream &os, SBMLSystem &system);
+  static void generateInitialAssignments(std::ostream &os, SBMLSystem &system);
+  static void generateAssignmentRules(std::ostream &os, SBMLSystem &system);
+  static void generateEvents(std::ostream &os, SBMLSystem &system);
+  static void generateEventHelpers(std::ostream &os, SBMLSystem &system);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_CODEGEN_STANDALONECODEGENERATOR_H_ */
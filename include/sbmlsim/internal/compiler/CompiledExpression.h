@@ -0,0 +1,34 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_COMPILER_COMPILEDEXPRESSION_H_
+#define INCLUDE_SBMLSIM_INTERNAL_COMPILER_COMPILEDEXPRESSION_H_
+
+#include <vector>
+#include "sbmlsim/internal/compiler/Instruction.h"
+
+/*
+ * Direction of a tangent (directional derivative) evaluation: the tangents of the state, of the constants
+ * block and of time. A null pointer stands for a zero tangent.
+ */
+struct TangentSeed {
+  const double *x;
+  const double *k;
+  double t;
+};
+
+class CompiledExpression {
+ public:
+  CompiledExpression();
+  CompiledExpression(const std::vector<Instruction> &instructions, unsigned int stackSize);
+  CompiledExpression(const CompiledExpression &expression);
+  ~CompiledExpression();
+  const std::vector<Instruction> &getInstructions() const;
+  unsigned int getStackSize() const;
+  bool empty() const;
+  double evaluate(const double *x, const double *k, double t, double *stack) const;
+  double evaluateTangent(const double *x, const double *k, double t, const TangentSeed &seed, double *stack,
+                         double *tangents, double *tangent) const;
+ private:
+  std::vector<Instruction> instructions;
+  unsigned int stackSize;
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_COMPILER_COMPILEDEXPRESSION_H_ */
@@ -0,0 +1,35 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_COMPILER_EXPRESSIONCOMPILER_H_
+#define INCLUDE_SBMLSIM_INTERNAL_COMPILER_EXPRESSIONCOMPILER_H_
+
+#include <sbml/SBMLTypes.h>
+#include <string>
+#include <vector>
+#include "sbmlsim/internal/compiler/Instruction.h"
+#include "sbmlsim/internal/compiler/CompiledExpression.h"
+#include "sbmlsim/internal/compiler/SymbolTable.h"
+
+class ExpressionCompiler {
+ public:
+  static CompiledExpression compile(const ASTNode *node, const SymbolTable &symbolTable);
+ private:
+  explicit ExpressionCompiler(const SymbolTable &symbolTable);
+  ~ExpressionCompiler();
+  void compileNode(const ASTNode *node);
+  void compileNaryNode(const ASTNode *node, OpCode opcode, double identity);
+  void compileMinusNode(const ASTNode *node);
+  void compileRelationalNode(const ASTNode *node, OpCode opcode);
+  void compileFunctionNode(const ASTNode *node, OpCode opcode);
+  void compileRootNode(const ASTNode *node);
+  void compileLogNode(const ASTNode *node);
+  void compilePiecewiseNode(const ASTNode *node);
+  unsigned int emit(OpCode opcode, unsigned int operand = 0, double value = 0.0);
+  void emitConstant(double value);
+  void emitName(const std::string &name);
+  void patchJump(unsigned int position);
+  const SymbolTable &symbolTable;
+  std::vector<Instruction> instructions;
+  unsigned int depth;
+  unsigned int maxDepth;
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_COMPILER_EXPRESSIONCOMPILER_H_ */
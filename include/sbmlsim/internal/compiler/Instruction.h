@@ -0,0 +1,78 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_COMPILER_INSTRUCTION_H_
+#define INCLUDE_SBMLSIM_INTERNAL_COMPILER_INSTRUCTION_H_
+
+enum class OpCode : unsigned char {
+  // operands
+  PUSH_CONSTANT,
+  LOAD_VARIABLE,
+  LOAD_CONCENTRATION,
+  LOAD_CONSTANT,
+  LOAD_CONCENTRATION_CONSTANT_SIZE,
+  LOAD_TIME,
+  // arithmetic
+  ADD,
+  SUBTRACT,
+  MULTIPLY,
+  DIVIDE,
+  POWER,
+  NEGATE,
+  // functions
+  ROOT,
+  LOG,
+  ABS,
+  EXP,
+  LN,
+  LOG10,
+  CEILING,
+  FLOOR,
+  FACTORIAL,
+  SIN,
+  COS,
+  TAN,
+  SEC,
+  CSC,
+  COT,
+  SINH,
+  COSH,
+  TANH,
+  SECH,
+  CSCH,
+  COTH,
+  ARCSIN,
+  ARCCOS,
+  ARCTAN,
+  ARCSEC,
+  ARCCSC,
+  ARCCOT,
+  ARCSINH,
+  ARCCOSH,
+  ARCTANH,
+  ARCSECH,
+  ARCCSCH,
+  ARCCOTH,
+  // relational and logical
+  LT,
+  LEQ,
+  GT,
+  GEQ,
+  EQ,
+  NEQ,
+  AND,
+  OR,
+  XOR,
+  NOT,
+  // control flow
+  JUMP,
+  JUMP_IF_FALSE
+};
+
+struct Instruction {
+  OpCode opcode;
+  unsigned int operand;  // state index or jump target
+  union {
+    double value;                   // constant value
+    unsigned int compartmentIndex;  // state index of the compartment for LOAD_CONCENTRATION
+  };
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_COMPILER_INSTRUCTION_H_ */
@@ -0,0 +1,37 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_COMPILER_SYMBOLTABLE_H_
+#define INCLUDE_SBMLSIM_INTERNAL_COMPILER_SYMBOLTABLE_H_
+
+#include <string>
+#include <unordered_map>
+
+enum class SymbolType;
+
+struct Symbol {
+  SymbolType type;
+  unsigned int index;
+  unsigned int compartmentIndex;
+};
+
+class SymbolTable {
+ public:
+  SymbolTable();
+  SymbolTable(const SymbolTable &symbolTable);
+  ~SymbolTable();
+  void addVariable(const std::string &id, unsigned int index);
+  void addConcentration(const std::string &id, unsigned int index, unsigned int compartmentIndex);
+  void addConstant(const std::string &id, unsigned int index);
+  void addConstantSizeConcentration(const std::string &id, unsigned int index, unsigned int compartmentIndex);
+  bool contains(const std::string &id) const;
+  const Symbol &get(const std::string &id) const;
+ private:
+  std::unordered_map<std::string, Symbol> symbols;
+};
+
+enum class SymbolType {
+  VARIABLE,                   // read the state slot as is
+  CONCENTRATION,              // species amount divided by the size of its compartment
+  CONSTANT,                   // read the slot of the constants block
+  CONSTANT_SIZE_CONCENTRATION  // species amount divided by a compartment size held in the constants block
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_COMPILER_SYMBOLTABLE_H_ */
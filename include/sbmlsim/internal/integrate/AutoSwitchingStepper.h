@@ -0,0 +1,58 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_INTEGRATE_AUTOSWITCHINGSTEPPER_H_
+#define INCLUDE_SBMLSIM_INTERNAL_INTEGRATE_AUTOSWITCHINGSTEPPER_H_
+
+#include <functional>
+#include <vector>
+#include <boost/numeric/odeint.hpp>
+#include "sbmlsim/internal/integrate/BDFStepper.h"
+
+using namespace boost::numeric;
+
+/*
+ * LSODA-style stepper that starts with dopri5 and switches between it and BDFStepper as the problem
+ * becomes stiff or non-stiff.
+ *
+ * Every few accepted steps the spectral radius rho of J is estimated by power iteration. dopri5 is stable
+ * for h * rho up to about 3.3, so when its controller keeps proposing steps close to that boundary the step
+ * size is limited by stability rather than accuracy and BDF takes over. Conversely BDF hands back to dopri5
+ * when its own steps are well inside the explicit stability region. Both steppers work on the caller's
+ * state and time, so a switch is invisible to sbmlsim::integrate_const and the observer.
+ */
+class AutoSwitchingStepper {
+ public:
+  using state = BDFStepper::state;
+  using matrix = BDFStepper::matrix;
+  using stepper_category = odeint::controlled_stepper_tag;
+  using system_function = BDFStepper::system_function;
+  using jacobian_function = BDFStepper::jacobian_function;
+ public:
+  AutoSwitchingStepper(jacobian_function jacobian, double absoluteTolerance, double relativeTolerance);
+  AutoSwitchingStepper(const AutoSwitchingStepper &stepper);
+  ~AutoSwitchingStepper();
+  template<class System>
+  odeint::controlled_step_result try_step(System &system, state &x, double &t, double &dt) {
+    return tryStep(std::ref(system), x, t, dt);
+  }
+  void setAlgebraicComponents(const std::vector<unsigned int> &algebraicComponents);  // see BDFStepper
+  bool isStiff() const;
+  unsigned int getNumSwitches() const;
+ private:
+  using explicit_stepper = odeint::result_of::make_controlled<odeint::runge_kutta_dopri5<state> >::type;
+  jacobian_function jacobian;
+  explicit_stepper explicitStepper;
+  BDFStepper implicitStepper;
+  state explicitState;  // where dopri5 left off, empty when it has to be reset
+  double explicitTime;
+  bool stiff;
+  unsigned int stepsSinceCheck;
+  unsigned int votes;
+  unsigned int numSwitches;
+  matrix J;
+  state v;
+  state w;
+  odeint::controlled_step_result tryStep(const system_function &system, state &x, double &t, double &dt);
+  void checkStiffness(const state &x, double t, double h);
+  double estimateSpectralRadius(const state &x, double t);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_INTEGRATE_AUTOSWITCHINGSTEPPER_H_ */
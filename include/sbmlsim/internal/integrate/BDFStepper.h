@@ -0,0 +1,96 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_INTEGRATE_BDFSTEPPER_H_
+#define INCLUDE_SBMLSIM_INTERNAL_INTEGRATE_BDFSTEPPER_H_
+
+#include <functional>
+#include <vector>
+#include <boost/numeric/odeint.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/lu.hpp>
+
+using namespace boost::numeric;
+
+/*
+ * Variable-order (1-5), variable-step BDF integrator for stiff systems, in the Nordsieck form of
+ * LSODE/CVODE.
+ *
+ * The corrector is solved with a modified Newton iteration on M = I - gamma * J, gamma = h * l_0. J and the
+ * LU factors of M are kept across steps: M is refactored only when gamma drifts by more than 30% and J is
+ * re-evaluated every 20 steps, after a convergence failure with a stale J, or when the history is reset.
+ * Step size and order are held for q + 1 steps after each change so that the factors stay valid.
+ *
+ * It models odeint's controlled stepper concept, so sbmlsim::integrate_const drives it with the usual
+ * observer contract. A dt clipped to an output point does not clip the internal step: the state there is
+ * interpolated from the Nordsieck array and the history goes on from the end of the full step. The history
+ * is restarted at order 1 whenever try_step is called with a state or time that is not the one it produced
+ * last, e.g. after an event assignment; changes to the algebraic components (targets of assignment rules,
+ * which are not integrated) are taken over without a restart.
+ */
+class BDFStepper {
+ public:
+  using state = ublas::vector<double>;
+  using matrix = ublas::matrix<double>;
+  using stepper_category = odeint::controlled_stepper_tag;
+  using system_function = std::function<void(const state &, state &, double)>;
+  using jacobian_function = std::function<void(const state &, matrix &, double)>;
+  static const unsigned int MAX_ORDER = 5;
+ public:
+  BDFStepper(jacobian_function jacobian, double absoluteTolerance, double relativeTolerance);
+  BDFStepper(const BDFStepper &stepper);
+  ~BDFStepper();
+  template<class System>
+  odeint::controlled_step_result try_step(System &system, state &x, double &t, double &dt) {
+    return tryStep(std::ref(system), x, t, dt);
+  }
+  void setAlgebraicComponents(const std::vector<unsigned int> &algebraicComponents);
+  unsigned int getOrder() const;
+  double getStepSize() const;  // proposed for the next internal step
+  unsigned long getNumSteps() const;
+  unsigned long getNumJacobianEvaluations() const;
+  unsigned long getNumFactorizations() const;
+ private:
+  jacobian_function jacobian;
+  double absoluteTolerance;
+  double relativeTolerance;
+  std::vector<unsigned int> algebraicComponents;
+  bool initialized;
+  double tn;
+  double h;
+  double hNext;
+  unsigned int q;
+  double tOutput;        // time and state last handed to the caller
+  state xOutput;
+  std::vector<state> z;  // Nordsieck history, z[j] = h^j * y^(j) / j!
+  state e;               // accumulated correction of the current step
+  state ePrevious;       // correction of the previous step, for the order q + 1 estimate
+  state y;
+  state f;
+  state delta;
+  state weights;
+  matrix J;
+  matrix M;
+  ublas::permutation_matrix<std::size_t> pivots;
+  double gammaFactored;
+  double convergenceRate;
+  bool jacobianFresh;
+  unsigned int stepsSinceJacobian;
+  unsigned int stepsUntilChange;
+  unsigned int errorTestFailures;
+  unsigned long numSteps;
+  unsigned long numJacobianEvaluations;
+  unsigned long numFactorizations;
+  odeint::controlled_step_result tryStep(const system_function &system, state &x, double &t, double &dt);
+  void initialize(const system_function &system, const state &x, double t, double dt);
+  bool isContinuation(const state &x, double t);
+  void output(state &x, double &t, double &dt);
+  void rescale(double eta);
+  void predict();
+  void retract();
+  bool solveCorrector(const system_function &system);
+  bool factorize();
+  void updateWeights(const state &x);
+  double norm(const state &v) const;
+  void selectStepAndOrder(double error);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_INTEGRATE_BDFSTEPPER_H_ */
@@ -3,15 +3,14 @@
 
 #include <stdexcept>
 #include <boost/numeric/odeint.hpp>
-#include "sbmlsim/internal/system/SBMLSystem.h"
 
 using namespace boost::numeric;
 
 namespace sbmlsim {
 
-template<class Stepper, class Observer>
+template<class Stepper, class System, class Observer>
 size_t integrate_adaptive_detail(
-    Stepper stepper, SBMLSystem system, SBMLSystem::state &start_state,
+    Stepper stepper, System system, typename System::state &start_state,
     double &start_time, double end_time, double &dt,
     Observer observer, odeint::controlled_stepper_tag) {
   typename odeint::unwrap_reference<Observer>::type &obs = observer;
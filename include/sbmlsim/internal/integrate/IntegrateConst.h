@@ -1,19 +1,29 @@
 #ifndef INCLUDE_SBMLSIM_INTERNAL_INTEGRATE_INTEGRATECONST_H_
 #define INCLUDE_SBMLSIM_INTERNAL_INTEGRATE_INTEGRATECONST_H_
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
 #include <boost/numeric/odeint.hpp>
-#include "sbmlsim/internal/system/SBMLSystem.h"
 #include "sbmlsim/internal/integrate/IntegrateAdaptive.h"
 
 using namespace boost::numeric;
 
 namespace sbmlsim {
 
-template<class Stepper, class Observer>
+/*
+ * System is SBMLSystem or a model class generated by sbmlsim-model-compiler. Besides the odeint system
+ * function it has to provide a state type, handleInitialAssignment, handleAssignmentRule and handleEvent.
+ */
+
+template<class Stepper, class System, class Observer>
 size_t integrate_const_detail(
-    Stepper stepper, SBMLSystem &system , SBMLSystem::state &start_state,
+    Stepper stepper, System &system, typename System::state &start_state,
     double start_time, double end_time, double dt,
-    Observer observer, odeint::stepper_tag) {
+    Observer observer, odeint::stepper_tag, const std::vector<unsigned int> &) {
   typename odeint::unwrap_reference<Observer>::type &obs = observer;
   typename odeint::unwrap_reference<Stepper>::type &st = stepper;
 
@@ -51,12 +61,13 @@ size_t integrate_const_detail(
   return step;
 }
 
-template<class Stepper, class Observer>
+template<class Stepper, class System, class Observer>
 size_t integrate_const_detail(
-    Stepper &stepper, SBMLSystem &system, SBMLSystem::state &start_state,
+    Stepper &stepper, System &system, typename System::state &start_state,
     double start_time, double end_time, double dt,
-    Observer observer, odeint::controlled_stepper_tag) {
+    Observer observer, odeint::controlled_stepper_tag, const std::vector<unsigned int> &) {
   typename odeint::unwrap_reference<Observer>::type &obs = observer;
+  typename odeint::unwrap_reference<Stepper>::type &st = stepper;
 
   double time = start_time;
   const double time_step = dt;
@@ -74,7 +85,8 @@ size_t integrate_const_detail(
     obs(start_state, time);
 
     // integrate_adaptive_checked uses the given checker to throw if an overflow occurs
-    real_steps += odeint::detail::integrate_adaptive(stepper, system, start_state, time,
+    // pass the stepper by reference so that multistep steppers keep their history across output intervals
+    real_steps += odeint::detail::integrate_adaptive(std::ref(st), system, start_state, time,
                                                      time + time_step, dt,
                                                      odeint::null_observer(), odeint::controlled_stepper_tag());
 
@@ -96,13 +108,254 @@ size_t integrate_const_detail(
   return real_steps;
 }
 
-template<class Stepper, class Time, class Observer>
+template<class System>
+void evaluate_event_functions(System &system, const typename System::state &x, double t, std::vector<double> &g) {
+  for (std::size_t i = 0; i < g.size(); i++) {
+    g[i] = system.evaluateEventFunction(i, x, t);
+  }
+}
+
+/*
+ * Finds the earliest sign change of the event functions on (t0, t1] of the dense-output interpolant, given
+ * their values g0 at t0 and g1 at t1. The assignment rules are applied to every interpolated state, since
+ * triggers may read their targets. Each crossing is located with the Illinois variant of regula falsi;
+ * event_time is the right end of the final bracket, where the trigger has already switched.
+ */
+template<class Stepper, class System>
+bool locate_event(Stepper &st, System &system, typename System::state &x,
+                  double t0, const std::vector<double> &g0, double t1, const std::vector<double> &g1,
+                  double &event_time) {
+  const int MAX_ITERATIONS = 100;
+  const double tolerance = 4.0 * std::numeric_limits<double>::epsilon() * std::max(std::fabs(t0), std::fabs(t1))
+      + 1e-12 * std::fabs(t1 - t0);
+
+  bool found = false;
+  event_time = t1;
+  for (std::size_t i = 0; i < g0.size(); i++) {
+    if ((g0[i] > 0.0) == (g1[i] > 0.0)) {
+      continue;
+    }
+    double lo = t0, glo = g0[i];
+    double hi = t1, ghi = g1[i];
+    int side = 0;
+    for (int k = 0; k < MAX_ITERATIONS && hi - lo > tolerance; k++) {
+      double mid = hi - ghi * (hi - lo) / (ghi - glo);
+      if (!(mid > lo && mid < hi)) {
+        mid = 0.5 * (lo + hi);
+      }
+      st.calc_state(mid, x);
+      system.handleAssignmentRule(x, mid);
+      double gmid = system.evaluateEventFunction(i, x, mid);
+      if ((gmid > 0.0) == (ghi > 0.0)) {
+        hi = mid;
+        ghi = gmid;
+        if (side == 1) {
+          glo *= 0.5;
+        }
+        side = 1;
+      } else {
+        lo = mid;
+        glo = gmid;
+        if (side == -1) {
+          ghi *= 0.5;
+        }
+        side = -1;
+      }
+    }
+    if (hi < event_time || !found) {
+      event_time = hi;
+      found = true;
+    }
+  }
+  return found;
+}
+
+template<class T, class R = void>
+struct enable_if_type {
+  typedef R type;
+};
+
+/*
+ * Right-hand side rhs of system evaluated on a copy of the state to which the assignment rules have been
+ * applied, so the rule targets the stepper carries along may be stale.
+ */
+template<class System, class Rhs>
+class assignment_rule_rhs {
+ public:
+  assignment_rule_rhs(System &system, Rhs &rhs, const typename System::state &x)
+      : system(system), rhs(rhs), buffer(x) {}
+  void operator()(const typename System::state &x, typename System::state &dxdt, double t) {
+    buffer = x;
+    system.handleAssignmentRule(buffer, t);
+    rhs(buffer, dxdt, t);
+  }
+ private:
+  System &system;
+  Rhs &rhs;
+  typename System::state buffer;
+};
+
+// explicit steppers take the system function itself
+template<class System, class Enable = void>
+class assignment_rule_system {
+ public:
+  assignment_rule_system(System &system, const typename System::state &x) : rhs(system, system, x) {}
+  std::reference_wrapper<assignment_rule_rhs<System, System> > get() {
+    return std::ref(rhs);
+  }
+ private:
+  assignment_rule_rhs<System, System> rhs;
+};
+
+// implicit steppers take a (system function, jacobian) pair; the jacobian differentiates through the rules itself
+template<class System>
+class assignment_rule_system<System, typename enable_if_type<typename System::first_type>::type> {
+ public:
+  typedef typename odeint::unwrap_reference<typename System::first_type>::type deriv_func_type;
+  typedef typename odeint::unwrap_reference<typename System::second_type>::type jacobi_func_type;
+  assignment_rule_system(System &system, const typename System::state &x)
+      : rhs(system, system.first, x), jacobi(system.second) {}
+  std::pair<std::reference_wrapper<assignment_rule_rhs<System, deriv_func_type> >,
+            std::reference_wrapper<jacobi_func_type> > get() {
+    return std::make_pair(std::ref(rhs), std::ref(jacobi));
+  }
+ private:
+  assignment_rule_rhs<System, deriv_func_type> rhs;
+  jacobi_func_type &jacobi;
+};
+
+// whether a and b agree outside the components flagged in skipped
+template<class State>
+bool equal_except(const State &a, const State &b, const std::vector<bool> &skipped) {
+  for (std::size_t i = 0; i < a.size(); i++) {
+    if (!skipped[i] && a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Dense-output steppers take their natural steps and the observation points are interpolated, so the
+ * output interval does not limit the step size. The stepper is restarted only when initial assignments or
+ * events actually change the interpolated state. The targets of assignment rules, given by rule_targets,
+ * are left out of that comparison: their derivative is zero and the right-hand side is evaluated with the
+ * rules applied, so the values the stepper carries for them do not matter.
+ *
+ * Events are located during stepping: System also has to provide getNumEvents() and
+ * evaluateEventFunction(i, x, t), a function that changes sign where trigger i switches. The integration
+ * is truncated at the located crossing, handleEvent is applied there and the stepper restarts from the
+ * resulting state.
+ */
+template<class Stepper, class System, class Observer>
+size_t integrate_const_detail(
+    Stepper &stepper, System &system, typename System::state &start_state,
+    double start_time, double end_time, double dt,
+    Observer observer, odeint::dense_output_stepper_tag, const std::vector<unsigned int> &rule_targets) {
+  typename odeint::unwrap_reference<Observer>::type &obs = observer;
+  typename odeint::unwrap_reference<Stepper>::type &st = stepper;
+  assignment_rule_system<System> rule_system(system, start_state);
+  std::vector<bool> is_rule_target(start_state.size(), false);
+  for (auto i : rule_targets) {
+    is_rule_target[i] = true;
+  }
+
+  double time = start_time;
+  const double time_step = dt;
+  int real_steps = 0;
+  int step = 0;
+  bool initialized = false;
+  typename System::state interpolated = start_state;
+  typename System::state probe = start_state;
+  std::vector<double> g_checked(system.getNumEvents());
+  std::vector<double> g_next(system.getNumEvents());
+  double checked = time;  // event functions have been checked up to here
+
+  while (odeint::detail::less_eq_with_sign(time + time_step, end_time, dt)) {
+    // initial assignments
+    system.handleInitialAssignment(start_state, time);
+
+    // assignment rules
+    system.handleAssignmentRule(start_state, time);
+
+    // observer
+    obs(start_state, time);
+
+    // (re)start from the current state if it is not where the stepper left off
+    if (!initialized || !equal_except(start_state, interpolated, is_rule_target)) {
+      st.initialize(start_state, time, initialized ? st.current_time_step() : time_step);
+      evaluate_event_functions(system, start_state, time, g_checked);
+      checked = time;
+      initialized = true;
+    }
+
+    // direct computation of the time avoids error propagation happening when using time += dt
+    // we need clumsy type analysis to get boost units working here
+    step++;
+    time = start_time + static_cast<typename odeint::unit_value_type<double>::type>(step) * time_step;
+
+    while (true) {
+      double horizon = std::min(st.current_time(), time);
+      if (!g_checked.empty() && checked < horizon) {
+        st.calc_state(horizon, probe);
+        system.handleAssignmentRule(probe, horizon);
+        evaluate_event_functions(system, probe, horizon, g_next);
+        double event_time;
+        if (locate_event(st, system, probe, checked, g_checked, horizon, g_next, event_time)) {
+          // truncate the step at the event
+          st.calc_state(event_time, probe);
+          interpolated = probe;
+          system.handleAssignmentRule(probe, event_time);
+          system.handleEvent(probe, event_time);
+          system.handleAssignmentRule(probe, event_time);
+          if (!equal_except(probe, interpolated, is_rule_target)) {
+            st.initialize(probe, event_time, st.current_time_step());
+          }
+          evaluate_event_functions(system, probe, event_time, g_checked);
+          checked = event_time;
+          continue;
+        }
+        g_checked.swap(g_next);
+        checked = horizon;
+      }
+      if (!odeint::detail::less_with_sign(st.current_time(), time, time_step)) {
+        break;
+      }
+      if (rule_targets.empty()) {
+        st.do_step(std::ref(system));
+      } else {
+        st.do_step(rule_system.get());
+      }
+      real_steps++;
+    }
+    st.calc_state(time, start_state);
+    interpolated = start_state;
+
+    // event
+    system.handleAssignmentRule(start_state, time);
+    system.handleEvent(start_state, time);
+  }
+
+  // assignment rules
+  system.handleAssignmentRule(start_state, time);
+
+  // observer
+  obs(start_state, time);
+
+  return real_steps;
+}
+
+/*
+ * rule_targets lists the state indices set by assignment rules; only dense-output steppers make use of it.
+ */
+template<class Stepper, class System, class Time, class Observer>
 size_t integrate_const(
-    Stepper &stepper, SBMLSystem &system, SBMLSystem::state &start_state,
-    Time start_time, Time end_time, Time dt, Observer observer) {
+    Stepper &stepper, System &system, typename System::state &start_state,
+    Time start_time, Time end_time, Time dt, Observer observer,
+    const std::vector<unsigned int> &rule_targets = std::vector<unsigned int>()) {
   typedef typename odeint::unwrap_reference<Stepper>::type::stepper_category stepper_category;
   return integrate_const_detail(stepper, system, start_state,
-                                start_time, end_time, dt, observer, stepper_category());
+                                start_time, end_time, dt, observer, stepper_category(), rule_targets);
 }
 
 } /* namespace sbmlsim */
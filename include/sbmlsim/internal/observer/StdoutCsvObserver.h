@@ -7,7 +7,8 @@
 
 class StdoutCsvObserver {
  public:
-  explicit StdoutCsvObserver(const std::vector<ObserveTarget> &targets);
+  explicit StdoutCsvObserver(const std::vector<ObserveTarget> &targets,
+                             const std::vector<double> &constants = std::vector<double>());
   StdoutCsvObserver(const StdoutCsvObserver &observer);
   ~StdoutCsvObserver();
   void operator()(const SBMLSystem::state &x, double t);
@@ -15,6 +16,7 @@ class StdoutCsvObserver {
   void outputHeader();
  private:
   std::vector<ObserveTarget> targets;
+  std::vector<double> constants;
 };
 
 #endif /* INCLUDE_SBMLSIM_INTERNAL_OBSERVER_STDOUTCSVOBSERVER_H_ */
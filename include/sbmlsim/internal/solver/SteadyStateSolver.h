@@ -0,0 +1,90 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_SOLVER_STEADYSTATESOLVER_H_
+#define INCLUDE_SBMLSIM_INTERNAL_SOLVER_STEADYSTATESOLVER_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/lu.hpp>
+
+using namespace boost::numeric;
+
+enum class SteadyStateMethod {
+  NEWTON,
+  PSEUDO_TRANSIENT_CONTINUATION,
+  TIME_COURSE,
+  NONE  // did not converge
+};
+
+struct SteadyState {
+  ublas::vector<double> x;
+  SteadyStateMethod method;           // the phase that converged
+  double residualNorm;                // weighted RMS norm of f(x), <= 1 when converged
+  double time;                        // integrated time of the time-course phase, 0 otherwise
+  unsigned int newtonIterations;
+  unsigned int pseudoTransientIterations;
+  unsigned int numLinearSolves;
+  unsigned int numJacobianEvaluations;
+  std::vector<std::string> ids;       // output fields, filled in by SBMLSim::findSteadyState
+  std::vector<double> values;         // of the output fields at x
+
+  bool isConverged() const {
+    return this->method != SteadyStateMethod::NONE;
+  }
+};
+
+/*
+ * Finds x with f(x) = 0 for an autonomous system, in three phases:
+ *
+ * 1. damped Newton with a backtracking line search on ||f||_2;
+ * 2. pseudo-transient continuation, (I / tau - J) dx = f with tau grown by switched evolution relaxation,
+ *    which stays on the manifold of conserved moieties where J itself is singular;
+ * 3. integration with BDFStepper over growing horizons up to maxTime, polishing with Newton after each one.
+ *
+ * Rows of J and f that are identically zero (fixed species, assignment rule targets) are held fixed. Given
+ * the stoichiometry matrix, Newton replaces one row of J per conserved moiety by its conservation law, as J
+ * is singular otherwise. The residual is converged when its weighted RMS norm with weights
+ * 1 / (atol + rtol * |x_i|) is at most 1.
+ */
+class SteadyStateSolver {
+ public:
+  using state = ublas::vector<double>;
+  using matrix = ublas::matrix<double>;
+  using system_function = std::function<void(const state &, state &, double)>;
+  using jacobian_function = std::function<void(const state &, matrix &, double)>;
+ public:
+  SteadyStateSolver(system_function system, jacobian_function jacobian, double absoluteTolerance,
+                    double relativeTolerance, double maxTime);
+  SteadyStateSolver(const SteadyStateSolver &solver);
+  ~SteadyStateSolver();
+  void setStoichiometryMatrix(const matrix &stoichiometry);
+  SteadyState solve(const state &x0, double t = 0.0);
+ private:
+  system_function system;
+  jacobian_function jacobian;
+  double absoluteTolerance;
+  double relativeTolerance;
+  double maxTime;
+  double t;
+  state f;
+  state trial;
+  state fTrial;
+  state dx;
+  matrix J;
+  matrix M;
+  ublas::permutation_matrix<std::size_t> pivots;
+  std::vector<bool> fixedRows;
+  matrix conservationLaws;                  // one conserved moiety per row
+  std::vector<unsigned int> dependentRows;  // row of J replaced by each law
+  state conservedTotals;
+  bool newton(state &x, SteadyState &result);
+  bool pseudoTransientContinuation(state &x, SteadyState &result);
+  bool timeCourse(state &x, SteadyState &result);
+  void evaluateJacobian(const state &x, SteadyState &result);
+  bool factorize(double shift, bool conserved);
+  double residualNorm(const state &x, const state &residual) const;
+  static bool isFinite(const state &v);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_SOLVER_STEADYSTATESOLVER_H_ */
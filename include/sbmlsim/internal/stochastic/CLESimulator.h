@@ -0,0 +1,52 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_CLESIMULATOR_H_
+#define INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_CLESIMULATOR_H_
+
+#include <vector>
+#include "sbmlsim/internal/stochastic/Philox4x32.h"
+#include "sbmlsim/internal/stochastic/ReactionNetwork.h"
+
+enum class CLEScheme {
+  EULER_MARUYAMA,  // strong order 1/2
+  MILSTEIN         // strong order 1 for commutative noise
+};
+
+/*
+ * Chemical Langevin equation dx = sum_j v_j a_j(x) dt + sum_j v_j sqrt(a_j(x)) dW_j (Gillespie 2000), one
+ * Wiener process per reaction, integrated with a fixed step.
+ *
+ * The Milstein scheme is the derivative-free variant of Kloeden and Platen (11.1.7): L^k b_j is replaced by a
+ * difference quotient at the supporting value x + f h + b_k sqrt(h), which costs one evaluation of all
+ * propensities per reaction with a positive propensity. Levy areas are neglected, so the scheme is of strong
+ * order 1 only when the noise is commutative, e.g. when every species takes part in a single reaction; it is
+ * never worse than Euler-Maruyama. Propensities are clamped at 0, amounts are not.
+ */
+class CLESimulator {
+ public:
+  using state = SBMLSystem::state;
+ public:
+  CLESimulator(SBMLSystem &system, unsigned long seed, double stepSize, CLEScheme scheme = CLEScheme::MILSTEIN);
+  CLESimulator(const CLESimulator &simulator);
+  ~CLESimulator();
+  void initialize(const state &x, double t);
+  bool step(state &x, double &t, double until);
+  void setStream(unsigned long stream);
+  unsigned long getNumSteps() const;
+ private:
+  ReactionNetwork network;
+  Philox4x32 engine;
+  double stepSize;
+  CLEScheme scheme;
+  bool hasEvents;
+  std::vector<double> roots;         // sqrt(a_j(x))
+  std::vector<double> supportRoots;  // sqrt(a_j) at a supporting value
+  std::vector<double> increments;    // dW_j
+  state drift;
+  state support;
+  state next;
+  unsigned long numSteps;
+  void evaluateRoots(const state &x, double t, std::vector<double> &roots);
+  void addMilsteinCorrection(const state &x, double t, double h);
+  void handleEvent(state &x, double t);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_CLESIMULATOR_H_ */
@@ -0,0 +1,81 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_COMPOSITIONREJECTIONSAMPLER_H_
+#define INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_COMPOSITIONREJECTIONSAMPLER_H_
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Selects reaction j with probability a_j / sum(a) in time independent of the number of reactions
+ * (Slepoy, Thompson and Plimpton 2008).
+ *
+ * Reactions are grouped by the binary exponent of their propensity, so group g holds propensities in
+ * [2^(g-1), 2^g). A group is chosen by a linear search over the few groups, weighted by their sums, and a
+ * member within it by rejection sampling against the group bound 2^g, which accepts with probability at
+ * least 1/2. Updating a propensity moves the reaction between groups in O(1). The group sums are kept up
+ * to date incrementally and recomputed from their members every members.size() changes, which bounds the
+ * rounding error at amortized O(1) cost.
+ */
+class CompositionRejectionSampler {
+ public:
+  CompositionRejectionSampler();
+  explicit CompositionRejectionSampler(unsigned int numReactions);
+  CompositionRejectionSampler(const CompositionRejectionSampler &sampler);
+  ~CompositionRejectionSampler();
+  void update(unsigned int reaction, double propensity);
+  double getPropensity(unsigned int reaction) const;
+  double getTotal() const;
+  // requires getTotal() > 0
+  template<class Engine>
+  unsigned int select(Engine &engine) const {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // composition: the group
+    double target = uniform(engine) * this->total;
+    unsigned int selected = this->groups.size();
+    for (unsigned int g = 0; g < this->groups.size(); g++) {
+      if (this->groups[g].members.empty()) {
+        continue;
+      }
+      selected = g;
+      target -= this->groups[g].sum;
+      if (target < 0.0) {
+        break;
+      }
+    }
+
+    // rejection: the member
+    auto &group = this->groups[selected];
+    double bound = std::ldexp(1.0, group.exponent);
+    while (true) {
+      double r = uniform(engine) * group.members.size();
+      auto member = std::min(static_cast<std::size_t>(r), group.members.size() - 1);
+      auto reaction = group.members[member];
+      if ((r - member) * bound < this->propensities[reaction]) {
+        return reaction;
+      }
+    }
+  }
+ private:
+  struct Group {
+    int exponent;
+    double sum;
+    unsigned int numChanges;  // incremental changes of sum since it was last recomputed
+    std::vector<unsigned int> members;
+  };
+  static const unsigned int NO_GROUP = static_cast<unsigned int>(-1);
+  std::vector<double> propensities;
+  std::vector<unsigned int> groupOf;     // NO_GROUP for zero propensities
+  std::vector<unsigned int> positionOf;  // position in the members of its group
+  std::vector<Group> groups;
+  std::unordered_map<int, unsigned int> groupIndex;  // exponent -> group
+  double total;
+  void remove(unsigned int reaction);
+  void insert(unsigned int reaction, double propensity);
+  void addToSum(unsigned int g, double delta);
+  void updateTotal();
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_COMPOSITIONREJECTIONSAMPLER_H_ */
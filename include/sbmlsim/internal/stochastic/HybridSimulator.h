@@ -0,0 +1,55 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_HYBRIDSIMULATOR_H_
+#define INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_HYBRIDSIMULATOR_H_
+
+#include <vector>
+#include <boost/numeric/odeint.hpp>
+#include "sbmlsim/internal/stochastic/Philox4x32.h"
+#include "sbmlsim/internal/stochastic/ReactionNetwork.h"
+
+/*
+ * Partitioned ODE/SSA simulation (Haseltine and Rawlings 2002; Salis and Kaznessis 2005).
+ *
+ * Reactions with a propensity of at least propensityThreshold whose reactants all have at least
+ * copyNumberThreshold molecules are fast and contribute v_j a_j to a reaction rate equation; the others
+ * are slow and fire one at a time. The state is augmented with g, the integral of the total slow propensity,
+ * and both are integrated together by a dense-output dopri5 stepper. A slow reaction fires where g crosses
+ * -ln(u), located by bisection on the interpolant, which accounts for slow propensities that change with
+ * the continuous part. The partition is recomputed before every slow firing and at every sample time, and
+ * checked every few ODE steps in between so that long stretches without slow firings cannot keep a stale one.
+ */
+class HybridSimulator {
+ public:
+  using state = SBMLSystem::state;
+ public:
+  HybridSimulator(SBMLSystem &system, unsigned long seed, double absoluteTolerance, double relativeTolerance,
+                  double propensityThreshold = 10.0, double copyNumberThreshold = 100.0);
+  HybridSimulator(const HybridSimulator &simulator);
+  ~HybridSimulator();
+  void initialize(const state &x, double t);
+  bool step(state &x, double &t, double until);
+  void operator()(const state &y, state &dydt, double t);
+  void setStream(unsigned long stream);
+  unsigned long getNumFirings() const;
+  unsigned int getNumFastReactions() const;
+ private:
+  using stepper_type = odeint::result_of::make_dense_output<odeint::runge_kutta_dopri5<state> >::type;
+  ReactionNetwork network;
+  stepper_type stepper;
+  Philox4x32 engine;
+  double propensityThreshold;
+  double copyNumberThreshold;
+  bool hasEvents;
+  std::vector<bool> fast;
+  std::vector<double> propensities;
+  state y;       // x followed by g
+  state probe;
+  state buffer;  // y with the assignment rules applied
+  unsigned long numFirings;
+  void partition(const state &x, double t);
+  bool isFast(unsigned int reaction, const state &x, double t);
+  bool isPartitionOutdated(double t);
+  double locateFiring(double t0, double t1, double threshold);
+  void handleEvent(state &x, double t);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_HYBRIDSIMULATOR_H_ */
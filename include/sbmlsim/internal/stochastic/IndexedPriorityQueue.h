@@ -0,0 +1,29 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_INDEXEDPRIORITYQUEUE_H_
+#define INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_INDEXEDPRIORITYQUEUE_H_
+
+#include <vector>
+
+/*
+ * Binary min-heap over the putative firing times of a fixed set of reactions, with the heap position of
+ * every reaction kept so that the time of any reaction can be changed in O(log n) (Gibson and Bruck 2000).
+ */
+class IndexedPriorityQueue {
+ public:
+  IndexedPriorityQueue();
+  explicit IndexedPriorityQueue(unsigned int size);
+  IndexedPriorityQueue(const IndexedPriorityQueue &queue);
+  ~IndexedPriorityQueue();
+  unsigned int size() const;
+  unsigned int top() const;
+  double getTime(unsigned int reaction) const;
+  void update(unsigned int reaction, double time);
+ private:
+  std::vector<double> times;           // by reaction
+  std::vector<unsigned int> heap;      // reactions in heap order
+  std::vector<unsigned int> position;  // of every reaction in heap
+  void swap(unsigned int i, unsigned int j);
+  void siftUp(unsigned int i);
+  void siftDown(unsigned int i);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_INDEXEDPRIORITYQUEUE_H_ */
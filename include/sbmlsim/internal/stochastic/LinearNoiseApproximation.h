@@ -0,0 +1,50 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_LINEARNOISEAPPROXIMATION_H_
+#define INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_LINEARNOISEAPPROXIMATION_H_
+
+#include <boost/numeric/ublas/matrix.hpp>
+#include "sbmlsim/internal/stochastic/ReactionNetwork.h"
+#include "sbmlsim/internal/system/SBMLSystem.h"
+#include "sbmlsim/internal/system/SBMLSystemJacobi.h"
+
+/*
+ * Linear noise approximation (van Kampen; Elf and Ehrenberg 2003): the mean follows the reaction rate
+ * equation dphi/dt = f(phi) of SBMLSystem and the covariance the Lyapunov equation
+ *
+ *   dSigma/dt = J Sigma + Sigma J^T + D,  D = N diag(a(phi)) N^T,
+ *
+ * with J from SBMLSystemJacobi and D from the stoichiometry and propensities of ReactionNetwork. Both are
+ * integrated as one ODE whose state is phi followed by the upper triangle of Sigma, row by row, so a single
+ * deterministic run gives the means and covariances of all state variables; amounts are molecule counts as
+ * for the stochastic simulators. J Sigma uses the sparsity of J.
+ *
+ * Models with events are rejected: a trigger evaluated on the mean fires at one time for the whole
+ * distribution, and an assignment has no counterpart for Sigma.
+ */
+class LinearNoiseApproximation {
+ public:
+  using state = SBMLSystem::state;
+  using matrix = ublas::matrix<double>;
+ public:
+  explicit LinearNoiseApproximation(SBMLSystem &system,
+                                    JacobianMethod jacobianMethod = JacobianMethod::AUTOMATIC_DIFFERENTIATION);
+  LinearNoiseApproximation(const LinearNoiseApproximation &lna);
+  ~LinearNoiseApproximation();
+  void operator()(const state &y, state &dydt, double t);
+  unsigned int getNumStates() const;
+  state createInitialState(const state &x) const;  // x with a zero covariance
+  void getMean(const state &y, state &x) const;
+  void getCovariance(const state &y, matrix &covariance) const;
+  unsigned int getCovarianceIndex(unsigned int i, unsigned int k) const;  // of Sigma_ik in the state
+ private:
+  SBMLSystem *system;
+  SBMLSystemJacobi jacobi;
+  ReactionNetwork network;
+  unsigned int numStates;  // of system
+  state x;
+  state f;
+  matrix covariance;
+  matrix product;  // J Sigma
+  matrix diffusion;
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_LINEARNOISEAPPROXIMATION_H_ */
@@ -0,0 +1,40 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_NEXTREACTIONSIMULATOR_H_
+#define INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_NEXTREACTIONSIMULATOR_H_
+
+#include <vector>
+#include "sbmlsim/internal/stochastic/IndexedPriorityQueue.h"
+#include "sbmlsim/internal/stochastic/Philox4x32.h"
+#include "sbmlsim/internal/stochastic/ReactionNetwork.h"
+
+/*
+ * The next reaction method of Gibson and Bruck, exact like SSASimulator. Every reaction keeps an absolute
+ * putative firing time in an IndexedPriorityQueue; after a firing only the reactions in its dependency
+ * graph are touched, and their times are rescaled by a_old / a_new instead of being drawn again, so a
+ * step costs one random number and O(d log n) for d dependents.
+ */
+class NextReactionSimulator {
+ public:
+  using state = SBMLSystem::state;
+ public:
+  NextReactionSimulator(SBMLSystem &system, unsigned long seed);
+  NextReactionSimulator(const NextReactionSimulator &simulator);
+  ~NextReactionSimulator();
+  void initialize(const state &x, double t);
+  bool step(state &x, double &t, double until);
+  void setStream(unsigned long stream);
+  unsigned long getNumFirings() const;
+ private:
+  ReactionNetwork network;
+  IndexedPriorityQueue queue;
+  std::vector<double> propensities;
+  Philox4x32 engine;
+  bool hasEvents;
+  state previous;  // state before the event check
+  unsigned long numFirings;
+  double drawFiringTime(double propensity, double t);
+  void updateReaction(unsigned int reaction, const state &x, double t);
+  void resetReactions(const state &x, double t);
+  void handleEvent(state &x, double t);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_NEXTREACTIONSIMULATOR_H_ */
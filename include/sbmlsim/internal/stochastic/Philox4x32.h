@@ -0,0 +1,50 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_PHILOX4X32_H_
+#define INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_PHILOX4X32_H_
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+/*
+ * Counter-based random number engine Philox4x32-10 (Salmon et al. 2011). Block n of stream s is the
+ * bijection of the 128-bit counter (n, s) under the 64-bit key seed, so streams are independent without
+ * any state to share or jump ahead: trajectory i of an ensemble simply uses stream i. Every block yields two
+ * 64-bit outputs.
+ *
+ * Satisfies the UniformRandomBitGenerator requirements, so it works with the distributions of <random>.
+ */
+class Philox4x32 {
+ public:
+  using result_type = std::uint64_t;
+  using counter_type = std::array<std::uint32_t, 4>;
+  using key_type = std::array<std::uint32_t, 2>;
+ public:
+  explicit Philox4x32(std::uint64_t seed = 0, std::uint64_t stream = 0);
+  Philox4x32(const Philox4x32 &engine);
+  ~Philox4x32();
+  static constexpr result_type min() {
+    return 0;
+  }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+  result_type operator()() {
+    if (this->position == this->output.size()) {
+      generate();
+    }
+    return this->output[this->position++];
+  }
+  void setStream(std::uint64_t stream);
+  std::uint64_t getStream() const;
+  void discard(unsigned long long n);
+  static counter_type generateBlock(counter_type counter, key_type key);
+ private:
+  key_type key;
+  std::uint64_t stream;
+  std::uint64_t counter;  // of the next block
+  std::array<result_type, 2> output;
+  unsigned int position;  // in output, 2 when exhausted
+  void generate();
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_PHILOX4X32_H_ */
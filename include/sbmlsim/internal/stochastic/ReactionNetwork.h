@@ -0,0 +1,50 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_REACTIONNETWORK_H_
+#define INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_REACTIONNETWORK_H_
+
+#include <vector>
+#include "sbmlsim/internal/system/SBMLSystem.h"
+
+struct StateChange {
+  unsigned int index;  // state index
+  double delta;        // stoichiometry, negative for reactants
+};
+
+/*
+ * The reactions of an SBMLSystem as a discrete jump process: the kinetic law of reaction j is its
+ * propensity a_j(x, t) and firing it adds column j of the stoichiometry matrix to the amounts. Reversible
+ * reactions and kinetic laws evaluating to a negative propensity are rejected.
+ *
+ * The dependency graph lists, for every reaction, the reactions whose propensity reads a state variable
+ * it changes, so that only those have to be re-evaluated after it fires. Reactions reading time or an
+ * assignment rule target cannot be tracked this way; they are volatile and re-evaluated after every firing.
+ */
+class ReactionNetwork {
+ public:
+  using state = SBMLSystem::state;
+ public:
+  explicit ReactionNetwork(SBMLSystem &system);
+  ReactionNetwork(const ReactionNetwork &network);
+  ~ReactionNetwork();
+  unsigned int getNumReactions() const;
+  double evaluateRate(unsigned int reaction, const state &x, double t);
+  double evaluatePropensity(unsigned int reaction, const state &x, double t);
+  void fire(unsigned int reaction, state &x, double t);
+  void applyStateChanges(unsigned int reaction, double count, state &x) const;
+  void applyAssignmentRules(state &x, double t);
+  double getStepLimit(double t, double until) const;
+  const std::vector<StateChange> &getStateChanges(unsigned int reaction) const;
+  const std::vector<StateChange> &getReactants(unsigned int reaction) const;
+  const std::vector<unsigned int> &getDependents(unsigned int reaction) const;
+  const std::vector<unsigned int> &getVolatileReactions() const;
+  SBMLSystem &getSystem() const;
+ private:
+  SBMLSystem *system;
+  std::vector<std::vector<StateChange> > changes;
+  std::vector<std::vector<StateChange> > reactants;  // delta is the stoichiometry
+  std::vector<std::vector<unsigned int> > dependents;
+  std::vector<unsigned int> volatileReactions;
+  bool hasAssignmentRules;
+  std::vector<double> stack;
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_REACTIONNETWORK_H_ */
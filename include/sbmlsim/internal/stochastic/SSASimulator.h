@@ -0,0 +1,39 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_SSASIMULATOR_H_
+#define INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_SSASIMULATOR_H_
+
+#include "sbmlsim/internal/stochastic/CompositionRejectionSampler.h"
+#include "sbmlsim/internal/stochastic/Philox4x32.h"
+#include "sbmlsim/internal/stochastic/ReactionNetwork.h"
+
+/*
+ * Gillespie's direct method. The next reaction is drawn with composition-rejection sampling and only the
+ * propensities in the dependency graph of the fired reaction are re-evaluated, so a step costs O(1) in the
+ * number of reactions for networks of bounded connectivity.
+ *
+ * Events are checked after every firing and at every call that reaches its time limit; when an event
+ * changes the state all propensities are re-evaluated.
+ */
+class SSASimulator {
+ public:
+  using state = SBMLSystem::state;
+ public:
+  SSASimulator(SBMLSystem &system, unsigned long seed);
+  SSASimulator(const SSASimulator &simulator);
+  ~SSASimulator();
+  void initialize(const state &x, double t);
+  bool step(state &x, double &t, double until);
+  void setStream(unsigned long stream);
+  unsigned long getNumFirings() const;
+ private:
+  ReactionNetwork network;
+  CompositionRejectionSampler sampler;
+  Philox4x32 engine;
+  bool hasEvents;
+  state previous;  // state before the event check
+  unsigned long numFirings;
+  void updatePropensities(const std::vector<unsigned int> &reactions, const state &x, double t);
+  void updateAllPropensities(const state &x, double t);
+  void handleEvent(state &x, double t);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_SSASIMULATOR_H_ */
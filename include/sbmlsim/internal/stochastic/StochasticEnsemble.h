@@ -0,0 +1,98 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_STOCHASTICENSEMBLE_H_
+#define INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_STOCHASTICENSEMBLE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+#include "sbmlsim/internal/observer/ObserveTarget.h"
+#include "sbmlsim/internal/system/SBMLSystem.h"
+#include "sbmlsim/internal/util/ThreadPool.h"
+
+struct EnsembleStatistics {
+  std::vector<std::string> ids;                 // of the targets
+  std::vector<double> times;
+  std::vector<std::vector<double> > means;      // by sample time, then by target
+  std::vector<std::vector<double> > variances;  // unbiased sample variances, laid out as means
+  unsigned long numTrajectories;
+};
+
+/*
+ * Runs independent trajectories of one model on a thread pool and reduces the observed targets at every
+ * sample time to their mean and variance.
+ *
+ * Trajectory i draws from stream i of the seed. Every block copies the prototype system, which carries
+ * every piece of mutable simulation state (trigger values, event queue, evaluation stack), and builds its
+ * simulator once; both are reset at the start of each of its trajectories. The ModelWrapper behind them is
+ * only read. Trajectories are reduced in fixed blocks that depend on their number
+ * alone, and blocks are merged in order, so the statistics are bit-for-bit the same for any number of
+ * threads and any scheduling.
+ */
+class StochasticEnsemble {
+ public:
+  using state = SBMLSystem::state;
+ public:
+  StochasticEnsemble(const SBMLSystem &system, const std::vector<ObserveTarget> &targets, unsigned int numThreads = 0);
+  StochasticEnsemble(const StochasticEnsemble &ensemble) = delete;
+  ~StochasticEnsemble();
+  unsigned int getNumThreads() const;
+  // factory builds the simulator of one block on its system, e.g. a SSASimulator with the shared seed
+  template<class Simulator>
+  EnsembleStatistics run(unsigned long numTrajectories, double start, double duration, double interval,
+                         const std::function<Simulator(SBMLSystem &)> &factory) {
+    auto numSamples = static_cast<unsigned long>(std::floor((duration - start) / interval + 1e-9)) + 1;
+    auto initialState = prepareInitialState(start);
+    auto numBlocks = std::min(numTrajectories, MAX_BLOCKS);
+    std::vector<Accumulator> blocks(numBlocks);
+
+    this->pool.parallelFor(numBlocks, [&](unsigned long block, unsigned int) {
+      auto &accumulator = blocks[block];
+      accumulator.reset(numSamples * this->targets.size());
+      std::vector<double> values(this->targets.size());
+      SBMLSystem system(this->prototype);
+      Simulator simulator = factory(system);
+      for (auto i = block * numTrajectories / numBlocks; i < (block + 1) * numTrajectories / numBlocks; i++) {
+        system.resetEvents();
+        simulator.setStream(i);
+        state x = initialState;
+        double t = start;
+        simulator.initialize(x, t);
+        accumulator.count++;
+        observe(x, values);
+        accumulator.add(0, values);
+        for (unsigned long k = 1; k < numSamples; k++) {
+          double sample = start + k * interval;
+          while (simulator.step(x, t, sample)) {
+            // nothing to do
+          }
+          observe(x, values);
+          accumulator.add(k, values);
+        }
+      }
+    });
+
+    return reduce(blocks, numSamples, start, interval);
+  }
+ private:
+  // Welford's running mean and sum of squared deviations for every (sample, target)
+  struct Accumulator {
+    unsigned long count;
+    std::vector<double> mean;
+    std::vector<double> m2;
+    void reset(std::size_t size);
+    void add(unsigned long sample, const std::vector<double> &values);
+    void merge(const Accumulator &other);
+  };
+  static const unsigned long MAX_BLOCKS = 256;
+  SBMLSystem prototype;
+  std::vector<ObserveTarget> targets;
+  std::vector<double> constants;
+  ThreadPool pool;
+  state prepareInitialState(double start);
+  void observe(const state &x, std::vector<double> &values) const;
+  EnsembleStatistics reduce(std::vector<Accumulator> &blocks, unsigned long numSamples, double start,
+                            double interval) const;
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_STOCHASTICENSEMBLE_H_ */
@@ -0,0 +1,66 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_TAULEAPINGSIMULATOR_H_
+#define INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_TAULEAPINGSIMULATOR_H_
+
+#include <vector>
+#include "sbmlsim/internal/stochastic/CompositionRejectionSampler.h"
+#include "sbmlsim/internal/stochastic/Philox4x32.h"
+#include "sbmlsim/internal/stochastic/ReactionNetwork.h"
+
+/*
+ * Adaptive tau-leaping of Cao, Gillespie and Petzold (2006).
+ *
+ * A reaction is critical when it can fire fewer than CRITICAL_FIRINGS more times before one of its
+ * reactants runs out. tau is chosen so that the expected change and the standard deviation of every
+ * reactant of the non-critical reactions stay below epsilon * x_i / g_i, and non-critical reactions fire
+ * binomial(L_j, a_j tau / L_j) times, L_j being the number of firings left (Poisson when unbounded);
+ * at most one critical reaction fires per leap. A leap that still drives a state negative is retried
+ * with half the tau.
+ *
+ * When tau would not cover EXACT_THRESHOLD expected SSA steps, initially or after halving, the simulator
+ * runs EXACT_STEPS steps of the direct method instead.
+ */
+class TauLeapingSimulator {
+ public:
+  using state = SBMLSystem::state;
+  static const unsigned int CRITICAL_FIRINGS = 10;
+  static const unsigned int EXACT_THRESHOLD = 10;
+  static const unsigned int EXACT_STEPS = 100;
+ public:
+  TauLeapingSimulator(SBMLSystem &system, unsigned long seed, double epsilon = 0.03);
+  TauLeapingSimulator(const TauLeapingSimulator &simulator);
+  ~TauLeapingSimulator();
+  void initialize(const state &x, double t);
+  bool step(state &x, double &t, double until);
+  void setStream(unsigned long stream);
+  unsigned long getNumFirings() const;
+  unsigned long getNumLeaps() const;
+  unsigned long getNumExactSteps() const;
+ private:
+  ReactionNetwork network;
+  CompositionRejectionSampler sampler;
+  Philox4x32 engine;
+  double epsilon;
+  bool hasEvents;
+  std::vector<unsigned int> highestOrder;         // by state, of the reactions consuming it
+  std::vector<double> highestOrderStoichiometry;  // of the state in that reaction
+  std::vector<double> firingsLeft;                // L_j, infinite without consumed reactants
+  std::vector<bool> critical;
+  std::vector<double> mean;
+  std::vector<double> variance;
+  std::vector<bool> reactantOfNonCritical;
+  state trial;
+  state previous;  // state before the event check
+  unsigned int exactStepsLeft;
+  unsigned long numFirings;
+  unsigned long numLeaps;
+  unsigned long numExactSteps;
+  bool exactStep(state &x, double &t, double until);
+  bool leap(state &x, double &t, double until);
+  bool startExactSteps(state &x, double &t, double until);
+  double selectLeapTime(const state &x);
+  double drawFirings(unsigned int reaction, double tau);
+  void updateAllPropensities(const state &x, double t);
+  void handleEvent(state &x, double t);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_STOCHASTIC_TAULEAPINGSIMULATOR_H_ */
@@ -0,0 +1,46 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_SYSTEM_EVENTQUEUE_H_
+#define INCLUDE_SBMLSIM_INTERNAL_SYSTEM_EVENTQUEUE_H_
+
+#include <queue>
+#include <vector>
+
+struct ScheduledEvent {
+  double time;                 // execution time, trigger time + delay
+  unsigned int event;          // index in ModelWrapper::getEvents()
+  unsigned long sequence;      // scheduling order, breaks ties deterministically
+  unsigned long generation;    // cancellation counter of the event when scheduled
+  std::vector<double> values;  // assignment values from the trigger time, empty if evaluated on execution
+};
+
+/*
+ * Pending event executions ordered by execution time, in a binary heap so that scheduling and popping an
+ * execution costs O(log n) regardless of the number of events in the model.
+ *
+ * Cancelling the executions of a non-persistent event only bumps its generation; stale entries are dropped
+ * lazily when they reach the top.
+ */
+class EventQueue {
+ public:
+  EventQueue();
+  explicit EventQueue(unsigned int numEvents);
+  EventQueue(const EventQueue &queue);
+  ~EventQueue();
+  void schedule(double time, unsigned int event, std::vector<double> values);
+  void cancel(unsigned int event);
+  bool isCancelled(const ScheduledEvent &scheduled) const;
+  bool empty();
+  double getNextTime();
+  ScheduledEvent pop();
+ private:
+  struct Later {
+    bool operator()(const ScheduledEvent &a, const ScheduledEvent &b) const {
+      return a.time > b.time || (a.time == b.time && a.sequence > b.sequence);
+    }
+  };
+  std::priority_queue<ScheduledEvent, std::vector<ScheduledEvent>, Later> queue;
+  std::vector<unsigned long> generations;
+  unsigned long sequence;
+  void discardCancelled();
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_SYSTEM_EVENTQUEUE_H_ */
@@ -0,0 +1,27 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_SYSTEM_IMPLICITSYSTEM_H_
+#define INCLUDE_SBMLSIM_INTERNAL_SYSTEM_IMPLICITSYSTEM_H_
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include "sbmlsim/internal/system/SBMLSystem.h"
+#include "sbmlsim/internal/system/SBMLSystemJacobi.h"
+
+/*
+ * SBMLSystem and its Jacobian as the (system, jacobian) pair odeint's implicit steppers take, with the
+ * hooks of sbmlsim::integrate_const forwarded to the SBMLSystem.
+ */
+class ImplicitSystem : public std::pair<std::reference_wrapper<SBMLSystem>, std::reference_wrapper<SBMLSystemJacobi> > {
+ public:
+  using state = SBMLSystem::state;
+ public:
+  ImplicitSystem(SBMLSystem &system, SBMLSystemJacobi &jacobi);
+  ~ImplicitSystem();
+  void handleEvent(state &x, double t);
+  void handleInitialAssignment(state &x, double t);
+  void handleAssignmentRule(state &x, double t);
+  std::size_t getNumEvents() const;
+  double evaluateEventFunction(unsigned int i, const state &x, double t);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_SYSTEM_IMPLICITSYSTEM_H_ */
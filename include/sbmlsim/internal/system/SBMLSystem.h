@@ -2,15 +2,36 @@
 #define INCLUDE_SBMLSIM_INTERNAL_SYSTEM_SBMLSYSTEM_H_
 
 #include <sbml/SBMLTypes.h>
+#include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <boost/numeric/ublas/vector.hpp>
 #include "sbmlsim/internal/wrapper/ModelWrapper.h"
+#include "sbmlsim/internal/compiler/CompiledExpression.h"
+#include "sbmlsim/internal/compiler/SymbolTable.h"
+#include "sbmlsim/internal/codegen/NativeModel.h"
+#include "sbmlsim/internal/system/EventQueue.h"
+#include "sbmlsim/internal/system/StoichiometryMatrix.h"
 #include "sbmlsim/config/OutputField.h"
 #include "sbmlsim/internal/observer/ObserveTarget.h"
 
 using namespace boost::numeric;
 
+struct VariableStoichiometry {
+  unsigned int entry;  // position in the values of the stoichiometry matrix
+  double sign;         // -1 for reactants, +1 for products
+  CompiledExpression expression;
+};
+
+// trigger of the form time > c (or time >= c), which switches to true exactly once
+struct TimeTrigger {
+  double time;
+  bool inclusive;
+  unsigned int event;
+};
+
 class SBMLSystem {
  public:
   using state = ublas::vector<double>;
@@ -25,21 +46,96 @@ class SBMLSystem {
   void handleAlgebraicRule(state &x, double t);
   void handleAssignmentRule(state &x, double t);
   void handleRateRule(state &x, double t);
+  std::size_t getNumEvents() const;
+  double evaluateEventFunction(unsigned int i, const state &x, double t);
+  double getNextScheduledTime();
+  void resetEvents();
   state getInitialState();
   unsigned int getStateIndexForVariable(const std::string &variableId);
+  bool isConstant(const std::string &variableId) const;
+  unsigned int getConstantIndexForVariable(const std::string &variableId);
+  const std::vector<double> &getConstants() const;
   std::vector<ObserveTarget> createOutputTargetsFromOutputFields(const std::vector<OutputField> &outputFields);
+  const ModelWrapper *getModel() const;
+  const std::vector<CompiledExpression> &getKineticLaws() const;
+  const std::vector<std::vector<CompiledExpression> > &getReactantStoichiometries() const;
+  const std::vector<std::vector<CompiledExpression> > &getProductStoichiometries() const;
+  const std::vector<CompiledExpression> &getRateRules() const;
+  const std::vector<CompiledExpression> &getAssignmentRules() const;
+  const std::vector<Symbol> &getAssignmentRuleTargets() const;
+  const std::vector<CompiledExpression> &getEventTriggers() const;
+  const std::vector<CompiledExpression> &getEventFunctions() const;
+  const std::vector<CompiledExpression> &getEventPriorities() const;
+  const std::vector<std::vector<CompiledExpression> > &getEventAssignments() const;
+  const SymbolTable &getSymbolTable() const;
+  const StoichiometryMatrix &getStoichiometryMatrix() const;
+  void setNativeModel(std::shared_ptr<NativeModel> nativeModel);
+  bool hasNativeModel() const;
+  static void collectReads(const CompiledExpression &expression, std::set<unsigned int> &reads, bool &readsTime);
  private:
-  ModelWrapper *model;
+  const ModelWrapper *model;
   state initialState;
   std::unordered_map<std::string, unsigned int> stateIndexMap;
+  std::vector<double> constants;
+  std::unordered_map<std::string, unsigned int> constantIndexMap;
+  SymbolTable symbolTable;
+  std::vector<CompiledExpression> kineticLaws;
+  std::vector<std::vector<CompiledExpression> > reactantStoichiometries;
+  std::vector<std::vector<CompiledExpression> > productStoichiometries;
+  std::vector<CompiledExpression> rateRules;
+  std::vector<CompiledExpression> initialAssignments;
+  std::vector<Symbol> initialAssignmentTargets;
+  std::vector<CompiledExpression> assignmentRules;
+  std::vector<Symbol> assignmentRuleTargets;
+  std::vector<CompiledExpression> eventTriggers;
+  std::vector<CompiledExpression> eventFunctions;  // continuous, positive while the trigger is true
+  std::vector<std::vector<CompiledExpression> > eventAssignments;
+  std::vector<CompiledExpression> eventDelays;      // empty for events without delay
+  std::vector<CompiledExpression> eventPriorities;  // empty for events without priority
+  EventQueue eventQueue;
+  std::vector<ScheduledEvent> dueEvents;
+  bool hasDelayedEvents;
+  std::vector<TimeTrigger> timeTriggers;  // sorted by switch time
+  unsigned int nextTimeTrigger;
+  std::vector<std::vector<unsigned int> > triggerDependents;  // state index -> events whose trigger reads it
+  std::vector<unsigned int> timeDependentTriggers;          // evaluated at every check
+  std::vector<unsigned int> eventFunctionEvents;            // events that have an event function of their own
+  std::vector<bool> triggerStates;                          // trigger values at the last check
+  state triggerInputs;                                      // state at the last trigger check
+  bool triggersInitialized;
+  std::vector<bool> triggerMarked;
+  std::vector<unsigned int> markedTriggers;
+  std::vector<double> stack;
+  StoichiometryMatrix stoichiometryMatrix;
+  std::vector<VariableStoichiometry> variableStoichiometries;
+  std::vector<unsigned int> variableStoichiometryEntries;
+  std::vector<double> variableStoichiometryBases;
+  std::vector<double> reactionRates;
+  std::vector<unsigned int> rateRuleIndices;
+  std::vector<unsigned int> fixedSpeciesIndices;
+  std::shared_ptr<NativeModel> nativeModel;
+  double evaluateCompiledExpression(const CompiledExpression &expression, const state &x, double t);
   double evaluateASTNode(const ASTNode *node, const state &x);
   double evaluateNameNode(const ASTNode *node, const state &x);
+  double evaluateSymbol(const Symbol &symbol, const state &x);
+  void assignSymbol(const Symbol &symbol, state &x, double value);
   double evaluateFunctionNode(const ASTNode *node, const state &x);
   double evaluateFactorialNode(const ASTNode *node, const state &x);
   double evaluatePiecewiseNode(const ASTNode *node, const state &x);
   bool evaluatePiecewiseConditionalNode(const ASTNode *node, const state &x);
   bool evaluateTriggerNode(const ASTNode *trigger, const state &x);
+  void updateEventTriggers(state &x, double t);
+  void updateEventTrigger(unsigned int i, state &x, double t);
+  void scheduleEvent(unsigned int i, const state &x, double t);
+  unsigned int selectDueEvent(const state &x, double t);
+  void executeEvent(const ScheduledEvent &scheduled, state &x, double t);
   void prepareInitialState();
+  void prepareCompiledExpressions();
+  void prepareEventIndex();
+  bool isTimeTrigger(const ASTNode *trigger, TimeTrigger &timeTrigger);
+  void prepareStoichiometryMatrix();
+  CompiledExpression compileExpression(const ASTNode *node);
+  static ASTNode *createEventFunctionNode(const ASTNode *trigger);
 };
 
 #endif /* INCLUDE_SBMLSIM_INTERNAL_SYSTEM_SBMLSYSTEM_H_ */
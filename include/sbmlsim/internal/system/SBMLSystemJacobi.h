@@ -1,17 +1,111 @@
 #ifndef INCLUDE_SBMLSIM_INTERNAL_SYSTEM_SBMLSYSTEMJACOBI_H_
 #define INCLUDE_SBMLSIM_INTERNAL_SYSTEM_SBMLSYSTEMJACOBI_H_
 
+#include <sbml/SBMLTypes.h>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 #include <boost/numeric/ublas/vector.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
+#include "sbmlsim/config/RunConfiguration.h"
+#include "sbmlsim/internal/compiler/CompiledExpression.h"
+#include "sbmlsim/internal/system/SBMLSystem.h"
 
 using namespace boost::numeric;
 
+struct JacobianTerm {
+  unsigned int column;      // rate term
+  unsigned int stateIndex;  // state variable the rate term is differentiated by
+  CompiledExpression derivative;                          // empty for automatic differentiation
+  std::vector<std::pair<unsigned int, double> > entries;  // (position in the compressed values, coefficient)
+};
+
+/*
+ * Analytic Jacobian of SBMLSystem.
+ *
+ * The RHS is written as f = sum_c n_c * r_c(x, t): one rate term r_c per reaction, per stoichiometryMath
+ * entry (stoichiometry * rate) and per rate rule, scattered to the rows n_c.
+ *
+ * By default every r_c is compiled once and dr_c/dx_j is obtained by forward-mode automatic differentiation
+ * (CompiledExpression::evaluateTangent), seeded with one state variable at a time; the cost of a Jacobian
+ * entry is that of one rate evaluation and the derivative is exact. With SYMBOLIC_DIFFERENTIATION the r_c are
+ * differentiated with MathUtil::differentiate at load time instead, with the chain rule applied to species
+ * read as concentrations, and the derivatives are compiled like the RHS itself.
+ *
+ * J is stored in compressed sparse row format. Its structure is taken from the variables each rate term
+ * reads, so memory and evaluation cost scale with the number of structural non-zeros. operator() scatters
+ * the compressed values into the dense matrix expected by odeint's rosenbrock4.
+ *
+ * With SYMBOLIC_DIFFERENTIATION, a rate term that cannot be differentiated exactly (see MathUtil::isDifferentiable)
+ * makes the whole Jacobian fall back to forward differences of the RHS. The columns are grouped with
+ * Curtis-Powell-Reid coloring, so that columns sharing no row are perturbed together and J costs one RHS
+ * evaluation per color.
+ *
+ * Targets of assignment rules are state variables that are not integrated. Rate terms are differentiated
+ * with every rule target replaced by the math of its rule, so J includes d{rule}/d{x_j} by the chain rule;
+ * finite differences apply the rules to the perturbed state.
+ */
 class SBMLSystemJacobi {
  public:
   using state = ublas::vector<double>;
   using matrix = ublas::matrix<double>;
+  using column = std::vector<std::pair<unsigned int, double> >;  // (row, coefficient)
  public:
+  explicit SBMLSystemJacobi(SBMLSystem &system,
+                            JacobianMethod method = JacobianMethod::AUTOMATIC_DIFFERENTIATION);
+  SBMLSystemJacobi(const SBMLSystemJacobi &jacobi);
+  ~SBMLSystemJacobi();
   void operator()(const state &x, matrix &J, const double &t, state &dfdt);
+  void evaluate(const state &x, double t);
+  void evaluateParameterDerivative(const state &x, double t, unsigned int constantIndex, state &dfdp);
+  unsigned int getNumStates() const;
+  unsigned int getNumNonZeros() const;
+  const std::vector<unsigned int> &getRowPointers() const;
+  const std::vector<unsigned int> &getColumnIndices() const;
+  const std::vector<double> &getValues() const;
+  JacobianMethod getMethod() const;
+  unsigned int getNumColors() const;
+ private:
+  unsigned int numStates;
+  JacobianMethod method;
+  std::vector<unsigned int> rowPointers;
+  std::vector<unsigned int> columnIndices;
+  std::vector<double> values;
+  std::vector<column> columns;
+  std::vector<std::vector<unsigned int> > dependencies;  // state variables read by each rate term
+  std::vector<JacobianTerm> terms;
+  std::vector<JacobianTerm> timeTerms;
+  std::vector<double> constants;
+  std::vector<double> stack;
+  // automatic differentiation
+  std::vector<CompiledExpression> rates;  // r_c for each rate term
+  std::vector<double> tangents;
+  std::vector<double> stateSeed;
+  std::vector<double> constantSeed;
+  // finite differences
+  std::shared_ptr<SBMLSystem> system;
+  std::vector<std::vector<unsigned int> > colorColumns;
+  std::vector<std::vector<std::pair<unsigned int, unsigned int> > > colorEntries;  // (position, row)
+  state f0;
+  state f1;
+  state perturbed;
+  // assignment rules
+  std::map<unsigned int, std::string> assignmentRuleTargets;  // state index -> variable
+  std::map<std::string, std::shared_ptr<ASTNode> > inlinedAssignmentRules;
+  void prepareRateTerms(SBMLSystem &system);
+  void prepareSparsityPattern();
+  void prepareColoring();
+  void evaluateFiniteDifference(const state &x, double t);
+  double evaluateTerm(const JacobianTerm &term, const double *x, double t, bool time);
+  void addRateTerm(SBMLSystem &system, const ASTNode *rate, const column &entries);
+  ASTNode *inlineAssignmentRules(SBMLSystem &system, const ASTNode *node);
+  void collectReads(SBMLSystem &system, const std::set<std::string> &names, std::set<unsigned int> &reads);
+  ASTNode *createChainRuleFactor(SBMLSystem &system, const std::string &name, unsigned int stateIndex);
+  void addDerivative(SBMLSystem &system, std::vector<JacobianTerm> &target, unsigned int column,
+                     unsigned int stateIndex, const ASTNode *derivative);
 };
 
 #endif /* INCLUDE_SBMLSIM_INTERNAL_SYSTEM_SBMLSYSTEMJACOBI_H_ */
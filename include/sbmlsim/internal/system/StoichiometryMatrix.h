@@ -0,0 +1,39 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_SYSTEM_STOICHIOMETRYMATRIX_H_
+#define INCLUDE_SBMLSIM_INTERNAL_SYSTEM_STOICHIOMETRYMATRIX_H_
+
+#include <vector>
+
+struct StoichiometryEntry {
+  unsigned int row;     // state index
+  unsigned int column;  // reaction index
+  double value;
+};
+
+/*
+ * Stoichiometry matrix N (states x reactions) in compressed sparse row format, so that dxdt = N * v
+ * is a single pass over the non-zeros without scattering.
+ */
+class StoichiometryMatrix {
+ public:
+  StoichiometryMatrix();
+  StoichiometryMatrix(unsigned int numRows, unsigned int numColumns, std::vector<StoichiometryEntry> entries);
+  StoichiometryMatrix(const StoichiometryMatrix &matrix);
+  ~StoichiometryMatrix();
+  unsigned int getNumRows() const;
+  unsigned int getNumColumns() const;
+  unsigned int getNumNonZeros() const;
+  const std::vector<unsigned int> &getRowPointers() const;
+  const std::vector<unsigned int> &getColumnIndices() const;
+  const std::vector<double> &getValues() const;
+  unsigned int findEntry(unsigned int row, unsigned int column) const;
+  void setValue(unsigned int entry, double value);
+  void multiply(const double *v, double *y) const;
+ private:
+  unsigned int numRows;
+  unsigned int numColumns;
+  std::vector<unsigned int> rowPointers;
+  std::vector<unsigned int> columnIndices;
+  std::vector<double> values;
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_SYSTEM_STOICHIOMETRYMATRIX_H_ */
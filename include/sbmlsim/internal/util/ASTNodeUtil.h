@@ -2,12 +2,17 @@
 #define INCLUDE_SBMLSIM_INTERNAL_UTIL_ASTNODEUTIL_H_
 
 #include <sbml/SBMLTypes.h>
+#include <set>
+#include <string>
 
 class ASTNodeUtil {
  public:
   static ASTNode *rewriteFunctionDefinition(const ASTNode *node, const ListOfFunctionDefinitions *functionDefinitions);
   static ASTNode *rewriteLocalParameters(const ASTNode *node, const ListOfParameters *localParameters);
   static ASTNode *reduceToBinary(const ASTNode *node);
+  static ASTNode *rewriteTimeToName(const ASTNode *node, const std::string &name);
+  static ASTNode *rewriteNameToTime(const ASTNode *node, const std::string &name);
+  static void collectNames(const ASTNode *node, std::set<std::string> &names);
  private:
   ASTNodeUtil() {}
   ~ASTNodeUtil() {}
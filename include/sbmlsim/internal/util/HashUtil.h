@@ -0,0 +1,14 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_UTIL_HASHUTIL_H_
+#define INCLUDE_SBMLSIM_INTERNAL_UTIL_HASHUTIL_H_
+
+#include <string>
+
+class HashUtil {
+ public:
+  static std::string sha256(const std::string &message);  // lowercase hex digest (FIPS 180-4)
+ private:
+  HashUtil() {}
+  ~HashUtil() {}
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_UTIL_HASHUTIL_H_ */
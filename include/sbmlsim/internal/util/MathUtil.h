@@ -10,6 +10,7 @@ class MathUtil {
   static long long ceil(double f);
   static double pow(double x, double y);
   static bool containsTarget(const ASTNode *ast, std::string target);
+  static bool isDifferentiable(const ASTNode *ast);
   static ASTNode* simplify(const ASTNode *ast);
   static ASTNode* differentiate(const ASTNode *ast, std::string target);
  private:
@@ -9,6 +9,7 @@ class RuntimeExceptionUtil {
   static void throwUnknownNodeNameException(const std::string &nodeName);
   static void throwInvalidFlowException();
   static void throwArithmeticException();
+  static void throwUnsupportedFeatureException(const std::string &feature);
   private:
   static void throwRuntimeException(const std::string &message);
 };
@@ -0,0 +1,42 @@
+#ifndef INCLUDE_SBMLSIM_INTERNAL_UTIL_THREADPOOL_H_
+#define INCLUDE_SBMLSIM_INTERNAL_UTIL_THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Fixed set of worker threads running index-parallel loops. Workers claim indices from a shared atomic
+ * counter, so uneven tasks balance themselves; the worker number passed to the task lets callers keep
+ * per-thread scratch data without locking. The first exception thrown by a task stops the loop and is
+ * rethrown by parallelFor. Loops are run one at a time.
+ */
+class ThreadPool {
+ public:
+  using task_function = std::function<void(unsigned long index, unsigned int worker)>;
+ public:
+  explicit ThreadPool(unsigned int numThreads = 0);  // 0 for one thread per hardware thread
+  ThreadPool(const ThreadPool &pool) = delete;
+  ~ThreadPool();
+  unsigned int getNumThreads() const;
+  void parallelFor(unsigned long count, const task_function &task);
+ private:
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable started;
+  std::condition_variable finished;
+  const task_function *task;
+  unsigned long count;
+  std::atomic<unsigned long> next;
+  unsigned long generation;  // of the current loop
+  unsigned int numBusy;
+  bool stopping;
+  std::exception_ptr error;
+  void work(unsigned int worker);
+};
+
+#endif /* INCLUDE_SBMLSIM_INTERNAL_UTIL_THREADPOOL_H_ */
@@ -11,13 +11,22 @@ class EventWrapper {
   EventWrapper(const EventWrapper &event);
   ~EventWrapper();
   const ASTNode *getTrigger() const;
+  const ASTNode *getDelay() const;
+  const ASTNode *getPriority() const;
+  bool hasDelay() const;
+  bool hasPriority() const;
+  bool isPersistent() const;
+  bool getInitialValue() const;
+  bool getUseValuesFromTriggerTime() const;
   const std::vector<EventAssignmentWrapper> &getEventAssignments() const;
-  void setTriggerState(bool triggerState);
-  bool getTriggerState() const;
  private:
   ASTNode *trigger;
+  ASTNode *delay;     // NULL without <delay>
+  ASTNode *priority;  // NULL without <priority>
+  bool persistent;
+  bool initialValue;
+  bool useValuesFromTriggerTime;
   std::vector<EventAssignmentWrapper> eventAssignments;
-  bool triggerState;
 };
 
 #endif /* INCLUDE_SBMLSIM_INTERNAL_WRAPPER_EVENTWRAPPER_H_ */
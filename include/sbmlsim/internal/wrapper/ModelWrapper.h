@@ -19,13 +19,13 @@ class ModelWrapper {
   ModelWrapper(const ModelWrapper &model);
   ~ModelWrapper();
   const std::vector<SpeciesWrapper> &getSpecieses() const;
-  std::vector<ParameterWrapper *> &getParameters();
+  const std::vector<ParameterWrapper *> &getParameters() const;
   const std::vector<CompartmentWrapper> &getCompartments() const;
   const std::vector<ReactionWrapper> &getReactions() const;
-  std::vector<EventWrapper *> &getEvents();
-  std::vector<InitialAssignmentWrapper *> &getInitialAssignments();
-  std::vector<AssignmentRuleWrapper *> &getAssignmentRules();
-  std::vector<RateRuleWrapper *> &getRateRules();
+  const std::vector<EventWrapper *> &getEvents() const;
+  const std::vector<InitialAssignmentWrapper *> &getInitialAssignments() const;
+  const std::vector<AssignmentRuleWrapper *> &getAssignmentRules() const;
+  const std::vector<RateRuleWrapper *> &getRateRules() const;
  private:
   std::vector<SpeciesWrapper> specieses;
   std::vector<ParameterWrapper *> parameters;
@@ -14,9 +14,11 @@ class ReactionWrapper {
   const std::string &getId() const;
   const std::vector<SpeciesReferenceWrapper> &getReactants() const;
   const std::vector<SpeciesReferenceWrapper> &getProducts() const;
-  const ASTNode *getMath();
+  const ASTNode *getMath() const;
+  bool isReversible() const;
  private:
   std::string id;
+  bool reversible;
   std::vector<SpeciesReferenceWrapper> reactants;
   std::vector<SpeciesReferenceWrapper> products;
   ASTNode *math;
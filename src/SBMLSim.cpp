@@ -1,15 +1,83 @@
 #include "sbmlsim/SBMLSim.h"
 
+#include <cmath>
 #include <iostream>
 #include <boost/numeric/odeint.hpp>
+#include "sbmlsim/internal/codegen/JITCompiler.h"
+#include "sbmlsim/internal/integrate/AutoSwitchingStepper.h"
+#include "sbmlsim/internal/integrate/BDFStepper.h"
 #include "sbmlsim/internal/system/SBMLSystem.h"
+#include "sbmlsim/internal/system/ImplicitSystem.h"
 #include "sbmlsim/internal/system/SBMLSystemJacobi.h"
 #include "sbmlsim/internal/integrate/IntegrateConst.h"
 #include "sbmlsim/internal/observer/StdoutCsvObserver.h"
+#include "sbmlsim/internal/stochastic/CLESimulator.h"
+#include "sbmlsim/internal/stochastic/HybridSimulator.h"
+#include "sbmlsim/internal/stochastic/LinearNoiseApproximation.h"
+#include "sbmlsim/internal/stochastic/NextReactionSimulator.h"
+#include "sbmlsim/internal/stochastic/SSASimulator.h"
+#include "sbmlsim/internal/stochastic/TauLeapingSimulator.h"
 
 using namespace boost::numeric;
 using state = SBMLSystem::state;
 
+namespace {
+
+// fixed steps of the chemical Langevin equation per output interval
+const unsigned int CLE_STEPS_PER_INTERVAL = 100;
+
+// runs a stochastic simulator through the sample times of conf, printing the state at each of them
+template<class Simulator>
+void sampleStochastic(Simulator &simulator, SBMLSystem &system, const RunConfiguration &conf) {
+  auto x = system.getInitialState();
+  StdoutCsvObserver observer(system.createOutputTargetsFromOutputFields(conf.getOutputFields()), system.getConstants());
+
+  // print header
+  observer.outputHeader();
+
+  double t = conf.getStart();
+  system.handleInitialAssignment(x, t);
+  system.handleAssignmentRule(x, t);
+  observer(x, t);
+  simulator.initialize(x, t);
+  auto numSamples = static_cast<unsigned long>(
+      std::floor((conf.getDuration() - conf.getStart()) / conf.getStepInterval() + 1e-9));
+  for (unsigned long i = 1; i <= numSamples; i++) {
+    double sample = conf.getStart() + i * conf.getStepInterval();
+    while (simulator.step(x, t, sample)) {
+      // nothing to do
+    }
+    observer(x, sample);
+  }
+}
+
+// state variables set by assignment rules, which the steppers take over without restarting
+std::vector<unsigned int> getAssignmentRuleIndices(const SBMLSystem &system) {
+  std::vector<unsigned int> ret;
+  for (auto &target : system.getAssignmentRuleTargets()) {
+    ret.push_back(target.index);
+  }
+  return ret;
+}
+
+// dense copy of the stoichiometry matrix, with variable stoichiometries as of the last evaluation
+SteadyStateSolver::matrix createDenseStoichiometryMatrix(const SBMLSystem &system) {
+  auto &stoichiometry = system.getStoichiometryMatrix();
+  auto &rowPointers = stoichiometry.getRowPointers();
+  auto &columnIndices = stoichiometry.getColumnIndices();
+  auto &values = stoichiometry.getValues();
+  SteadyStateSolver::matrix ret(stoichiometry.getNumRows(), stoichiometry.getNumColumns());
+  ret.clear();
+  for (auto i = 0; i < stoichiometry.getNumRows(); i++) {
+    for (auto k = rowPointers[i]; k < rowPointers[i + 1]; k++) {
+      ret(i, columnIndices[k]) = values[k];
+    }
+  }
+  return ret;
+}
+
+}  // namespace
+
 void SBMLSim::simulate(const std::string &filepath, const RunConfiguration &conf) {
   SBMLReader reader;
   SBMLDocument *document = reader.readSBMLFromFile(filepath);
@@ -24,6 +92,52 @@ void SBMLSim::simulate(const SBMLDocument *document, const RunConfiguration &con
   simulate(model, level, version, conf);
 }
 
+SteadyState SBMLSim::findSteadyState(const std::string &filepath, const RunConfiguration &conf) {
+  SBMLReader reader;
+  SBMLDocument *document = reader.readSBMLFromFile(filepath);
+  auto result = findSteadyState(document, conf);
+  delete document;
+  return result;
+}
+
+SteadyState SBMLSim::findSteadyState(const SBMLDocument *document, const RunConfiguration &conf) {
+  Model *clonedModel = document->getModel()->clone();
+  SBMLDocument *dummyDocument = new SBMLDocument(document->getLevel(), document->getVersion());
+  clonedModel->setSBMLDocument(dummyDocument);
+  dummyDocument->setModel(clonedModel);
+
+  ModelWrapper *modelWrapper = new ModelWrapper(clonedModel);
+  auto result = findSteadyState(modelWrapper, conf);
+
+  delete modelWrapper;
+  delete dummyDocument;
+  return result;
+}
+
+EnsembleStatistics SBMLSim::simulateEnsemble(const std::string &filepath, const RunConfiguration &conf,
+                                             unsigned long numTrajectories, unsigned int numThreads) {
+  SBMLReader reader;
+  SBMLDocument *document = reader.readSBMLFromFile(filepath);
+  auto result = simulateEnsemble(document, conf, numTrajectories, numThreads);
+  delete document;
+  return result;
+}
+
+EnsembleStatistics SBMLSim::simulateEnsemble(const SBMLDocument *document, const RunConfiguration &conf,
+                                             unsigned long numTrajectories, unsigned int numThreads) {
+  Model *clonedModel = document->getModel()->clone();
+  SBMLDocument *dummyDocument = new SBMLDocument(document->getLevel(), document->getVersion());
+  clonedModel->setSBMLDocument(dummyDocument);
+  dummyDocument->setModel(clonedModel);
+
+  ModelWrapper *modelWrapper = new ModelWrapper(clonedModel);
+  auto result = simulateEnsemble(modelWrapper, conf, numTrajectories, numThreads);
+
+  delete modelWrapper;
+  delete dummyDocument;
+  return result;
+}
+
 void SBMLSim::simulate(const Model *model, unsigned int level, unsigned int version, const RunConfiguration &conf) {
   Model *clonedModel = model->clone();
   SBMLDocument *dummyDocument = new SBMLDocument(level, version);
@@ -32,10 +146,48 @@ void SBMLSim::simulate(const Model *model, unsigned int level, unsigned int vers
 
   ModelWrapper *modelWrapper = new ModelWrapper(clonedModel);
 
-  // simulateRungeKutta4(modelWrapper, conf);
-  simulateRungeKuttaDopri5(modelWrapper, conf);
-  // simulateRungeKuttaFehlberg78(modelWrapper, conf);
-  // simulateRosenbrock4(modelWrapper, conf);
+  switch (conf.getIntegrationMethod()) {
+    case IntegrationMethod::RUNGE_KUTTA_4:
+      simulateRungeKutta4(modelWrapper, conf);
+      break;
+    case IntegrationMethod::RUNGE_KUTTA_FEHLBERG78:
+      simulateRungeKuttaFehlberg78(modelWrapper, conf);
+      break;
+    case IntegrationMethod::ROSENBROCK4:
+      simulateRosenbrock4(modelWrapper, conf);
+      break;
+    case IntegrationMethod::BDF:
+      simulateBDF(modelWrapper, conf);
+      break;
+    case IntegrationMethod::AUTOMATIC:
+      simulateAutoSwitching(modelWrapper, conf);
+      break;
+    case IntegrationMethod::SSA:
+      simulateSSA(modelWrapper, conf);
+      break;
+    case IntegrationMethod::NEXT_REACTION:
+      simulateNextReaction(modelWrapper, conf);
+      break;
+    case IntegrationMethod::TAU_LEAPING:
+      simulateTauLeaping(modelWrapper, conf);
+      break;
+    case IntegrationMethod::HYBRID:
+      simulateHybrid(modelWrapper, conf);
+      break;
+    case IntegrationMethod::CLE_EULER_MARUYAMA:
+      simulateCLE(modelWrapper, conf, CLEScheme::EULER_MARUYAMA);
+      break;
+    case IntegrationMethod::CLE_MILSTEIN:
+      simulateCLE(modelWrapper, conf, CLEScheme::MILSTEIN);
+      break;
+    case IntegrationMethod::LNA:
+      simulateLNA(modelWrapper, conf);
+      break;
+    case IntegrationMethod::RUNGE_KUTTA_DOPRI5:
+    default:
+      simulateRungeKuttaDopri5(modelWrapper, conf);
+      break;
+  }
 
   delete modelWrapper;
   delete dummyDocument;
@@ -43,9 +195,10 @@ void SBMLSim::simulate(const Model *model, unsigned int level, unsigned int vers
 
 void SBMLSim::simulateRungeKutta4(const ModelWrapper *model, const RunConfiguration &conf) {
   SBMLSystem system(model);
+  prepareNativeModel(system, conf);
   odeint::runge_kutta4<state> stepper;
   auto initialState = system.getInitialState();
-  StdoutCsvObserver observer(system.createOutputTargetsFromOutputFields(conf.getOutputFields()));
+  StdoutCsvObserver observer(system.createOutputTargetsFromOutputFields(conf.getOutputFields()), system.getConstants());
 
   // print header
   observer.outputHeader();
@@ -57,25 +210,27 @@ void SBMLSim::simulateRungeKutta4(const ModelWrapper *model, const RunConfigurat
 
 void SBMLSim::simulateRungeKuttaDopri5(const ModelWrapper *model, const RunConfiguration &conf) {
   SBMLSystem system(model);
-  auto stepper = odeint::make_controlled<odeint::runge_kutta_dopri5<state> >(
-      conf.getAbsoluteTolerance(), conf.getRelativeTolerance());
+  prepareNativeModel(system, conf);
+  auto stepper = odeint::make_dense_output(conf.getAbsoluteTolerance(), conf.getRelativeTolerance(),
+                                           odeint::runge_kutta_dopri5<state>());
   auto initialState = system.getInitialState();
-  StdoutCsvObserver observer(system.createOutputTargetsFromOutputFields(conf.getOutputFields()));
+  StdoutCsvObserver observer(system.createOutputTargetsFromOutputFields(conf.getOutputFields()), system.getConstants());
 
   // print header
   observer.outputHeader();
 
   // integrate
-  sbmlsim::integrate_const(
-      stepper, system, initialState, conf.getStart(), conf.getDuration(), conf.getStepInterval(), std::ref(observer));
+  sbmlsim::integrate_const(stepper, system, initialState, conf.getStart(), conf.getDuration(),
+                           conf.getStepInterval(), std::ref(observer), getAssignmentRuleIndices(system));
 }
 
 void SBMLSim::simulateRungeKuttaFehlberg78(const ModelWrapper *model, const RunConfiguration &conf) {
   SBMLSystem system(model);
+  prepareNativeModel(system, conf);
   auto stepper = odeint::make_controlled<odeint::runge_kutta_fehlberg78<state> >(
       conf.getAbsoluteTolerance(), conf.getRelativeTolerance());
   auto initialState = system.getInitialState();
-  StdoutCsvObserver observer(system.createOutputTargetsFromOutputFields(conf.getOutputFields()));
+  StdoutCsvObserver observer(system.createOutputTargetsFromOutputFields(conf.getOutputFields()), system.getConstants());
 
   // print header
   observer.outputHeader();
@@ -87,17 +242,222 @@ void SBMLSim::simulateRungeKuttaFehlberg78(const ModelWrapper *model, const RunC
 
 void SBMLSim::simulateRosenbrock4(const ModelWrapper *model, const RunConfiguration &conf) {
   SBMLSystem system(model);
-  SBMLSystemJacobi systemJacobi;
+  prepareNativeModel(system, conf);
+  SBMLSystemJacobi systemJacobi(system, conf.getJacobianMethod());
   auto initialState = system.getInitialState();
   auto stepper = odeint::make_dense_output(conf.getAbsoluteTolerance(), conf.getRelativeTolerance(),
                                            odeint::rosenbrock4<double>());
-  auto implicitSystem = std::make_pair(system, systemJacobi);
-  StdoutCsvObserver observer(system.createOutputTargetsFromOutputFields(conf.getOutputFields()));
+  ImplicitSystem implicitSystem(system, systemJacobi);
+  StdoutCsvObserver observer(system.createOutputTargetsFromOutputFields(conf.getOutputFields()), system.getConstants());
 
   // print header
   observer.outputHeader();
 
   // integrate
-  integrate_const(stepper, implicitSystem, initialState, conf.getStart(), conf.getDuration(), conf.getStepInterval(),
-                  std::ref(observer));
+  sbmlsim::integrate_const(stepper, implicitSystem, initialState, conf.getStart(), conf.getDuration(),
+                           conf.getStepInterval(), std::ref(observer), getAssignmentRuleIndices(system));
+}
+
+void SBMLSim::simulateBDF(const ModelWrapper *model, const RunConfiguration &conf) {
+  SBMLSystem system(model);
+  prepareNativeModel(system, conf);
+  SBMLSystemJacobi systemJacobi(system, conf.getJacobianMethod());
+  auto initialState = system.getInitialState();
+  state dfdt(initialState.size());
+  BDFStepper stepper([&](const state &x, BDFStepper::matrix &J, double t) { systemJacobi(x, J, t, dfdt); },
+                     conf.getAbsoluteTolerance(), conf.getRelativeTolerance());
+  stepper.setAlgebraicComponents(getAssignmentRuleIndices(system));
+  StdoutCsvObserver observer(system.createOutputTargetsFromOutputFields(conf.getOutputFields()), system.getConstants());
+
+  // print header
+  observer.outputHeader();
+
+  // integrate
+  sbmlsim::integrate_const(
+      stepper, system, initialState, conf.getStart(), conf.getDuration(), conf.getStepInterval(), std::ref(observer));
+}
+
+void SBMLSim::simulateAutoSwitching(const ModelWrapper *model, const RunConfiguration &conf) {
+  SBMLSystem system(model);
+  prepareNativeModel(system, conf);
+  SBMLSystemJacobi systemJacobi(system, conf.getJacobianMethod());
+  auto initialState = system.getInitialState();
+  state dfdt(initialState.size());
+  AutoSwitchingStepper stepper(
+      [&](const state &x, AutoSwitchingStepper::matrix &J, double t) { systemJacobi(x, J, t, dfdt); },
+      conf.getAbsoluteTolerance(), conf.getRelativeTolerance());
+  stepper.setAlgebraicComponents(getAssignmentRuleIndices(system));
+  StdoutCsvObserver observer(system.createOutputTargetsFromOutputFields(conf.getOutputFields()), system.getConstants());
+
+  // print header
+  observer.outputHeader();
+
+  // integrate
+  sbmlsim::integrate_const(
+      stepper, system, initialState, conf.getStart(), conf.getDuration(), conf.getStepInterval(), std::ref(observer));
+}
+
+void SBMLSim::simulateSSA(const ModelWrapper *model, const RunConfiguration &conf) {
+  SBMLSystem system(model);
+  SSASimulator simulator(system, conf.getSeed());
+  sampleStochastic(simulator, system, conf);
+}
+
+void SBMLSim::simulateNextReaction(const ModelWrapper *model, const RunConfiguration &conf) {
+  SBMLSystem system(model);
+  NextReactionSimulator simulator(system, conf.getSeed());
+  sampleStochastic(simulator, system, conf);
+}
+
+void SBMLSim::simulateTauLeaping(const ModelWrapper *model, const RunConfiguration &conf) {
+  SBMLSystem system(model);
+  TauLeapingSimulator simulator(system, conf.getSeed());
+  sampleStochastic(simulator, system, conf);
+}
+
+void SBMLSim::simulateHybrid(const ModelWrapper *model, const RunConfiguration &conf) {
+  SBMLSystem system(model);
+  HybridSimulator simulator(system, conf.getSeed(), conf.getAbsoluteTolerance(), conf.getRelativeTolerance());
+  sampleStochastic(simulator, system, conf);
+}
+
+void SBMLSim::simulateCLE(const ModelWrapper *model, const RunConfiguration &conf, CLEScheme scheme) {
+  SBMLSystem system(model);
+  CLESimulator simulator(system, conf.getSeed(), conf.getStepInterval() / CLE_STEPS_PER_INTERVAL, scheme);
+  sampleStochastic(simulator, system, conf);
+}
+
+/*
+ * Prints the mean of every output field followed by its variance, as var(id), from one integration of the
+ * linear noise approximation with dopri5. Models with events are rejected by LinearNoiseApproximation.
+ */
+void SBMLSim::simulateLNA(const ModelWrapper *model, const RunConfiguration &conf) {
+  SBMLSystem system(model);
+  LinearNoiseApproximation lna(system, conf.getJacobianMethod());
+  auto initialState = system.getInitialState();
+  system.handleInitialAssignment(initialState, conf.getStart());
+  system.handleAssignmentRule(initialState, conf.getStart());
+  auto y = lna.createInitialState(initialState);
+
+  auto means = system.createOutputTargetsFromOutputFields(conf.getOutputFields());
+  auto targets = means;
+  for (auto &target : means) {
+    if (!target.isConstant()) {
+      auto index = target.getStateIndex();
+      targets.push_back(ObserveTarget("var(" + target.getId() + ")", lna.getCovarianceIndex(index, index)));
+    }
+  }
+  StdoutCsvObserver observer(targets, system.getConstants());
+
+  // print header
+  observer.outputHeader();
+
+  // integrate
+  auto stepper = odeint::make_dense_output(conf.getAbsoluteTolerance(), conf.getRelativeTolerance(),
+                                           odeint::runge_kutta_dopri5<state>());
+  odeint::integrate_const(stepper, std::ref(lna), y, conf.getStart(), conf.getDuration(), conf.getStepInterval(),
+                          [&](const state &y, double t) {
+                            state x = y;
+                            system.handleAssignmentRule(x, t);
+                            observer(x, t);
+                          });
+}
+
+/*
+ * Solves f(x) = 0 from the initial state with the compiled RHS and the analytic Jacobian instead of running
+ * a long time course; the time-course fallback integrates for at most the configured duration. Assignment
+ * rules are applied before every evaluation of f and SBMLSystemJacobi differentiates through them, so the
+ * Newton matrix includes the chain rule through rule targets; events are not considered. The output fields
+ * at the steady state are returned with it rather than printed.
+ */
+SteadyState SBMLSim::findSteadyState(const ModelWrapper *model, const RunConfiguration &conf) {
+  SBMLSystem system(model);
+  prepareNativeModel(system, conf);
+  SBMLSystemJacobi systemJacobi(system, conf.getJacobianMethod());
+  auto initialState = system.getInitialState();
+  system.handleInitialAssignment(initialState, conf.getStart());
+  system.handleAssignmentRule(initialState, conf.getStart());
+
+  state y(initialState.size());
+  state dfdt(initialState.size());
+  auto rhs = [&](const state &x, state &dxdt, double t) {
+    y = x;
+    system.handleAssignmentRule(y, t);
+    system(y, dxdt, t);
+  };
+  auto jacobian = [&](const state &x, SteadyStateSolver::matrix &J, double t) {
+    y = x;
+    system.handleAssignmentRule(y, t);
+    systemJacobi(y, J, t, dfdt);
+  };
+  SteadyStateSolver solver(rhs, jacobian, conf.getAbsoluteTolerance(), conf.getRelativeTolerance(),
+                           conf.getDuration());
+  rhs(initialState, dfdt, conf.getStart());
+  solver.setStoichiometryMatrix(createDenseStoichiometryMatrix(system));
+  auto result = solver.solve(initialState, conf.getStart());
+  system.handleAssignmentRule(result.x, conf.getStart());
+
+  auto &constants = system.getConstants();
+  for (auto &target : system.createOutputTargetsFromOutputFields(conf.getOutputFields())) {
+    auto index = target.getStateIndex();
+    result.ids.push_back(target.getId());
+    result.values.push_back(target.isConstant() ? constants[index] : result.x[index]);
+  }
+  return result;
+}
+
+/*
+ * Runs numTrajectories trajectories with the stochastic method of conf (SSA for deterministic ones), trajectory
+ * i on stream i of the seed, and returns the mean and variance of every output field at the sample times.
+ */
+EnsembleStatistics SBMLSim::simulateEnsemble(const ModelWrapper *model, const RunConfiguration &conf,
+                                             unsigned long numTrajectories, unsigned int numThreads) {
+  SBMLSystem system(model);
+  auto targets = system.createOutputTargetsFromOutputFields(conf.getOutputFields());
+  StochasticEnsemble ensemble(system, targets, numThreads);
+  auto seed = conf.getSeed();
+  EnsembleStatistics statistics;
+  switch (conf.getIntegrationMethod()) {
+    case IntegrationMethod::NEXT_REACTION:
+      statistics = ensemble.run<NextReactionSimulator>(
+          numTrajectories, conf.getStart(), conf.getDuration(), conf.getStepInterval(),
+          [seed](SBMLSystem &system) { return NextReactionSimulator(system, seed); });
+      break;
+    case IntegrationMethod::TAU_LEAPING:
+      statistics = ensemble.run<TauLeapingSimulator>(
+          numTrajectories, conf.getStart(), conf.getDuration(), conf.getStepInterval(),
+          [seed](SBMLSystem &system) { return TauLeapingSimulator(system, seed); });
+      break;
+    case IntegrationMethod::HYBRID:
+      statistics = ensemble.run<HybridSimulator>(
+          numTrajectories, conf.getStart(), conf.getDuration(), conf.getStepInterval(),
+          [seed, &conf](SBMLSystem &system) {
+            return HybridSimulator(system, seed, conf.getAbsoluteTolerance(), conf.getRelativeTolerance());
+          });
+      break;
+    case IntegrationMethod::CLE_EULER_MARUYAMA:
+    case IntegrationMethod::CLE_MILSTEIN: {
+      auto stepSize = conf.getStepInterval() / CLE_STEPS_PER_INTERVAL;
+      auto scheme = conf.getIntegrationMethod() == IntegrationMethod::CLE_MILSTEIN ? CLEScheme::MILSTEIN
+                                                                                  : CLEScheme::EULER_MARUYAMA;
+      statistics = ensemble.run<CLESimulator>(
+          numTrajectories, conf.getStart(), conf.getDuration(), conf.getStepInterval(),
+          [seed, stepSize, scheme](SBMLSystem &system) { return CLESimulator(system, seed, stepSize, scheme); });
+      break;
+    }
+    case IntegrationMethod::SSA:
+    default:
+      statistics = ensemble.run<SSASimulator>(
+          numTrajectories, conf.getStart(), conf.getDuration(), conf.getStepInterval(),
+          [seed](SBMLSystem &system) { return SSASimulator(system, seed); });
+      break;
+  }
+  return statistics;
+}
+
+void SBMLSim::prepareNativeModel(SBMLSystem &system, const RunConfiguration &conf) {
+  if (conf.isJitEnabled()) {
+    // falls back to the interpreter when no compiler is available
+    system.setNativeModel(JITCompiler::compile(system));
+  }
 }
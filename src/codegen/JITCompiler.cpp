@@ -0,0 +1,132 @@
+#include "sbmlsim/internal/codegen/JITCompiler.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include "sbmlsim/internal/codegen/NativeCodeGenerator.h"
+#include "sbmlsim/internal/util/HashUtil.h"
+
+std::shared_ptr<NativeModel> JITCompiler::compile(SBMLSystem &system) {
+  return compile(NativeCodeGenerator::generate(system));
+}
+
+std::shared_ptr<NativeModel> JITCompiler::compile(const std::string &source) {
+  auto cacheDirectory = getCacheDirectory();
+  if (cacheDirectory.empty()) {
+    std::cerr << "sbmlsim: JIT disabled, no private cache directory" << std::endl;
+    return nullptr;
+  }
+
+  auto compiler = getCompiler();
+  auto command = compiler + " -O2 -shared -fPIC -w";
+  auto base = cacheDirectory + "/sbmlsim-" + HashUtil::sha256(command + "\n" + source);
+  auto library = base + ".so";
+
+  // cache hit
+  if (isTrustedFile(library)) {
+    auto nativeModel = NativeModel::load(library);
+    if (nativeModel) {
+      return nativeModel;
+    }
+  }
+
+  // write to per-process temporaries and rename at the end, so concurrent runs never load a partial object
+  auto pid = std::to_string(getpid());
+  auto sourcePath = base + "." + pid + ".cpp";
+  auto tmpLibrary = base + "." + pid + ".so";
+  {
+    std::ofstream ofs(sourcePath);
+    if (!ofs) {
+      std::cerr << "sbmlsim: JIT disabled, cannot write " << sourcePath << std::endl;
+      return nullptr;
+    }
+    ofs << source;
+  }
+
+  auto fullCommand = command + " -o '" + tmpLibrary + "' '" + sourcePath + "'";
+  auto status = std::system(fullCommand.c_str());
+  std::remove(sourcePath.c_str());
+  if (status != 0) {
+    std::cerr << "sbmlsim: JIT disabled, compilation failed: " << fullCommand << std::endl;
+    std::remove(tmpLibrary.c_str());
+    return nullptr;
+  }
+  // the compiler honours the umask; make sure the object passes isTrustedFile on the next run
+  if (chmod(tmpLibrary.c_str(), S_IRWXU) != 0 || std::rename(tmpLibrary.c_str(), library.c_str()) != 0) {
+    std::remove(tmpLibrary.c_str());
+    return nullptr;
+  }
+
+  std::shared_ptr<NativeModel> nativeModel;
+  if (isTrustedFile(library)) {
+    nativeModel = NativeModel::load(library);
+  }
+  if (!nativeModel) {
+    std::cerr << "sbmlsim: JIT disabled, cannot load " << library << std::endl;
+  }
+  return nativeModel;
+}
+
+std::string JITCompiler::getCompiler() {
+  const char *compiler = std::getenv("SBMLSIM_JIT_CXX");
+  if (compiler == nullptr || *compiler == '\0') {
+    compiler = std::getenv("CXX");
+  }
+  if (compiler == nullptr || *compiler == '\0') {
+    return "c++";
+  }
+  return compiler;
+}
+
+std::string JITCompiler::getCacheDirectory() {
+  const char *dir = std::getenv("SBMLSIM_JIT_CACHE_DIR");
+  if (dir != nullptr && *dir != '\0') {
+    return createPrivateDirectory(dir) ? dir : "";
+  }
+
+  std::string cache;
+  const char *xdgCache = std::getenv("XDG_CACHE_HOME");
+  const char *home = std::getenv("HOME");
+  if (xdgCache != nullptr && *xdgCache != '\0') {
+    cache = xdgCache;
+  } else if (home != nullptr && *home != '\0') {
+    cache = std::string(home) + "/.cache";
+  }
+  if (!cache.empty()) {
+    mkdir(cache.c_str(), S_IRWXU);
+    auto ret = cache + "/sbmlsim";
+    if (createPrivateDirectory(ret)) {
+      return ret;
+    }
+  }
+
+  // shared /tmp: a name per user, and refuse it if somebody else got there first
+  auto ret = "/tmp/sbmlsim-" + std::to_string(geteuid());
+  return createPrivateDirectory(ret) ? ret : "";
+}
+
+bool JITCompiler::createPrivateDirectory(const std::string &path) {
+  mkdir(path.c_str(), S_IRWXU);
+
+  struct stat st;
+  if (lstat(path.c_str(), &st) != 0) {
+    return false;
+  }
+  return S_ISDIR(st.st_mode) && st.st_uid == geteuid() && (st.st_mode & (S_IRWXG | S_IRWXO)) == 0;
+}
+
+bool JITCompiler::isTrustedFile(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  auto ret = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == geteuid()
+      && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+  close(fd);
+  return ret;
+}
@@ -0,0 +1,390 @@
+#include "sbmlsim/internal/codegen/NativeCodeGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <sstream>
+#include "sbmlsim/internal/util/RuntimeExceptionUtil.h"
+
+namespace {
+
+std::string slot(unsigned int index) {
+  return "s" + std::to_string(index);
+}
+
+const char *binaryOperator(OpCode opcode) {
+  switch (opcode) {
+    case OpCode::ADD:
+      return "+";
+    case OpCode::SUBTRACT:
+      return "-";
+    case OpCode::MULTIPLY:
+      return "*";
+    case OpCode::DIVIDE:
+      return "/";
+    case OpCode::LT:
+      return "<";
+    case OpCode::LEQ:
+      return "<=";
+    case OpCode::GT:
+      return ">";
+    case OpCode::GEQ:
+      return ">=";
+    case OpCode::EQ:
+      return "==";
+    case OpCode::NEQ:
+      return "!=";
+    default:
+      return nullptr;
+  }
+}
+
+const char *binaryFunction(OpCode opcode) {
+  switch (opcode) {
+    case OpCode::POWER:
+      return "std::pow";
+    case OpCode::ROOT:
+      return "sbmlsim_root";
+    case OpCode::LOG:
+      return "sbmlsim_log";
+    case OpCode::AND:
+      return "sbmlsim_and";
+    case OpCode::OR:
+      return "sbmlsim_or";
+    case OpCode::XOR:
+      return "sbmlsim_xor";
+    default:
+      return nullptr;
+  }
+}
+
+const char *unaryFunction(OpCode opcode) {
+  switch (opcode) {
+    case OpCode::NEGATE:
+      return "-";
+    case OpCode::ABS:
+      return "std::fabs";
+    case OpCode::EXP:
+      return "std::exp";
+    case OpCode::LN:
+      return "std::log";
+    case OpCode::LOG10:
+      return "std::log10";
+    case OpCode::CEILING:
+      return "std::ceil";
+    case OpCode::FLOOR:
+      return "std::floor";
+    case OpCode::FACTORIAL:
+      return "sbmlsim_factorial";
+    case OpCode::SIN:
+      return "std::sin";
+    case OpCode::COS:
+      return "std::cos";
+    case OpCode::TAN:
+      return "std::tan";
+    case OpCode::SEC:
+      return "1.0 / std::cos";
+    case OpCode::CSC:
+      return "1.0 / std::sin";
+    case OpCode::COT:
+      return "1.0 / std::tan";
+    case OpCode::SINH:
+      return "std::sinh";
+    case OpCode::COSH:
+      return "std::cosh";
+    case OpCode::TANH:
+      return "std::tanh";
+    case OpCode::SECH:
+      return "1.0 / std::cosh";
+    case OpCode::CSCH:
+      return "1.0 / std::sinh";
+    case OpCode::COTH:
+      return "1.0 / std::tanh";
+    case OpCode::ARCSIN:
+      return "std::asin";
+    case OpCode::ARCCOS:
+      return "std::acos";
+    case OpCode::ARCTAN:
+      return "std::atan";
+    case OpCode::ARCSEC:
+      return "sbmlsim_arcsec";
+    case OpCode::ARCCSC:
+      return "sbmlsim_arccsc";
+    case OpCode::ARCCOT:
+      return "sbmlsim_arccot";
+    case OpCode::ARCSINH:
+      return "std::asinh";
+    case OpCode::ARCCOSH:
+      return "std::acosh";
+    case OpCode::ARCTANH:
+      return "std::atanh";
+    case OpCode::ARCSECH:
+      return "sbmlsim_arcsech";
+    case OpCode::ARCCSCH:
+      return "sbmlsim_arccsch";
+    case OpCode::ARCCOTH:
+      return "sbmlsim_arccoth";
+    case OpCode::NOT:
+      return "sbmlsim_not";
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+std::string NativeCodeGenerator::generate(SBMLSystem &system) {
+  std::ostringstream os;
+  generatePrelude(os);
+  generateConstants(os, system.getConstants(), "k", "static const");
+  generateRhs(os, system);
+  generateAssignmentRules(os, system);
+  generateTriggers(os, system);
+  return os.str();
+}
+
+void NativeCodeGenerator::generatePrelude(std::ostream &os) {
+  os << "// generated by libsbmlsim\n"
+     << "#include <cmath>\n"
+     << "#include <limits>\n"
+     << "\n"
+     << "namespace {\n";
+  generateHelpers(os);
+  os << "}  // namespace\n"
+     << "\n";
+}
+
+void NativeCodeGenerator::generateHelpers(std::ostream &os) {
+  os << "inline double sbmlsim_root(double n, double x) { return std::pow(x, 1.0 / n); }\n"
+     << "inline double sbmlsim_log(double base, double x) { return std::log(x) / std::log(base); }\n"
+     << "inline double sbmlsim_and(double a, double b) { return (a != 0.0) && (b != 0.0); }\n"
+     << "inline double sbmlsim_or(double a, double b) { return (a != 0.0) || (b != 0.0); }\n"
+     << "inline double sbmlsim_xor(double a, double b) { return (a != 0.0) != (b != 0.0); }\n"
+     << "inline double sbmlsim_not(double a) { return a == 0.0; }\n"
+     << "inline double sbmlsim_arcsec(double a) { return std::acos(1.0 / a); }\n"
+     << "inline double sbmlsim_arccsc(double a) { return std::asin(1.0 / a); }\n"
+     << "inline double sbmlsim_arccot(double a) { return std::atan(1.0 / a); }\n"
+     << "inline double sbmlsim_arcsech(double a) { return std::acosh(1.0 / a); }\n"
+     << "inline double sbmlsim_arccsch(double a) { return std::asinh(1.0 / a); }\n"
+     << "inline double sbmlsim_arccoth(double a) { return std::atanh(1.0 / a); }\n"
+     << "inline double sbmlsim_factorial(double a) {\n"
+     << "  double ret = 1.0;\n"
+     << "  for (unsigned long long i = 2; i <= static_cast<unsigned long long>(a); i++) {\n"
+     << "    ret *= static_cast<double>(i);\n"
+     << "  }\n"
+     << "  return ret;\n"
+     << "}\n";
+}
+
+std::string NativeCodeGenerator::literal(double value) {
+  if (std::isnan(value)) {
+    return "std::numeric_limits<double>::quiet_NaN()";
+  } else if (std::isinf(value)) {
+    return value > 0 ? "std::numeric_limits<double>::infinity()" : "-std::numeric_limits<double>::infinity()";
+  }
+  std::ostringstream ss;
+  ss.precision(std::numeric_limits<double>::max_digits10);
+  ss << value;
+  return ss.str();
+}
+
+void NativeCodeGenerator::generateConstants(std::ostream &os, const std::vector<double> &constants,
+                                            const std::string &name, const std::string &qualifier) {
+  os << qualifier << " double " << name << "[" << std::max<size_t>(constants.size(), 1) << "] = {";
+  for (auto i = 0; i < constants.size(); i++) {
+    os << (i == 0 ? "" : ", ") << literal(constants[i]);
+  }
+  os << "};\n\n";
+}
+
+/*
+ * Translates the instruction stream one to one: every stack position becomes a local variable and jumps
+ * become gotos, so the generated code has exactly the semantics of CompiledExpression::evaluate.
+ */
+void NativeCodeGenerator::generateExpression(std::ostream &os, const CompiledExpression &expression,
+                                             const std::string &result, const std::string &label,
+                                             const std::string &indent, const std::string &constants) {
+  auto &instructions = expression.getInstructions();
+  auto size = instructions.size();
+
+  // stack depth at every jump target (all jumps are forward jumps)
+  std::map<unsigned int, unsigned int> targetDepths;
+
+  os << indent << "{\n";
+  os << indent << "  double";
+  for (auto i = 0; i < expression.getStackSize(); i++) {
+    os << (i == 0 ? " " : ", ") << slot(i);
+  }
+  os << ";\n";
+
+  unsigned int depth = 0;
+  for (unsigned int pc = 0; pc <= size; pc++) {
+    auto target = targetDepths.find(pc);
+    if (target != targetDepths.end()) {
+      depth = target->second;
+      os << indent << label << "_" << pc << ":\n";
+    }
+    if (pc == size) {
+      break;
+    }
+
+    auto &inst = instructions[pc];
+    os << indent << "  ";
+    switch (inst.opcode) {
+      case OpCode::PUSH_CONSTANT:
+        os << slot(depth++) << " = " << literal(inst.value) << ";\n";
+        break;
+      case OpCode::LOAD_VARIABLE:
+        os << slot(depth++) << " = x[" << inst.operand << "];\n";
+        break;
+      case OpCode::LOAD_CONCENTRATION:
+        os << slot(depth++) << " = x[" << inst.operand << "] / x[" << inst.compartmentIndex << "];\n";
+        break;
+      case OpCode::LOAD_CONSTANT:
+        os << slot(depth++) << " = " << constants << "[" << inst.operand << "];\n";
+        break;
+      case OpCode::LOAD_CONCENTRATION_CONSTANT_SIZE:
+        os << slot(depth++) << " = x[" << inst.operand << "] / " << constants << "[" << inst.compartmentIndex
+           << "];\n";
+        break;
+      case OpCode::LOAD_TIME:
+        os << slot(depth++) << " = t;\n";
+        break;
+      case OpCode::JUMP:
+        targetDepths[inst.operand] = depth;
+        os << "goto " << label << "_" << inst.operand << ";\n";
+        break;
+      case OpCode::JUMP_IF_FALSE:
+        depth--;
+        targetDepths[inst.operand] = depth;
+        os << "if (" << slot(depth) << " == 0.0) goto " << label << "_" << inst.operand << ";\n";
+        break;
+      default:
+        if (binaryOperator(inst.opcode) != nullptr) {
+          depth--;
+          os << slot(depth - 1) << " = static_cast<double>(" << slot(depth - 1) << " "
+             << binaryOperator(inst.opcode) << " " << slot(depth) << ");\n";
+        } else if (binaryFunction(inst.opcode) != nullptr) {
+          depth--;
+          os << slot(depth - 1) << " = " << binaryFunction(inst.opcode) << "(" << slot(depth - 1) << ", "
+             << slot(depth) << ");\n";
+        } else if (unaryFunction(inst.opcode) != nullptr) {
+          os << slot(depth - 1) << " = " << unaryFunction(inst.opcode) << "(" << slot(depth - 1) << ");\n";
+        } else {
+          RuntimeExceptionUtil::throwInvalidFlowException();
+        }
+        break;
+    }
+  }
+  os << indent << "  " << result << " = " << slot(0) << ";\n";
+  os << indent << "}\n";
+}
+
+void NativeCodeGenerator::generateAssignment(std::ostream &os, const Symbol &symbol, const std::string &value,
+                                             const std::string &indent, const std::string &constants) {
+  switch (symbol.type) {
+    case SymbolType::CONSTANT_SIZE_CONCENTRATION:
+      os << indent << "x[" << symbol.index << "] = " << value << " * " << constants << "[" << symbol.compartmentIndex
+         << "];\n";
+      break;
+    case SymbolType::CONSTANT:
+      RuntimeExceptionUtil::throwInvalidFlowException();
+      break;
+    case SymbolType::CONCENTRATION:
+      os << indent << "x[" << symbol.index << "] = " << value << " * x[" << symbol.compartmentIndex << "];\n";
+      break;
+    case SymbolType::VARIABLE:
+      os << indent << "x[" << symbol.index << "] = " << value << ";\n";
+      break;
+  }
+}
+
+void NativeCodeGenerator::generateRhs(std::ostream &os, SBMLSystem &system) {
+  auto model = system.getModel();
+  auto &reactions = model->getReactions();
+  auto &kineticLaws = system.getKineticLaws();
+  auto &reactantStoichiometries = system.getReactantStoichiometries();
+  auto &productStoichiometries = system.getProductStoichiometries();
+
+  os << "extern \"C\" void sbmlsim_rhs(const double *x, double *dxdt, double t) {\n";
+  os << "  double v, stoichiometry;\n";
+  os << "  for (unsigned int i = 0; i < " << system.getInitialState().size() << "; i++) {\n";
+  os << "    dxdt[i] = 0.0;\n";
+  os << "  }\n";
+
+  for (auto i = 0; i < reactions.size(); i++) {
+    os << "  // reaction: " << reactions[i].getId() << "\n";
+    generateExpression(os, kineticLaws[i], "v", "r" + std::to_string(i), "  ");
+
+    auto &reactants = reactions[i].getReactants();
+    for (auto j = 0; j < reactants.size(); j++) {
+      auto index = system.getStateIndexForVariable(reactants[j].getSpeciesId());
+      if (reactants[j].hasStoichiometryMath()) {
+        generateExpression(os, reactantStoichiometries[i][j], "stoichiometry",
+                           "r" + std::to_string(i) + "_reactant" + std::to_string(j), "  ");
+        os << "  dxdt[" << index << "] -= v * stoichiometry;\n";
+      } else {
+        os << "  dxdt[" << index << "] -= v * " << literal(reactants[j].getStoichiometry()) << ";\n";
+      }
+    }
+
+    auto &products = reactions[i].getProducts();
+    for (auto j = 0; j < products.size(); j++) {
+      auto index = system.getStateIndexForVariable(products[j].getSpeciesId());
+      if (products[j].hasStoichiometryMath()) {
+        generateExpression(os, productStoichiometries[i][j], "stoichiometry",
+                           "r" + std::to_string(i) + "_product" + std::to_string(j), "  ");
+        os << "  dxdt[" << index << "] += v * stoichiometry;\n";
+      } else {
+        os << "  dxdt[" << index << "] += v * " << literal(products[j].getStoichiometry()) << ";\n";
+      }
+    }
+  }
+
+  auto &rateRules = model->getRateRules();
+  for (auto i = 0; i < rateRules.size(); i++) {
+    auto index = system.getStateIndexForVariable(rateRules[i]->getVariable());
+    os << "  // rate rule: " << rateRules[i]->getVariable() << "\n";
+    generateExpression(os, system.getRateRules()[i], "dxdt[" + std::to_string(index) + "]",
+                       "rr" + std::to_string(i), "  ");
+  }
+
+  for (auto &species : model->getSpecieses()) {
+    if (species.hasBoundaryCondition() || species.isConstant()) {
+      os << "  dxdt[" << system.getStateIndexForVariable(species.getId()) << "] = 0.0;\n";
+    }
+  }
+
+  os << "}\n\n";
+}
+
+void NativeCodeGenerator::generateAssignmentRules(std::ostream &os, SBMLSystem &system) {
+  auto &assignmentRules = system.getAssignmentRules();
+  auto &targets = system.getAssignmentRuleTargets();
+
+  os << "extern \"C\" void sbmlsim_assignment_rules(double *x, double t) {\n";
+  os << "  double value;\n";
+  for (auto i = 0; i < assignmentRules.size(); i++) {
+    generateExpression(os, assignmentRules[i], "value", "ar" + std::to_string(i), "  ");
+    generateAssignment(os, targets[i], "value", "  ");
+  }
+  os << "}\n\n";
+}
+
+void NativeCodeGenerator::generateTriggers(std::ostream &os, SBMLSystem &system) {
+  auto &triggers = system.getEventTriggers();
+
+  os << "extern \"C\" double sbmlsim_trigger(unsigned int event, const double *x, double t) {\n";
+  os << "  double value = 0.0;\n";
+  os << "  switch (event) {\n";
+  for (auto i = 0; i < triggers.size(); i++) {
+    os << "    case " << i << ":\n";
+    generateExpression(os, triggers[i], "value", "ev" + std::to_string(i), "      ");
+    os << "      break;\n";
+  }
+  os << "    default:\n";
+  os << "      break;\n";
+  os << "  }\n";
+  os << "  return value;\n";
+  os << "}\n";
+}
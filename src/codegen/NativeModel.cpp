@@ -0,0 +1,43 @@
+#include "sbmlsim/internal/codegen/NativeModel.h"
+#include <dlfcn.h>
+
+std::shared_ptr<NativeModel> NativeModel::load(const std::string &path) {
+  void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) {
+    return std::shared_ptr<NativeModel>();
+  }
+
+  auto rhsFunction = reinterpret_cast<RhsFunction>(dlsym(handle, "sbmlsim_rhs"));
+  auto assignmentRuleFunction = reinterpret_cast<AssignmentRuleFunction>(dlsym(handle, "sbmlsim_assignment_rules"));
+  auto triggerFunction = reinterpret_cast<TriggerFunction>(dlsym(handle, "sbmlsim_trigger"));
+  if (rhsFunction == nullptr || assignmentRuleFunction == nullptr || triggerFunction == nullptr) {
+    dlclose(handle);
+    return std::shared_ptr<NativeModel>();
+  }
+
+  return std::shared_ptr<NativeModel>(
+      new NativeModel(handle, rhsFunction, assignmentRuleFunction, triggerFunction));
+}
+
+NativeModel::NativeModel(void *handle, RhsFunction rhsFunction, AssignmentRuleFunction assignmentRuleFunction,
+                         TriggerFunction triggerFunction)
+    : handle(handle), rhsFunction(rhsFunction), assignmentRuleFunction(assignmentRuleFunction),
+      triggerFunction(triggerFunction) {
+  // nothing to do
+}
+
+NativeModel::~NativeModel() {
+  dlclose(this->handle);
+}
+
+void NativeModel::rhs(const double *x, double *dxdt, double t) const {
+  this->rhsFunction(x, dxdt, t);
+}
+
+void NativeModel::assignmentRules(double *x, double t) const {
+  this->assignmentRuleFunction(x, t);
+}
+
+double NativeModel::trigger(unsigned int event, const double *x, double t) const {
+  return this->triggerFunction(event, x, t);
+}
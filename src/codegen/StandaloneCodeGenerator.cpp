@@ -0,0 +1,511 @@
+#include "sbmlsim/internal/codegen/StandaloneCodeGenerator.h"
+#include <algorithm>
+#include "sbmlsim/internal/codegen/NativeCodeGenerator.h"
+#include "sbmlsim/internal/compiler/ExpressionCompiler.h"
+#include "sbmlsim/internal/util/RuntimeExceptionUtil.h"
+
+namespace {
+
+const char *CONSTANTS = "kConstants";
+
+bool isFixedSpecies(const SpeciesWrapper &species) {
+  return species.hasBoundaryCondition() || species.isConstant();
+}
+
+void generateExpression(std::ostream &os, const CompiledExpression &expression, const std::string &result,
+                        const std::string &label, const std::string &indent) {
+  NativeCodeGenerator::generateExpression(os, expression, result, label, indent, CONSTANTS);
+}
+
+void generateAssignment(std::ostream &os, const Symbol &symbol, const std::string &value,
+                        const std::string &indent) {
+  NativeCodeGenerator::generateAssignment(os, symbol, value, indent, CONSTANTS);
+}
+
+}  // namespace
+
+void StandaloneCodeGenerator::generateHeader(std::ostream &os, SBMLSystem &system, const std::string &name,
+                                             const std::string &ns) {
+  auto stateIds = getStateIds(system);
+  auto initialState = system.getInitialState();
+  auto matrix = getStoichiometryMatrix(system);
+  auto numReactions = matrix.size();
+  auto &events = system.getModel()->getEvents();
+  auto numEvents = events.size();
+  std::size_t numEventValues = 0;
+  for (auto event : events) {
+    if (event->hasDelay()) {
+      RuntimeExceptionUtil::throwUnsupportedFeatureException("delayed events in a generated model");
+    }
+    numEventValues += event->getEventAssignments().size();
+  }
+
+  std::string guard = "SBMLSIM_MODEL_" + ns + "_H_";
+  std::transform(guard.begin(), guard.end(), guard.begin(), ::toupper);
+
+  os << "// generated by sbmlsim-model-compiler: " << name << "\n"
+     << "#ifndef " << guard << "\n"
+     << "#define " << guard << "\n"
+     << "\n"
+     << "#include <array>\n"
+     << "#include <cmath>\n"
+     << "#include <cstddef>\n"
+     << "#include <limits>\n"
+     << "#include <ostream>\n"
+     << "\n"
+     << "namespace " << ns << " {\n"
+     << "\n";
+
+  NativeCodeGenerator::generateHelpers(os);
+  os << "\n";
+
+  // constants
+  os << "constexpr std::size_t kNumStates = " << stateIds.size() << ";\n"
+     << "constexpr std::size_t kNumReactions = " << numReactions << ";\n"
+     << "constexpr std::size_t kNumEvents = " << numEvents << ";\n"
+     << "\n";
+
+  os << "constexpr const char *kStateIds[kNumStates] = {\n";
+  for (auto &id : stateIds) {
+    os << "  \"" << id << "\",\n";
+  }
+  os << "};\n\n";
+
+  os << "constexpr double kInitialState[kNumStates] = {\n";
+  for (auto i = 0; i < initialState.size(); i++) {
+    os << "  " << NativeCodeGenerator::literal(initialState[i]) << ",\n";
+  }
+  os << "};\n\n";
+
+  os << "constexpr bool kInitialValue[kNumEvents > 0 ? kNumEvents : 1] = {";
+  for (auto i = 0; i < numEvents; i++) {
+    os << (i == 0 ? "" : ", ") << (events[i]->getInitialValue() ? "true" : "false");
+  }
+  os << "};\n"
+     << "constexpr bool kPersistent[kNumEvents > 0 ? kNumEvents : 1] = {";
+  for (auto i = 0; i < numEvents; i++) {
+    os << (i == 0 ? "" : ", ") << (events[i]->isPersistent() ? "true" : "false");
+  }
+  os << "};\n"
+     << "constexpr std::size_t kNumEventValues = " << numEventValues << ";\n"
+     << "\n";
+
+  // parameters and compartments that never change
+  NativeCodeGenerator::generateConstants(os, system.getConstants(), CONSTANTS, "constexpr");
+
+  // rows are reactions; entries with stoichiometryMath, fixed species and rate rule targets are 0
+  os << "constexpr double kStoichiometry[kNumReactions > 0 ? kNumReactions : 1][kNumStates] = {\n";
+  for (auto &row : matrix) {
+    os << "  {";
+    for (auto j = 0; j < row.size(); j++) {
+      os << (j == 0 ? "" : ", ") << NativeCodeGenerator::literal(row[j]);
+    }
+    os << "},\n";
+  }
+  os << "};\n\n";
+
+  // model class
+  os << "class Model {\n"
+     << " public:\n"
+     << "  using state = std::array<double, kNumStates>;\n"
+     << "\n"
+     << "  Model() : triggerState(), due(), dueSequence(), nextSequence(0), eventValues() {\n"
+     << "    for (std::size_t i = 0; i < kNumEvents; i++) {\n"
+     << "      triggerState[i] = kInitialValue[i];\n"
+     << "    }\n"
+     << "  }\n"
+     << "\n"
+     << "  static state getInitialState() {\n"
+     << "    state x;\n"
+     << "    for (std::size_t i = 0; i < kNumStates; i++) {\n"
+     << "      x[i] = kInitialState[i];\n"
+     << "    }\n"
+     << "    return x;\n"
+     << "  }\n"
+     << "\n";
+  generateRhs(os, system);
+  os << "\n";
+  generateInitialAssignments(os, system);
+  os << "\n";
+  generateAssignmentRules(os, system);
+  os << "\n";
+  generateEvents(os, system);
+  os << "\n"
+     << " private:\n";
+  generateEventHelpers(os, system);
+  os << "\n"
+     << "  std::array<bool, (kNumEvents > 0 ? kNumEvents : 1)> triggerState;\n"
+     << "  std::array<bool, (kNumEvents > 0 ? kNumEvents : 1)> due;  // triggered and not executed yet\n"
+     << "  std::array<std::size_t, (kNumEvents > 0 ? kNumEvents : 1)> dueSequence;\n"
+     << "  std::size_t nextSequence;\n"
+     << "  std::array<double, (kNumEventValues > 0 ? kNumEventValues : 1)> eventValues;  // at trigger time\n"
+     << "};\n"
+     << "\n"
+     << "// writes time and every state variable as CSV, in the format of libsbmlsim\n"
+     << "void simulate(double start, double duration, double dt, double absoluteTolerance,\n"
+     << "              double relativeTolerance, std::ostream &os);\n"
+     << "\n"
+     << "}  // namespace " << ns << "\n"
+     << "\n"
+     << "#endif  // " << guard << "\n";
+}
+
+void StandaloneCodeGenerator::generateSource(std::ostream &os, SBMLSystem &system, const std::string &name,
+                                             const std::string &ns) {
+  os << "// generated by sbmlsim-model-compiler: " << name << "\n"
+     << "#include \"" << name << ".h\"\n"
+     << "#include <functional>\n"
+     << "#include <iomanip>\n"
+     << "#include <vector>\n"
+     << "#include <boost/numeric/odeint.hpp>\n"
+     << "#include \"sbmlsim/internal/integrate/IntegrateConst.h\"\n"
+     << "\n"
+     << "namespace " << ns << " {\n"
+     << "\n"
+     << "namespace {\n"
+     << "\n"
+     << "class CsvObserver {\n"
+     << " public:\n"
+     << "  explicit CsvObserver(std::ostream &os) : os(os) {}\n"
+     << "  void operator()(const Model::state &x, double t) {\n"
+     << "    os << t << std::setprecision(15);\n"
+     << "    for (std::size_t i = 0; i < kNumStates; i++) {\n"
+     << "      os << \",\" << x[i];\n"
+     << "    }\n"
+     << "    os << std::endl;\n"
+     << "  }\n"
+     << " private:\n"
+     << "  std::ostream &os;\n"
+     << "};\n"
+     << "\n"
+     << "}  // namespace\n"
+     << "\n"
+     << "void simulate(double start, double duration, double dt, double absoluteTolerance,\n"
+     << "              double relativeTolerance, std::ostream &os) {\n"
+     << "  Model model;\n"
+     << "  auto stepper = boost::numeric::odeint::make_dense_output(\n"
+     << "      absoluteTolerance, relativeTolerance, boost::numeric::odeint::runge_kutta_dopri5<Model::state>());\n"
+     << "  auto x = Model::getInitialState();\n"
+     << "  CsvObserver observer(os);\n"
+     << "\n"
+     << "  os << \"time\";\n"
+     << "  for (std::size_t i = 0; i < kNumStates; i++) {\n"
+     << "    os << \",\" << kStateIds[i];\n"
+     << "  }\n"
+     << "  os << std::endl;\n"
+     << "\n"
+     << "  // targets of assignment rules, which do not restart the stepper when the rules change them\n"
+     << "  const std::vector<unsigned int> ruleTargets = {";
+  auto &ruleTargets = system.getAssignmentRuleTargets();
+  for (auto i = 0; i < ruleTargets.size(); i++) {
+    os << (i == 0 ? "" : ", ") << ruleTargets[i].index;
+  }
+  os << "};\n"
+     << "  sbmlsim::integrate_const(stepper, model, x, start, duration, dt, std::ref(observer), ruleTargets);\n"
+     << "}\n"
+     << "\n"
+     << "}  // namespace " << ns << "\n";
+}
+
+std::vector<std::string> StandaloneCodeGenerator::getStateIds(SBMLSystem &system) {
+  auto model = system.getModel();
+  std::vector<std::string> ret(system.getInitialState().size());
+  for (auto &species : model->getSpecieses()) {
+    ret[system.getStateIndexForVariable(species.getId())] = species.getId();
+  }
+  for (auto parameter : model->getParameters()) {
+    if (!system.isConstant(parameter->getId())) {
+      ret[system.getStateIndexForVariable(parameter->getId())] = parameter->getId();
+    }
+  }
+  for (auto &compartment : model->getCompartments()) {
+    if (!system.isConstant(compartment.getId())) {
+      ret[system.getStateIndexForVariable(compartment.getId())] = compartment.getId();
+    }
+  }
+  return ret;
+}
+
+std::vector<std::vector<double> > StandaloneCodeGenerator::getStoichiometryMatrix(SBMLSystem &system) {
+  auto model = system.getModel();
+  auto &reactions = model->getReactions();
+  auto numStates = system.getInitialState().size();
+
+  std::vector<bool> overridden(numStates, false);
+  for (auto rateRule : model->getRateRules()) {
+    overridden[system.getStateIndexForVariable(rateRule->getVariable())] = true;
+  }
+  for (auto &species : model->getSpecieses()) {
+    if (isFixedSpecies(species)) {
+      overridden[system.getStateIndexForVariable(species.getId())] = true;
+    }
+  }
+
+  std::vector<std::vector<double> > ret(reactions.size(), std::vector<double>(numStates, 0.0));
+  for (auto i = 0; i < reactions.size(); i++) {
+    for (auto &reactant : reactions[i].getReactants()) {
+      auto index = system.getStateIndexForVariable(reactant.getSpeciesId());
+      if (!reactant.hasStoichiometryMath() && !overridden[index]) {
+        ret[i][index] -= reactant.getStoichiometry();
+      }
+    }
+    for (auto &product : reactions[i].getProducts()) {
+      auto index = system.getStateIndexForVariable(product.getSpeciesId());
+      if (!product.hasStoichiometryMath() && !overridden[index]) {
+        ret[i][index] += product.getStoichiometry();
+      }
+    }
+  }
+  return ret;
+}
+
+void StandaloneCodeGenerator::generateRhs(std::ostream &os, SBMLSystem &system) {
+  auto model = system.getModel();
+  auto &reactions = model->getReactions();
+  auto &kineticLaws = system.getKineticLaws();
+  auto matrix = getStoichiometryMatrix(system);
+
+  std::vector<bool> fixed(system.getInitialState().size(), false);
+  for (auto &species : model->getSpecieses()) {
+    if (isFixedSpecies(species)) {
+      fixed[system.getStateIndexForVariable(species.getId())] = true;
+    }
+  }
+
+  os << "  void operator()(const state &x, state &dxdt, double t) const {\n"
+     << "    double v, stoichiometry;\n"
+     << "    dxdt.fill(0.0);\n";
+
+  for (auto i = 0; i < reactions.size(); i++) {
+    os << "    // reaction: " << reactions[i].getId() << "\n";
+    generateExpression(os, kineticLaws[i], "v", "r" + std::to_string(i), "    ");
+    for (auto j = 0; j < matrix[i].size(); j++) {
+      if (matrix[i][j] != 0.0) {
+        os << "    dxdt[" << j << "] += kStoichiometry[" << i << "][" << j << "] * v;\n";
+      }
+    }
+
+    // variable stoichiometry
+    auto &reactants = reactions[i].getReactants();
+    for (auto j = 0; j < reactants.size(); j++) {
+      auto index = system.getStateIndexForVariable(reactants[j].getSpeciesId());
+      if (reactants[j].hasStoichiometryMath() && !fixed[index]) {
+        generateExpression(os, system.getReactantStoichiometries()[i][j], "stoichiometry",
+                           "r" + std::to_string(i) + "_reactant" + std::to_string(j), "    ");
+        os << "    dxdt[" << index << "] -= v * stoichiometry;\n";
+      }
+    }
+    auto &products = reactions[i].getProducts();
+    for (auto j = 0; j < products.size(); j++) {
+      auto index = system.getStateIndexForVariable(products[j].getSpeciesId());
+      if (products[j].hasStoichiometryMath() && !fixed[index]) {
+        generateExpression(os, system.getProductStoichiometries()[i][j], "stoichiometry",
+                           "r" + std::to_string(i) + "_product" + std::to_string(j), "    ");
+        os << "    dxdt[" << index << "] += v * stoichiometry;\n";
+      }
+    }
+  }
+
+  auto &rateRules = model->getRateRules();
+  for (auto i = 0; i < rateRules.size(); i++) {
+    auto index = system.getStateIndexForVariable(rateRules[i]->getVariable());
+    if (fixed[index]) {
+      continue;
+    }
+    os << "    // rate rule: " << rateRules[i]->getVariable() << "\n";
+    generateExpression(os, system.getRateRules()[i], "dxdt[" + std::to_string(index) + "]",
+                       "rr" + std::to_string(i), "    ");
+  }
+
+  os << "  }\n";
+}
+
+void StandaloneCodeGenerator::generateInitialAssignments(std::ostream &os, SBMLSystem &system) {
+  auto model = system.getModel();
+  auto &symbolTable = system.getSymbolTable();
+
+  os << "  void handleInitialAssignment(state &x, double t) const {\n"
+     << "    double value;\n"
+     << "    if (t > 0) {\n"
+     << "      return;\n"
+     << "    }\n";
+  auto &initialAssignments = model->getInitialAssignments();
+  for (auto i = 0; i < initialAssignments.size(); i++) {
+    auto expression = ExpressionCompiler::compile(initialAssignments[i]->getMath(), symbolTable);
+    generateExpression(os, expression, "value", "ia" + std::to_string(i), "    ");
+    generateAssignment(os, symbolTable.get(initialAssignments[i]->getSymbol()), "value", "    ");
+  }
+  os << "  }\n";
+}
+
+void StandaloneCodeGenerator::generateAssignmentRules(std::ostream &os, SBMLSystem &system) {
+  auto &assignmentRules = system.getAssignmentRules();
+  auto &targets = system.getAssignmentRuleTargets();
+
+  os << "  void handleAssignmentRule(state &x, double t) const {\n"
+     << "    double value;\n";
+  for (auto i = 0; i < assignmentRules.size(); i++) {
+    generateExpression(os, assignmentRules[i], "value", "ar" + std::to_string(i), "    ");
+    generateAssignment(os, targets[i], "value", "    ");
+  }
+  os << "  }\n";
+}
+
+/*
+ * Same semantics as SBMLSystem::handleEvent for events without delay (generateHeader rejects delays):
+ * triggers start from their initialValue, due events execute highest priority first and earliest
+ * triggered among equal priorities, triggers are re-evaluated after every execution, and a non-persistent
+ * event whose trigger turns false before it executes is cancelled. Values are taken at the trigger time
+ * if useValuesFromTriggerTime is set, otherwise at execution, assignment by assignment.
+ */
+void StandaloneCodeGenerator::generateEvents(std::ostream &os, SBMLSystem &system) {
+  os << "  void handleEvent(state &x, double t) {\n"
+     << "    updateEventTriggers(x, t);\n"
+     << "    while (true) {\n"
+     << "      std::size_t selected = kNumEvents;\n"
+     << "      double selectedPriority = -std::numeric_limits<double>::infinity();\n"
+     << "      for (std::size_t i = 0; i < kNumEvents; i++) {\n"
+     << "        if (!due[i]) {\n"
+     << "          continue;\n"
+     << "        }\n"
+     << "        double priority = evaluateEventPriority(i, x, t);\n"
+     << "        if (selected == kNumEvents || priority > selectedPriority\n"
+     << "            || (priority == selectedPriority && dueSequence[i] < dueSequence[selected])) {\n"
+     << "          selected = i;\n"
+     << "          selectedPriority = priority;\n"
+     << "        }\n"
+     << "      }\n"
+     << "      if (selected == kNumEvents) {\n"
+     << "        break;\n"
+     << "      }\n"
+     << "      due[selected] = false;\n"
+     << "      executeEvent(selected, x, t);\n"
+     << "      updateEventTriggers(x, t);\n"
+     << "    }\n"
+     << "  }\n";
+
+  // continuous trigger functions, for locating events during stepping
+  auto &eventFunctions = system.getEventFunctions();
+  os << "\n"
+     << "  static constexpr std::size_t getNumEvents() {\n"
+     << "    return kNumEvents;\n"
+     << "  }\n"
+     << "\n"
+     << "  double evaluateEventFunction(std::size_t i, const state &x, double t) const {\n"
+     << "    double value = 0.0;\n"
+     << "    switch (i) {\n";
+  for (auto i = 0; i < eventFunctions.size(); i++) {
+    os << "    case " << i << ": {\n";
+    generateExpression(os, eventFunctions[i], "value", "g" + std::to_string(i), "      ");
+    os << "      break;\n"
+       << "    }\n";
+  }
+  os << "    default:\n"
+     << "      break;\n"
+     << "    }\n"
+     << "    return value;\n"
+     << "  }\n";
+}
+
+void StandaloneCodeGenerator::generateEventHelpers(std::ostream &os, SBMLSystem &system) {
+  auto &events = system.getModel()->getEvents();
+  auto &triggers = system.getEventTriggers();
+  auto &priorities = system.getEventPriorities();
+  auto &assignments = system.getEventAssignments();
+
+  std::vector<std::size_t> offsets;
+  std::size_t offset = 0;
+  for (auto event : events) {
+    offsets.push_back(offset);
+    offset += event->getEventAssignments().size();
+  }
+
+  os << "  void updateEventTriggers(const state &x, double t) {\n"
+     << "    double fire;\n";
+  for (auto i = 0; i < events.size(); i++) {
+    generateExpression(os, triggers[i], "fire", "ev" + std::to_string(i), "    ");
+    os << "    updateEventTrigger(" << i << ", fire != 0.0, x, t);\n";
+  }
+  os << "  }\n"
+     << "\n"
+     << "  void updateEventTrigger(std::size_t i, bool fire, const state &x, double t) {\n"
+     << "    if (fire && !triggerState[i]) {\n"
+     << "      triggerState[i] = true;\n"
+     << "      due[i] = true;\n"
+     << "      dueSequence[i] = nextSequence++;\n"
+     << "      saveEventValues(i, x, t);\n"
+     << "    } else if (!fire && triggerState[i]) {\n"
+     << "      triggerState[i] = false;\n"
+     << "      if (!kPersistent[i]) {\n"
+     << "        due[i] = false;\n"
+     << "      }\n"
+     << "    }\n"
+     << "  }\n"
+     << "\n";
+
+  os << "  double evaluateEventPriority(std::size_t i, const state &x, double t) const {\n"
+     << "    double value = -std::numeric_limits<double>::infinity();\n"
+     << "    switch (i) {\n";
+  for (auto i = 0; i < events.size(); i++) {
+    if (!events[i]->hasPriority()) {
+      continue;
+    }
+    os << "    case " << i << ": {\n";
+    generateExpression(os, priorities[i], "value", "pr" + std::to_string(i), "      ");
+    os << "      break;\n"
+       << "    }\n";
+  }
+  os << "    default:\n"
+     << "      break;\n"
+     << "    }\n"
+     << "    return value;\n"
+     << "  }\n"
+     << "\n";
+
+  os << "  void saveEventValues(std::size_t i, const state &x, double t) {\n"
+     << "    switch (i) {\n";
+  for (auto i = 0; i < events.size(); i++) {
+    if (!events[i]->getUseValuesFromTriggerTime() || events[i]->getEventAssignments().empty()) {
+      continue;
+    }
+    os << "    case " << i << ": {\n";
+    for (auto j = 0; j < assignments[i].size(); j++) {
+      generateExpression(os, assignments[i][j], "eventValues[" + std::to_string(offsets[i] + j) + "]",
+                         "sv" + std::to_string(i) + "_" + std::to_string(j), "      ");
+    }
+    os << "      break;\n"
+       << "    }\n";
+  }
+  os << "    default:\n"
+     << "      break;\n"
+     << "    }\n"
+     << "  }\n"
+     << "\n";
+
+  os << "  void executeEvent(std::size_t i, state &x, double t) {\n"
+     << "    double value;\n"
+     << "    switch (i) {\n";
+  for (auto i = 0; i < events.size(); i++) {
+    auto &eventAssignments = events[i]->getEventAssignments();
+    if (eventAssignments.empty()) {
+      continue;
+    }
+    os << "    case " << i << ": {\n";
+    for (auto j = 0; j < eventAssignments.size(); j++) {
+      auto index = system.getStateIndexForVariable(eventAssignments[j].getVariable());
+      if (events[i]->getUseValuesFromTriggerTime()) {
+        os << "      value = eventValues[" << offsets[i] + j << "];\n";
+      } else {
+        generateExpression(os, assignments[i][j], "value", "ex" + std::to_string(i) + "_" + std::to_string(j),
+                           "      ");
+      }
+      os << "      x[" << index << "] = value;\n";
+    }
+    os << "      break;\n"
+       << "    }\n";
+  }
+  os << "    default:\n"
+     << "      break;\n"
+     << "    }\n"
+     << "  }\n";
+}
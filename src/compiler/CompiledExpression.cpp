@@ -0,0 +1,558 @@
+#include "sbmlsim/internal/compiler/CompiledExpression.h"
+#include <cmath>
+#include "sbmlsim/internal/util/MathUtil.h"
+
+CompiledExpression::CompiledExpression() : stackSize(0) {
+  // nothing to do
+}
+
+CompiledExpression::CompiledExpression(const std::vector<Instruction> &instructions, unsigned int stackSize)
+    : instructions(instructions), stackSize(stackSize) {
+  // nothing to do
+}
+
+CompiledExpression::CompiledExpression(const CompiledExpression &expression)
+    : instructions(expression.instructions), stackSize(expression.stackSize) {
+  // nothing to do
+}
+
+CompiledExpression::~CompiledExpression() {
+  this->instructions.clear();
+}
+
+const std::vector<Instruction> &CompiledExpression::getInstructions() const {
+  return this->instructions;
+}
+
+unsigned int CompiledExpression::getStackSize() const {
+  return this->stackSize;
+}
+
+bool CompiledExpression::empty() const {
+  return this->instructions.empty();
+}
+
+/*
+ * Runs the instruction stream against the state x and the constants block k.
+ * The given stack must hold at least getStackSize() values.
+ */
+double CompiledExpression::evaluate(const double *x, const double *k, double t, double *stack) const {
+  const Instruction *code = this->instructions.data();
+  const unsigned int size = this->instructions.size();
+  double *top = stack - 1;
+
+  for (unsigned int pc = 0; pc < size; pc++) {
+    const Instruction &inst = code[pc];
+    switch (inst.opcode) {
+      case OpCode::PUSH_CONSTANT:
+        *++top = inst.value;
+        break;
+      case OpCode::LOAD_VARIABLE:
+        *++top = x[inst.operand];
+        break;
+      case OpCode::LOAD_CONCENTRATION:
+        *++top = x[inst.operand] / x[inst.compartmentIndex];
+        break;
+      case OpCode::LOAD_CONSTANT:
+        *++top = k[inst.operand];
+        break;
+      case OpCode::LOAD_CONCENTRATION_CONSTANT_SIZE:
+        *++top = x[inst.operand] / k[inst.compartmentIndex];
+        break;
+      case OpCode::LOAD_TIME:
+        *++top = t;
+        break;
+      case OpCode::ADD:
+        top--;
+        *top += top[1];
+        break;
+      case OpCode::SUBTRACT:
+        top--;
+        *top -= top[1];
+        break;
+      case OpCode::MULTIPLY:
+        top--;
+        *top *= top[1];
+        break;
+      case OpCode::DIVIDE:
+        top--;
+        *top /= top[1];
+        break;
+      case OpCode::POWER:
+        top--;
+        *top = MathUtil::pow(*top, top[1]);
+        break;
+      case OpCode::NEGATE:
+        *top = -*top;
+        break;
+      case OpCode::ROOT:  // root(degree, x)
+        top--;
+        *top = MathUtil::pow(top[1], 1.0 / *top);
+        break;
+      case OpCode::LOG:  // log(base, x)
+        top--;
+        *top = std::log(top[1]) / std::log(*top);
+        break;
+      case OpCode::ABS:
+        *top = std::fabs(*top);
+        break;
+      case OpCode::EXP:
+        *top = std::exp(*top);
+        break;
+      case OpCode::LN:
+        *top = std::log(*top);
+        break;
+      case OpCode::LOG10:
+        *top = std::log10(*top);
+        break;
+      case OpCode::CEILING:
+        *top = std::ceil(*top);
+        break;
+      case OpCode::FLOOR:
+        *top = std::floor(*top);
+        break;
+      case OpCode::FACTORIAL:
+        *top = MathUtil::factorial(static_cast<unsigned long long>(*top));
+        break;
+      case OpCode::SIN:
+        *top = std::sin(*top);
+        break;
+      case OpCode::COS:
+        *top = std::cos(*top);
+        break;
+      case OpCode::TAN:
+        *top = std::tan(*top);
+        break;
+      case OpCode::SEC:
+        *top = 1.0 / std::cos(*top);
+        break;
+      case OpCode::CSC:
+        *top = 1.0 / std::sin(*top);
+        break;
+      case OpCode::COT:
+        *top = 1.0 / std::tan(*top);
+        break;
+      case OpCode::SINH:
+        *top = std::sinh(*top);
+        break;
+      case OpCode::COSH:
+        *top = std::cosh(*top);
+        break;
+      case OpCode::TANH:
+        *top = std::tanh(*top);
+        break;
+      case OpCode::SECH:
+        *top = 1.0 / std::cosh(*top);
+        break;
+      case OpCode::CSCH:
+        *top = 1.0 / std::sinh(*top);
+        break;
+      case OpCode::COTH:
+        *top = 1.0 / std::tanh(*top);
+        break;
+      case OpCode::ARCSIN:
+        *top = std::asin(*top);
+        break;
+      case OpCode::ARCCOS:
+        *top = std::acos(*top);
+        break;
+      case OpCode::ARCTAN:
+        *top = std::atan(*top);
+        break;
+      case OpCode::ARCSEC:
+        *top = std::acos(1.0 / *top);
+        break;
+      case OpCode::ARCCSC:
+        *top = std::asin(1.0 / *top);
+        break;
+      case OpCode::ARCCOT:
+        *top = std::atan(1.0 / *top);
+        break;
+      case OpCode::ARCSINH:
+        *top = std::asinh(*top);
+        break;
+      case OpCode::ARCCOSH:
+        *top = std::acosh(*top);
+        break;
+      case OpCode::ARCTANH:
+        *top = std::atanh(*top);
+        break;
+      case OpCode::ARCSECH:
+        *top = std::acosh(1.0 / *top);
+        break;
+      case OpCode::ARCCSCH:
+        *top = std::asinh(1.0 / *top);
+        break;
+      case OpCode::ARCCOTH:
+        *top = std::atanh(1.0 / *top);
+        break;
+      case OpCode::LT:
+        top--;
+        *top = *top < top[1];
+        break;
+      case OpCode::LEQ:
+        top--;
+        *top = *top <= top[1];
+        break;
+      case OpCode::GT:
+        top--;
+        *top = *top > top[1];
+        break;
+      case OpCode::GEQ:
+        top--;
+        *top = *top >= top[1];
+        break;
+      case OpCode::EQ:
+        top--;
+        *top = *top == top[1];
+        break;
+      case OpCode::NEQ:
+        top--;
+        *top = *top != top[1];
+        break;
+      case OpCode::AND:
+        top--;
+        *top = (*top != 0.0) && (top[1] != 0.0);
+        break;
+      case OpCode::OR:
+        top--;
+        *top = (*top != 0.0) || (top[1] != 0.0);
+        break;
+      case OpCode::XOR:
+        top--;
+        *top = (*top != 0.0) != (top[1] != 0.0);
+        break;
+      case OpCode::NOT:
+        *top = *top == 0.0;
+        break;
+      case OpCode::JUMP:
+        pc = inst.operand - 1;
+        break;
+      case OpCode::JUMP_IF_FALSE:
+        if (*top-- == 0.0) {
+          pc = inst.operand - 1;
+        }
+        break;
+    }
+  }
+
+  return *top;
+}
+
+/*
+ * Forward-mode automatic differentiation: runs the instruction stream on dual numbers, carrying the tangent
+ * of every stack value in the parallel stack tangents. Returns the value of the expression and stores its
+ * derivative along seed in *tangent. Both stacks must hold at least getStackSize() values.
+ *
+ * ceiling, floor, factorial and the relational and logical operators are piecewise constant, so their
+ * tangent is 0; piecewise propagates the tangent of the selected piece.
+ */
+double CompiledExpression::evaluateTangent(const double *x, const double *k, double t, const TangentSeed &seed,
+                                           double *stack, double *tangents, double *tangent) const {
+  const Instruction *code = this->instructions.data();
+  const unsigned int size = this->instructions.size();
+  double *top = stack - 1;
+  double *dtop = tangents - 1;
+
+  for (unsigned int pc = 0; pc < size; pc++) {
+    const Instruction &inst = code[pc];
+    switch (inst.opcode) {
+      case OpCode::PUSH_CONSTANT:
+        *++top = inst.value;
+        *++dtop = 0.0;
+        break;
+      case OpCode::LOAD_VARIABLE:
+        *++top = x[inst.operand];
+        *++dtop = seed.x ? seed.x[inst.operand] : 0.0;
+        break;
+      case OpCode::LOAD_CONCENTRATION: {
+        double size = x[inst.compartmentIndex];
+        double dx = seed.x ? seed.x[inst.operand] : 0.0;
+        double dsize = seed.x ? seed.x[inst.compartmentIndex] : 0.0;
+        *++top = x[inst.operand] / size;
+        *++dtop = (dx - *top * dsize) / size;
+        break;
+      }
+      case OpCode::LOAD_CONSTANT:
+        *++top = k[inst.operand];
+        *++dtop = seed.k ? seed.k[inst.operand] : 0.0;
+        break;
+      case OpCode::LOAD_CONCENTRATION_CONSTANT_SIZE: {
+        double size = k[inst.compartmentIndex];
+        double dx = seed.x ? seed.x[inst.operand] : 0.0;
+        double dsize = seed.k ? seed.k[inst.compartmentIndex] : 0.0;
+        *++top = x[inst.operand] / size;
+        *++dtop = (dx - *top * dsize) / size;
+        break;
+      }
+      case OpCode::LOAD_TIME:
+        *++top = t;
+        *++dtop = seed.t;
+        break;
+      case OpCode::ADD:
+        top--;
+        dtop--;
+        *top += top[1];
+        *dtop += dtop[1];
+        break;
+      case OpCode::SUBTRACT:
+        top--;
+        dtop--;
+        *top -= top[1];
+        *dtop -= dtop[1];
+        break;
+      case OpCode::MULTIPLY:
+        top--;
+        dtop--;
+        *dtop = *dtop * top[1] + *top * dtop[1];
+        *top *= top[1];
+        break;
+      case OpCode::DIVIDE:
+        top--;
+        dtop--;
+        *top /= top[1];
+        *dtop = (*dtop - *top * dtop[1]) / top[1];
+        break;
+      case OpCode::POWER: {
+        top--;
+        dtop--;
+        double base = *top;
+        double exponent = top[1];
+        *top = MathUtil::pow(base, exponent);
+        if (dtop[1] == 0.0) {
+          // also valid for negative bases with integral exponents
+          *dtop = *dtop == 0.0 ? 0.0 : exponent * MathUtil::pow(base, exponent - 1.0) * *dtop;
+        } else {
+          *dtop = *top * (dtop[1] * std::log(base) + exponent * *dtop / base);
+        }
+        break;
+      }
+      case OpCode::NEGATE:
+        *top = -*top;
+        *dtop = -*dtop;
+        break;
+      case OpCode::ROOT: {  // root(degree, x)
+        top--;
+        dtop--;
+        double degree = *top;
+        double radicand = top[1];
+        *top = MathUtil::pow(radicand, 1.0 / degree);
+        if (*dtop == 0.0) {
+          *dtop = dtop[1] == 0.0 ? 0.0 : MathUtil::pow(radicand, 1.0 / degree - 1.0) * dtop[1] / degree;
+        } else {
+          *dtop = *top * (dtop[1] / (degree * radicand) - *dtop * std::log(radicand) / (degree * degree));
+        }
+        break;
+      }
+      case OpCode::LOG: {  // log(base, x)
+        top--;
+        dtop--;
+        double lnBase = std::log(*top);
+        double dlnBase = *dtop / *top;
+        *top = std::log(top[1]) / lnBase;
+        *dtop = (dtop[1] / top[1] - *top * dlnBase) / lnBase;
+        break;
+      }
+      case OpCode::ABS:
+        *dtop = *top > 0.0 ? *dtop : (*top < 0.0 ? -*dtop : 0.0);
+        *top = std::fabs(*top);
+        break;
+      case OpCode::EXP:
+        *top = std::exp(*top);
+        *dtop *= *top;
+        break;
+      case OpCode::LN:
+        *dtop /= *top;
+        *top = std::log(*top);
+        break;
+      case OpCode::LOG10:
+        *dtop /= *top * std::log(10.0);
+        *top = std::log10(*top);
+        break;
+      case OpCode::CEILING:
+        *top = std::ceil(*top);
+        *dtop = 0.0;
+        break;
+      case OpCode::FLOOR:
+        *top = std::floor(*top);
+        *dtop = 0.0;
+        break;
+      case OpCode::FACTORIAL:
+        *top = MathUtil::factorial(static_cast<unsigned long long>(*top));
+        *dtop = 0.0;
+        break;
+      case OpCode::SIN:
+        *dtop *= std::cos(*top);
+        *top = std::sin(*top);
+        break;
+      case OpCode::COS:
+        *dtop *= -std::sin(*top);
+        *top = std::cos(*top);
+        break;
+      case OpCode::TAN: {
+        double c = std::cos(*top);
+        *dtop /= c * c;
+        *top = std::tan(*top);
+        break;
+      }
+      case OpCode::SEC:
+        *dtop *= std::tan(*top) / std::cos(*top);
+        *top = 1.0 / std::cos(*top);
+        break;
+      case OpCode::CSC:
+        *dtop *= -1.0 / (std::tan(*top) * std::sin(*top));
+        *top = 1.0 / std::sin(*top);
+        break;
+      case OpCode::COT: {
+        double s = std::sin(*top);
+        *dtop /= -(s * s);
+        *top = 1.0 / std::tan(*top);
+        break;
+      }
+      case OpCode::SINH:
+        *dtop *= std::cosh(*top);
+        *top = std::sinh(*top);
+        break;
+      case OpCode::COSH:
+        *dtop *= std::sinh(*top);
+        *top = std::cosh(*top);
+        break;
+      case OpCode::TANH:
+        *top = std::tanh(*top);
+        *dtop *= 1.0 - *top * *top;
+        break;
+      case OpCode::SECH:
+        *dtop *= -std::tanh(*top) / std::cosh(*top);
+        *top = 1.0 / std::cosh(*top);
+        break;
+      case OpCode::CSCH:
+        *dtop *= -1.0 / (std::tanh(*top) * std::sinh(*top));
+        *top = 1.0 / std::sinh(*top);
+        break;
+      case OpCode::COTH: {
+        double s = std::sinh(*top);
+        *dtop /= -(s * s);
+        *top = 1.0 / std::tanh(*top);
+        break;
+      }
+      case OpCode::ARCSIN:
+        *dtop /= std::sqrt(1.0 - *top * *top);
+        *top = std::asin(*top);
+        break;
+      case OpCode::ARCCOS:
+        *dtop /= -std::sqrt(1.0 - *top * *top);
+        *top = std::acos(*top);
+        break;
+      case OpCode::ARCTAN:
+        *dtop /= 1.0 + *top * *top;
+        *top = std::atan(*top);
+        break;
+      case OpCode::ARCSEC:
+        *dtop /= *top * *top * std::sqrt(1.0 - 1.0 / (*top * *top));
+        *top = std::acos(1.0 / *top);
+        break;
+      case OpCode::ARCCSC:
+        *dtop /= -(*top * *top * std::sqrt(1.0 - 1.0 / (*top * *top)));
+        *top = std::asin(1.0 / *top);
+        break;
+      case OpCode::ARCCOT:
+        *dtop /= -(1.0 + *top * *top);
+        *top = std::atan(1.0 / *top);
+        break;
+      case OpCode::ARCSINH:
+        *dtop /= std::sqrt(*top * *top + 1.0);
+        *top = std::asinh(*top);
+        break;
+      case OpCode::ARCCOSH:
+        *dtop /= std::sqrt(*top * *top - 1.0);
+        *top = std::acosh(*top);
+        break;
+      case OpCode::ARCTANH:
+        *dtop /= 1.0 - *top * *top;
+        *top = std::atanh(*top);
+        break;
+      case OpCode::ARCSECH:
+        *dtop /= -(*top * *top * std::sqrt(1.0 / (*top * *top) - 1.0));
+        *top = std::acosh(1.0 / *top);
+        break;
+      case OpCode::ARCCSCH:
+        *dtop /= -(*top * *top * std::sqrt(1.0 / (*top * *top) + 1.0));
+        *top = std::asinh(1.0 / *top);
+        break;
+      case OpCode::ARCCOTH:
+        *dtop /= 1.0 - *top * *top;
+        *top = std::atanh(1.0 / *top);
+        break;
+      case OpCode::LT:
+        top--;
+        dtop--;
+        *top = *top < top[1];
+        *dtop = 0.0;
+        break;
+      case OpCode::LEQ:
+        top--;
+        dtop--;
+        *top = *top <= top[1];
+        *dtop = 0.0;
+        break;
+      case OpCode::GT:
+        top--;
+        dtop--;
+        *top = *top > top[1];
+        *dtop = 0.0;
+        break;
+      case OpCode::GEQ:
+        top--;
+        dtop--;
+        *top = *top >= top[1];
+        *dtop = 0.0;
+        break;
+      case OpCode::EQ:
+        top--;
+        dtop--;
+        *top = *top == top[1];
+        *dtop = 0.0;
+        break;
+      case OpCode::NEQ:
+        top--;
+        dtop--;
+        *top = *top != top[1];
+        *dtop = 0.0;
+        break;
+      case OpCode::AND:
+        top--;
+        dtop--;
+        *top = (*top != 0.0) && (top[1] != 0.0);
+        *dtop = 0.0;
+        break;
+      case OpCode::OR:
+        top--;
+        dtop--;
+        *top = (*top != 0.0) || (top[1] != 0.0);
+        *dtop = 0.0;
+        break;
+      case OpCode::XOR:
+        top--;
+        dtop--;
+        *top = (*top != 0.0) != (top[1] != 0.0);
+        *dtop = 0.0;
+        break;
+      case OpCode::NOT:
+        *top = *top == 0.0;
+        *dtop = 0.0;
+        break;
+      case OpCode::JUMP:
+        pc = inst.operand - 1;
+        break;
+      case OpCode::JUMP_IF_FALSE:
+        dtop--;
+        if (*top-- == 0.0) {
+          pc = inst.operand - 1;
+        }
+        break;
+    }
+  }
+
+  *tangent = *dtop;
+  return *top;
+}
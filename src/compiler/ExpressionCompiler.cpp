@@ -0,0 +1,392 @@
+#include "sbmlsim/internal/compiler/ExpressionCompiler.h"
+#include <algorithm>
+#include <cmath>
+#include "sbmlsim/internal/util/RuntimeExceptionUtil.h"
+
+#define AVOGADRO_CONSTANT 6.02214179e23
+
+namespace {
+
+int stackEffect(OpCode opcode) {
+  switch (opcode) {
+    case OpCode::PUSH_CONSTANT:
+    case OpCode::LOAD_VARIABLE:
+    case OpCode::LOAD_CONCENTRATION:
+    case OpCode::LOAD_CONSTANT:
+    case OpCode::LOAD_CONCENTRATION_CONSTANT_SIZE:
+    case OpCode::LOAD_TIME:
+      return 1;
+    case OpCode::ADD:
+    case OpCode::SUBTRACT:
+    case OpCode::MULTIPLY:
+    case OpCode::DIVIDE:
+    case OpCode::POWER:
+    case OpCode::ROOT:
+    case OpCode::LOG:
+    case OpCode::LT:
+    case OpCode::LEQ:
+    case OpCode::GT:
+    case OpCode::GEQ:
+    case OpCode::EQ:
+    case OpCode::NEQ:
+    case OpCode::AND:
+    case OpCode::OR:
+    case OpCode::XOR:
+    case OpCode::JUMP_IF_FALSE:
+      return -1;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+ExpressionCompiler::ExpressionCompiler(const SymbolTable &symbolTable)
+    : symbolTable(symbolTable), depth(0), maxDepth(0) {
+  // nothing to do
+}
+
+ExpressionCompiler::~ExpressionCompiler() {
+  this->instructions.clear();
+}
+
+CompiledExpression ExpressionCompiler::compile(const ASTNode *node, const SymbolTable &symbolTable) {
+  ExpressionCompiler compiler(symbolTable);
+  compiler.compileNode(node);
+  return CompiledExpression(compiler.instructions, compiler.maxDepth);
+}
+
+void ExpressionCompiler::compileNode(const ASTNode *node) {
+  auto type = node->getType();
+  switch (type) {
+    case AST_NAME:
+      emitName(node->getName());
+      break;
+    case AST_NAME_TIME:
+      emit(OpCode::LOAD_TIME);
+      break;
+    case AST_NAME_AVOGADRO:
+      emitConstant(AVOGADRO_CONSTANT);
+      break;
+    case AST_INTEGER:
+      emitConstant(node->getInteger());
+      break;
+    case AST_REAL:
+      emitConstant(node->getReal());
+      break;
+    case AST_RATIONAL:
+    case AST_REAL_E:
+      emitConstant(node->getValue());
+      break;
+    case AST_CONSTANT_E:
+      emitConstant(M_E);
+      break;
+    case AST_CONSTANT_PI:
+      emitConstant(M_PI);
+      break;
+    case AST_CONSTANT_TRUE:
+      emitConstant(1.0);
+      break;
+    case AST_CONSTANT_FALSE:
+      emitConstant(0.0);
+      break;
+    case AST_PLUS:
+      compileNaryNode(node, OpCode::ADD, 0.0);
+      break;
+    case AST_TIMES:
+      compileNaryNode(node, OpCode::MULTIPLY, 1.0);
+      break;
+    case AST_MINUS:
+      compileMinusNode(node);
+      break;
+    case AST_DIVIDE:
+      compileNode(node->getLeftChild());
+      compileNode(node->getRightChild());
+      emit(OpCode::DIVIDE);
+      break;
+    case AST_POWER:
+    case AST_FUNCTION_POWER:
+      compileNode(node->getLeftChild());
+      compileNode(node->getRightChild());
+      emit(OpCode::POWER);
+      break;
+    case AST_FUNCTION_ROOT:
+      compileRootNode(node);
+      break;
+    case AST_FUNCTION_LOG:
+      compileLogNode(node);
+      break;
+    case AST_FUNCTION_ABS:
+      compileFunctionNode(node, OpCode::ABS);
+      break;
+    case AST_FUNCTION_EXP:
+      compileFunctionNode(node, OpCode::EXP);
+      break;
+    case AST_FUNCTION_LN:
+      compileFunctionNode(node, OpCode::LN);
+      break;
+    case AST_FUNCTION_CEILING:
+      compileFunctionNode(node, OpCode::CEILING);
+      break;
+    case AST_FUNCTION_FLOOR:
+      compileFunctionNode(node, OpCode::FLOOR);
+      break;
+    case AST_FUNCTION_FACTORIAL:
+      compileFunctionNode(node, OpCode::FACTORIAL);
+      break;
+    case AST_FUNCTION_SIN:
+      compileFunctionNode(node, OpCode::SIN);
+      break;
+    case AST_FUNCTION_COS:
+      compileFunctionNode(node, OpCode::COS);
+      break;
+    case AST_FUNCTION_TAN:
+      compileFunctionNode(node, OpCode::TAN);
+      break;
+    case AST_FUNCTION_SEC:
+      compileFunctionNode(node, OpCode::SEC);
+      break;
+    case AST_FUNCTION_CSC:
+      compileFunctionNode(node, OpCode::CSC);
+      break;
+    case AST_FUNCTION_COT:
+      compileFunctionNode(node, OpCode::COT);
+      break;
+    case AST_FUNCTION_SINH:
+      compileFunctionNode(node, OpCode::SINH);
+      break;
+    case AST_FUNCTION_COSH:
+      compileFunctionNode(node, OpCode::COSH);
+      break;
+    case AST_FUNCTION_TANH:
+      compileFunctionNode(node, OpCode::TANH);
+      break;
+    case AST_FUNCTION_SECH:
+      compileFunctionNode(node, OpCode::SECH);
+      break;
+    case AST_FUNCTION_CSCH:
+      compileFunctionNode(node, OpCode::CSCH);
+      break;
+    case AST_FUNCTION_COTH:
+      compileFunctionNode(node, OpCode::COTH);
+      break;
+    case AST_FUNCTION_ARCSIN:
+      compileFunctionNode(node, OpCode::ARCSIN);
+      break;
+    case AST_FUNCTION_ARCCOS:
+      compileFunctionNode(node, OpCode::ARCCOS);
+      break;
+    case AST_FUNCTION_ARCTAN:
+      compileFunctionNode(node, OpCode::ARCTAN);
+      break;
+    case AST_FUNCTION_ARCSEC:
+      compileFunctionNode(node, OpCode::ARCSEC);
+      break;
+    case AST_FUNCTION_ARCCSC:
+      compileFunctionNode(node, OpCode::ARCCSC);
+      break;
+    case AST_FUNCTION_ARCCOT:
+      compileFunctionNode(node, OpCode::ARCCOT);
+      break;
+    case AST_FUNCTION_ARCSINH:
+      compileFunctionNode(node, OpCode::ARCSINH);
+      break;
+    case AST_FUNCTION_ARCCOSH:
+      compileFunctionNode(node, OpCode::ARCCOSH);
+      break;
+    case AST_FUNCTION_ARCTANH:
+      compileFunctionNode(node, OpCode::ARCTANH);
+      break;
+    case AST_FUNCTION_ARCSECH:
+      compileFunctionNode(node, OpCode::ARCSECH);
+      break;
+    case AST_FUNCTION_ARCCSCH:
+      compileFunctionNode(node, OpCode::ARCCSCH);
+      break;
+    case AST_FUNCTION_ARCCOTH:
+      compileFunctionNode(node, OpCode::ARCCOTH);
+      break;
+    case AST_FUNCTION_PIECEWISE:
+      compilePiecewiseNode(node);
+      break;
+    case AST_RELATIONAL_LT:
+      compileRelationalNode(node, OpCode::LT);
+      break;
+    case AST_RELATIONAL_LEQ:
+      compileRelationalNode(node, OpCode::LEQ);
+      break;
+    case AST_RELATIONAL_GT:
+      compileRelationalNode(node, OpCode::GT);
+      break;
+    case AST_RELATIONAL_GEQ:
+      compileRelationalNode(node, OpCode::GEQ);
+      break;
+    case AST_RELATIONAL_EQ:
+      compileRelationalNode(node, OpCode::EQ);
+      break;
+    case AST_RELATIONAL_NEQ:
+      compileRelationalNode(node, OpCode::NEQ);
+      break;
+    case AST_LOGICAL_AND:
+      compileNaryNode(node, OpCode::AND, 1.0);
+      break;
+    case AST_LOGICAL_OR:
+      compileNaryNode(node, OpCode::OR, 0.0);
+      break;
+    case AST_LOGICAL_XOR:
+      compileNaryNode(node, OpCode::XOR, 0.0);
+      break;
+    case AST_LOGICAL_NOT:
+      compileFunctionNode(node, OpCode::NOT);
+      break;
+    case AST_FUNCTION:
+      // function definitions must have been expanded by ASTNodeUtil::rewriteFunctionDefinition
+      RuntimeExceptionUtil::throwUnknownNodeNameException(node->getName());
+      break;
+    default:
+      RuntimeExceptionUtil::throwUnknownNodeTypeException(type);
+      break;
+  }
+}
+
+void ExpressionCompiler::compileNaryNode(const ASTNode *node, OpCode opcode, double identity) {
+  auto numChildren = node->getNumChildren();
+  if (numChildren == 0) {
+    emitConstant(identity);
+    return;
+  }
+
+  compileNode(node->getChild(0));
+  for (auto i = 1; i < numChildren; i++) {
+    compileNode(node->getChild(i));
+    emit(opcode);
+  }
+}
+
+void ExpressionCompiler::compileMinusNode(const ASTNode *node) {
+  compileNode(node->getChild(0));
+  if (node->getNumChildren() == 1) {
+    emit(OpCode::NEGATE);
+    return;
+  }
+
+  for (auto i = 1; i < node->getNumChildren(); i++) {
+    compileNode(node->getChild(i));
+    emit(OpCode::SUBTRACT);
+  }
+}
+
+void ExpressionCompiler::compileRelationalNode(const ASTNode *node, OpCode opcode) {
+  // a < b < c is evaluated as (a < b) && (b < c)
+  for (auto i = 0; i + 1 < node->getNumChildren(); i++) {
+    compileNode(node->getChild(i));
+    compileNode(node->getChild(i + 1));
+    emit(opcode);
+    if (i > 0) {
+      emit(OpCode::AND);
+    }
+  }
+}
+
+void ExpressionCompiler::compileFunctionNode(const ASTNode *node, OpCode opcode) {
+  compileNode(node->getLeftChild());
+  emit(opcode);
+}
+
+void ExpressionCompiler::compileRootNode(const ASTNode *node) {
+  if (node->getNumChildren() == 1) {
+    emitConstant(2.0);
+  } else {
+    compileNode(node->getLeftChild());
+  }
+  compileNode(node->getRightChild());
+  emit(OpCode::ROOT);
+}
+
+void ExpressionCompiler::compileLogNode(const ASTNode *node) {
+  if (node->getNumChildren() == 1) {
+    compileNode(node->getLeftChild());
+    emit(OpCode::LOG10);
+    return;
+  }
+
+  compileNode(node->getLeftChild());
+  compileNode(node->getRightChild());
+  emit(OpCode::LOG);
+}
+
+void ExpressionCompiler::compilePiecewiseNode(const ASTNode *node) {
+  //
+  //   piecewise(v0, c0, v1, c1, otherwise)
+  //
+  //       c0; JUMP_IF_FALSE L0; v0; JUMP END
+  //   L0: c1; JUMP_IF_FALSE L1; v1; JUMP END
+  //   L1: otherwise
+  //  END:
+  //
+  std::vector<unsigned int> jumpsToEnd;
+  auto numChildren = node->getNumChildren();
+  auto baseDepth = this->depth;
+
+  for (auto i = 0; i + 1 < numChildren; i += 2) {
+    compileNode(node->getChild(i + 1));
+    auto jumpToNext = emit(OpCode::JUMP_IF_FALSE);
+    compileNode(node->getChild(i));
+    jumpsToEnd.push_back(emit(OpCode::JUMP));
+    patchJump(jumpToNext);
+    this->depth = baseDepth;
+  }
+
+  if (numChildren % 2 == 1) {
+    compileNode(node->getChild(numChildren - 1));
+  } else {
+    emitConstant(0.0);
+  }
+
+  for (auto position : jumpsToEnd) {
+    patchJump(position);
+  }
+}
+
+unsigned int ExpressionCompiler::emit(OpCode opcode, unsigned int operand, double value) {
+  Instruction instruction;
+  instruction.opcode = opcode;
+  instruction.operand = operand;
+  instruction.value = value;
+  this->instructions.push_back(instruction);
+
+  this->depth += stackEffect(opcode);
+  this->maxDepth = std::max(this->maxDepth, this->depth);
+
+  return this->instructions.size() - 1;
+}
+
+void ExpressionCompiler::emitConstant(double value) {
+  emit(OpCode::PUSH_CONSTANT, 0, value);
+}
+
+void ExpressionCompiler::emitName(const std::string &name) {
+  auto &symbol = this->symbolTable.get(name);
+  switch (symbol.type) {
+    case SymbolType::VARIABLE:
+      emit(OpCode::LOAD_VARIABLE, symbol.index);
+      break;
+    case SymbolType::CONCENTRATION: {
+      auto position = emit(OpCode::LOAD_CONCENTRATION, symbol.index);
+      this->instructions[position].compartmentIndex = symbol.compartmentIndex;
+      break;
+    }
+    case SymbolType::CONSTANT:
+      emit(OpCode::LOAD_CONSTANT, symbol.index);
+      break;
+    case SymbolType::CONSTANT_SIZE_CONCENTRATION: {
+      auto position = emit(OpCode::LOAD_CONCENTRATION_CONSTANT_SIZE, symbol.index);
+      this->instructions[position].compartmentIndex = symbol.compartmentIndex;
+      break;
+    }
+  }
+}
+
+void ExpressionCompiler::patchJump(unsigned int position) {
+  this->instructions[position].operand = this->instructions.size();
+}
@@ -0,0 +1,59 @@
+#include "sbmlsim/internal/compiler/SymbolTable.h"
+#include "sbmlsim/internal/util/RuntimeExceptionUtil.h"
+
+SymbolTable::SymbolTable() {
+  // nothing to do
+}
+
+SymbolTable::SymbolTable(const SymbolTable &symbolTable) : symbols(symbolTable.symbols) {
+  // nothing to do
+}
+
+SymbolTable::~SymbolTable() {
+  this->symbols.clear();
+}
+
+void SymbolTable::addVariable(const std::string &id, unsigned int index) {
+  Symbol symbol;
+  symbol.type = SymbolType::VARIABLE;
+  symbol.index = index;
+  symbol.compartmentIndex = 0;
+  this->symbols[id] = symbol;
+}
+
+void SymbolTable::addConcentration(const std::string &id, unsigned int index, unsigned int compartmentIndex) {
+  Symbol symbol;
+  symbol.type = SymbolType::CONCENTRATION;
+  symbol.index = index;
+  symbol.compartmentIndex = compartmentIndex;
+  this->symbols[id] = symbol;
+}
+
+void SymbolTable::addConstant(const std::string &id, unsigned int index) {
+  Symbol symbol;
+  symbol.type = SymbolType::CONSTANT;
+  symbol.index = index;
+  symbol.compartmentIndex = 0;
+  this->symbols[id] = symbol;
+}
+
+void SymbolTable::addConstantSizeConcentration(const std::string &id, unsigned int index,
+                                               unsigned int compartmentIndex) {
+  Symbol symbol;
+  symbol.type = SymbolType::CONSTANT_SIZE_CONCENTRATION;
+  symbol.index = index;
+  symbol.compartmentIndex = compartmentIndex;
+  this->symbols[id] = symbol;
+}
+
+bool SymbolTable::contains(const std::string &id) const {
+  return this->symbols.find(id) != this->symbols.end();
+}
+
+const Symbol &SymbolTable::get(const std::string &id) const {
+  auto it = this->symbols.find(id);
+  if (it == this->symbols.end()) {
+    RuntimeExceptionUtil::throwUnknownNodeNameException(id);
+  }
+  return it->second;
+}
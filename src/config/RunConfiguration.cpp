@@ -3,7 +3,9 @@
 RunConfiguration::RunConfiguration(double duration, double stepInterval, std::vector<OutputField> outputFields,
                                    double absoluteTolerance, double relativeTolerance)
     : start(0), duration(duration), stepInterval(stepInterval), outputFields(outputFields),
-      absoluteTolerance(absoluteTolerance), relativeTolerance(relativeTolerance) {
+      absoluteTolerance(absoluteTolerance), relativeTolerance(relativeTolerance),
+      jitEnabled(false), integrationMethod(IntegrationMethod::RUNGE_KUTTA_DOPRI5),
+      jacobianMethod(JacobianMethod::AUTOMATIC_DIFFERENTIATION), seed(0) {
   // nothing to do
 }
 
@@ -11,7 +13,9 @@ RunConfiguration::RunConfiguration(double start, double duration, double stepInt
                                    std::vector<OutputField> outputFields, double absoluteTolerance,
                                    double relativeTolerance)
     : start(start), duration(duration), stepInterval(stepInterval), outputFields(outputFields),
-      absoluteTolerance(absoluteTolerance), relativeTolerance(relativeTolerance) {
+      absoluteTolerance(absoluteTolerance), relativeTolerance(relativeTolerance),
+      jitEnabled(false), integrationMethod(IntegrationMethod::RUNGE_KUTTA_DOPRI5),
+      jacobianMethod(JacobianMethod::AUTOMATIC_DIFFERENTIATION), seed(0) {
   // nothing to do
 }
 
@@ -42,3 +46,35 @@ double RunConfiguration::getAbsoluteTolerance() const {
 double RunConfiguration::getRelativeTolerance() const {
   return this->relativeTolerance;
 }
+
+void RunConfiguration::setJitEnabled(bool jitEnabled) {
+  this->jitEnabled = jitEnabled;
+}
+
+bool RunConfiguration::isJitEnabled() const {
+  return this->jitEnabled;
+}
+
+void RunConfiguration::setIntegrationMethod(IntegrationMethod integrationMethod) {
+  this->integrationMethod = integrationMethod;
+}
+
+IntegrationMethod RunConfiguration::getIntegrationMethod() const {
+  return this->integrationMethod;
+}
+
+void RunConfiguration::setJacobianMethod(JacobianMethod jacobianMethod) {
+  this->jacobianMethod = jacobianMethod;
+}
+
+JacobianMethod RunConfiguration::getJacobianMethod() const {
+  return this->jacobianMethod;
+}
+
+void RunConfiguration::setSeed(unsigned long seed) {
+  this->seed = seed;
+}
+
+unsigned long RunConfiguration::getSeed() const {
+  return this->seed;
+}
@@ -0,0 +1,121 @@
+#include "sbmlsim/internal/integrate/AutoSwitchingStepper.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const unsigned int CHECK_INTERVAL = 20;          // accepted steps between two stiffness checks
+const unsigned int REQUIRED_VOTES = 2;           // consecutive checks that agree before switching
+const double STABILITY_BOUNDARY = 3.3;           // of dopri5 on the negative real axis
+const double STIFF_RATIO = 0.8;                  // dopri5 steps at least this close to the boundary
+const double NON_STIFF_RATIO = 0.5;              // BDF steps at most this far into the explicit region
+const unsigned int POWER_ITERATIONS = 10;
+
+}  // namespace
+
+AutoSwitchingStepper::AutoSwitchingStepper(jacobian_function jacobian, double absoluteTolerance,
+                                           double relativeTolerance)
+    : jacobian(jacobian),
+      explicitStepper(odeint::make_controlled<odeint::runge_kutta_dopri5<state> >(absoluteTolerance,
+                                                                                  relativeTolerance)),
+      implicitStepper(jacobian, absoluteTolerance, relativeTolerance), explicitTime(0.0), stiff(false),
+      stepsSinceCheck(0), votes(0), numSwitches(0) {
+  // nothing to do
+}
+
+AutoSwitchingStepper::AutoSwitchingStepper(const AutoSwitchingStepper &stepper)
+    : jacobian(stepper.jacobian), explicitStepper(stepper.explicitStepper),
+      implicitStepper(stepper.implicitStepper), explicitState(stepper.explicitState),
+      explicitTime(stepper.explicitTime), stiff(stepper.stiff), stepsSinceCheck(stepper.stepsSinceCheck),
+      votes(stepper.votes), numSwitches(stepper.numSwitches), J(stepper.J), v(stepper.v), w(stepper.w) {
+  // nothing to do
+}
+
+AutoSwitchingStepper::~AutoSwitchingStepper() {
+  // nothing to do
+}
+
+void AutoSwitchingStepper::setAlgebraicComponents(const std::vector<unsigned int> &algebraicComponents) {
+  this->implicitStepper.setAlgebraicComponents(algebraicComponents);
+}
+
+bool AutoSwitchingStepper::isStiff() const {
+  return this->stiff;
+}
+
+unsigned int AutoSwitchingStepper::getNumSwitches() const {
+  return this->numSwitches;
+}
+
+/*
+ * dopri5 reuses the derivative at the end of its last step (FSAL), so it is reset whenever the state or time
+ * is not the one it produced: after a switch from BDF, or when events or assignment rules changed x.
+ */
+odeint::controlled_step_result AutoSwitchingStepper::tryStep(const system_function &system, state &x,
+                                                             double &t, double &dt) {
+  odeint::controlled_step_result result;
+  if (this->stiff) {
+    result = this->implicitStepper.try_step(system, x, t, dt);
+  } else {
+    if (t != this->explicitTime || x.size() != this->explicitState.size()
+        || !std::equal(x.begin(), x.end(), this->explicitState.begin())) {
+      this->explicitStepper.reset();
+    }
+    result = this->explicitStepper.try_step(system, x, t, dt);
+    if (result == odeint::success) {
+      this->explicitState = x;
+      this->explicitTime = t;
+    }
+  }
+
+  if (result == odeint::success && ++this->stepsSinceCheck >= CHECK_INTERVAL) {
+    this->stepsSinceCheck = 0;
+    checkStiffness(x, t, this->stiff ? this->implicitStepper.getStepSize() : dt);
+  }
+  return result;
+}
+
+/*
+ * h is the step the active stepper proposes next. The switch takes effect with the following try_step;
+ * BDFStepper restarts its history by itself because it did not produce the current state, and dopri5 is
+ * reset by tryStep.
+ */
+void AutoSwitchingStepper::checkStiffness(const state &x, double t, double h) {
+  double ratio = std::fabs(h) * estimateSpectralRadius(x, t) / STABILITY_BOUNDARY;
+  bool vote = this->stiff ? ratio < NON_STIFF_RATIO : ratio > STIFF_RATIO;
+  this->votes = vote ? this->votes + 1 : 0;
+
+  if (this->votes >= REQUIRED_VOTES) {
+    this->stiff = !this->stiff;
+    this->votes = 0;
+    this->numSwitches++;
+    this->explicitState.clear();
+  }
+}
+
+double AutoSwitchingStepper::estimateSpectralRadius(const state &x, double t) {
+  auto n = x.size();
+  if (this->J.size1() != n) {
+    this->J = matrix(n, n);
+    this->v = state(n);
+    this->w = state(n);
+  }
+  this->J.clear();
+  this->jacobian(x, this->J, t);
+
+  // power iteration from a vector with no particular structure
+  for (auto i = 0; i < n; i++) {
+    this->v[i] = 1.0 + 0.1 * i;
+  }
+  this->v /= ublas::norm_2(this->v);
+  double radius = 0.0;
+  for (auto k = 0; k < POWER_ITERATIONS; k++) {
+    ublas::noalias(this->w) = ublas::prod(this->J, this->v);
+    radius = ublas::norm_2(this->w);
+    if (radius == 0.0) {
+      break;
+    }
+    this->v = this->w / radius;
+  }
+  return radius;
+}
@@ -0,0 +1,407 @@
+#include "sbmlsim/internal/integrate/BDFStepper.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Nordsieck coefficients l_j of the fixed-step BDF formula of order q, l_1 = 1
+const double L[BDFStepper::MAX_ORDER + 1][BDFStepper::MAX_ORDER + 1] = {
+    {0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+    {1.0, 1.0, 0.0, 0.0, 0.0, 0.0},
+    {2.0 / 3.0, 1.0, 1.0 / 3.0, 0.0, 0.0, 0.0},
+    {6.0 / 11.0, 1.0, 6.0 / 11.0, 1.0 / 11.0, 0.0, 0.0},
+    {12.0 / 25.0, 1.0, 7.0 / 10.0, 1.0 / 5.0, 1.0 / 50.0, 0.0},
+    {60.0 / 137.0, 1.0, 225.0 / 274.0, 85.0 / 274.0, 15.0 / 274.0, 1.0 / 274.0}
+};
+
+const double FACTORIAL[BDFStepper::MAX_ORDER + 2] = {1.0, 1.0, 2.0, 6.0, 24.0, 120.0, 720.0};
+
+// error constant of order q: the local error is about C_q * e, e being the accumulated correction
+double errorConstant(unsigned int q) {
+  return L[q][0] / (q + 1);
+}
+
+const unsigned int MAX_NEWTON_ITERATIONS = 3;
+const double NEWTON_TOLERANCE = 0.1;       // on the error-test scale
+const double MAX_GAMMA_CHANGE = 0.3;       // refactor M beyond this relative change of gamma
+const unsigned int MAX_STEPS_BETWEEN_JACOBIANS = 20;
+const double MAX_ETA = 10.0;
+const double MIN_ETA_AFTER_ERROR = 0.2;
+const double ETA_AFTER_CONVERGENCE_FAILURE = 0.25;
+const double MIN_ETA_TO_CHANGE = 1.1;      // keep h (and the factors) for smaller gains
+
+}  // namespace
+
+BDFStepper::BDFStepper(jacobian_function jacobian, double absoluteTolerance, double relativeTolerance)
+    : jacobian(jacobian), absoluteTolerance(absoluteTolerance), relativeTolerance(relativeTolerance),
+      initialized(false), tn(0.0), h(0.0), hNext(0.0), q(1), tOutput(0.0), pivots(0), gammaFactored(0.0),
+      convergenceRate(1.0), jacobianFresh(false), stepsSinceJacobian(0), stepsUntilChange(0), errorTestFailures(0), numSteps(0),
+      numJacobianEvaluations(0), numFactorizations(0) {
+  // nothing to do
+}
+
+BDFStepper::BDFStepper(const BDFStepper &stepper)
+    : jacobian(stepper.jacobian), absoluteTolerance(stepper.absoluteTolerance),
+      relativeTolerance(stepper.relativeTolerance), algebraicComponents(stepper.algebraicComponents),
+      initialized(stepper.initialized), tn(stepper.tn), h(stepper.h), hNext(stepper.hNext), q(stepper.q),
+      tOutput(stepper.tOutput), xOutput(stepper.xOutput), z(stepper.z), e(stepper.e),
+      ePrevious(stepper.ePrevious), y(stepper.y), f(stepper.f), delta(stepper.delta), weights(stepper.weights),
+      J(stepper.J), M(stepper.M), pivots(stepper.pivots), gammaFactored(stepper.gammaFactored),
+      convergenceRate(stepper.convergenceRate), jacobianFresh(stepper.jacobianFresh),
+      stepsSinceJacobian(stepper.stepsSinceJacobian), stepsUntilChange(stepper.stepsUntilChange),
+      errorTestFailures(stepper.errorTestFailures), numSteps(stepper.numSteps),
+      numJacobianEvaluations(stepper.numJacobianEvaluations), numFactorizations(stepper.numFactorizations) {
+  // nothing to do
+}
+
+BDFStepper::~BDFStepper() {
+  // nothing to do
+}
+
+void BDFStepper::setAlgebraicComponents(const std::vector<unsigned int> &algebraicComponents) {
+  this->algebraicComponents = algebraicComponents;
+}
+
+unsigned int BDFStepper::getOrder() const {
+  return this->q;
+}
+
+double BDFStepper::getStepSize() const {
+  return this->hNext;
+}
+
+unsigned long BDFStepper::getNumSteps() const {
+  return this->numSteps;
+}
+
+unsigned long BDFStepper::getNumJacobianEvaluations() const {
+  return this->numJacobianEvaluations;
+}
+
+unsigned long BDFStepper::getNumFactorizations() const {
+  return this->numFactorizations;
+}
+
+/*
+ * The internal steps are not clipped to dt: a step that reaches beyond t + dt is taken in full and the
+ * state at t + dt is interpolated from the Nordsieck array, so output points do not shrink h. A later call
+ * whose t + dt falls within the step already taken is answered by interpolation alone.
+ */
+odeint::controlled_step_result BDFStepper::tryStep(const system_function &system, state &x, double &t,
+                                                   double &dt) {
+  if (!isContinuation(x, t)) {
+    initialize(system, x, t, dt);
+  } else {
+    // targets of assignment rules do not change the history; take their new values
+    for (auto i : this->algebraicComponents) {
+      this->z[0][i] = x[i];
+    }
+  }
+
+  if (dt <= this->tn - t) {
+    output(x, t, dt);
+    return odeint::success;
+  }
+
+  // never attempt more than the controller allows; costs nothing to refuse
+  double allowed = this->tn + this->hNext - t;
+  if (dt > allowed) {
+    dt = allowed;
+    return odeint::fail;
+  }
+
+  updateWeights(this->z[0]);
+  predict();
+
+  if (!solveCorrector(system)) {
+    retract();
+    if (!this->jacobianFresh) {
+      // retry the same step with a new Jacobian
+      this->stepsSinceJacobian = MAX_STEPS_BETWEEN_JACOBIANS;
+    } else {
+      rescale(ETA_AFTER_CONVERGENCE_FAILURE);
+      this->stepsUntilChange = this->q + 1;
+    }
+    this->hNext = this->h;
+    dt = std::min(dt, this->tn + this->hNext - t);
+    return odeint::fail;
+  }
+
+  double error = errorConstant(this->q) * norm(this->e);
+  if (error > 1.0) {
+    retract();
+    this->errorTestFailures++;
+    double eta = 1.0 / (std::pow(1.2 * error, 1.0 / (this->q + 1)) + 1e-6);
+    eta = std::max(MIN_ETA_AFTER_ERROR, std::min(0.9, eta));
+    if (this->errorTestFailures >= 3 && this->q > 1) {
+      // the history is not trustworthy; restart from order 1
+      this->q = 1;
+      eta = std::min(eta, 0.1);
+    }
+    rescale(eta);
+    this->stepsUntilChange = this->q + 1;
+    this->hNext = this->h;
+    dt = std::min(dt, this->tn + this->hNext - t);
+    return odeint::fail;
+  }
+
+  // accept: z_j += l_j * e
+  for (auto j = 0; j <= this->q; j++) {
+    this->z[j] += L[this->q][j] * this->e;
+  }
+  this->tn += this->h;
+  this->numSteps++;
+  this->stepsSinceJacobian++;
+  this->errorTestFailures = 0;
+  this->jacobianFresh = false;
+
+  selectStepAndOrder(error);
+  this->ePrevious = this->e;
+  this->hNext = this->h;
+  output(x, t, dt);
+  return odeint::success;
+}
+
+/*
+ * Moves x and t to t + dt, within the last step, and proposes the step that reaches the end of the next one.
+ */
+void BDFStepper::output(state &x, double &t, double &dt) {
+  double target = t + dt;
+  if (target == this->tn) {
+    x = this->z[0];
+  } else {
+    // y(tn + s * h) = sum_j z_j * s^j
+    double s = (target - this->tn) / this->h;
+    x = this->z[this->q];
+    for (int j = this->q - 1; j >= 0; j--) {
+      x = x * s + this->z[j];
+    }
+  }
+  t = target;
+  dt = this->tn + this->hNext - t;
+  this->tOutput = t;
+  this->xOutput = x;
+}
+
+/*
+ * Restarts the history at order 1 from x. The first step is limited by dt and by 0.01 * ||y|| / ||y'||.
+ */
+void BDFStepper::initialize(const system_function &system, const state &x, double t, double dt) {
+  auto n = x.size();
+  this->z.assign(MAX_ORDER + 1, state(n));
+  for (auto &column : this->z) {
+    column.clear();
+  }
+  this->e = state(n);
+  this->e.clear();
+  this->ePrevious = this->e;
+  this->y = state(n);
+  this->f = state(n);
+  this->delta = state(n);
+  this->weights = state(n);
+  this->J = matrix(n, n);
+  this->M = matrix(n, n);
+  this->pivots = ublas::permutation_matrix<std::size_t>(n);
+
+  system(x, this->f, t);
+  updateWeights(x);
+  double d0 = norm(x);
+  double d1 = norm(this->f);
+  double h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01 * d0 / d1;
+
+  this->h = std::min(h0, dt);
+  this->z[0] = x;
+  this->z[1] = this->h * this->f;
+  this->tn = t;
+  this->q = 1;
+  this->hNext = this->h;
+  this->gammaFactored = 0.0;
+  this->stepsSinceJacobian = MAX_STEPS_BETWEEN_JACOBIANS;
+  this->stepsUntilChange = this->q + 1;
+  this->errorTestFailures = 0;
+  this->tOutput = t;
+  this->xOutput = x;
+  this->initialized = true;
+}
+
+/*
+ * Callers such as sbmlsim::integrate_const compute output times as start + k * interval, which may differ
+ * from the t + dt handed back in the last bits; such a t still continues the history.
+ */
+bool BDFStepper::isContinuation(const state &x, double t) {
+  if (!this->initialized || x.size() != this->xOutput.size()) {
+    return false;
+  }
+  double tolerance = 4.0 * std::numeric_limits<double>::epsilon() * std::max(std::fabs(t), std::fabs(this->tOutput));
+  if (std::fabs(t - this->tOutput) > tolerance) {
+    return false;
+  }
+  for (auto i : this->algebraicComponents) {
+    this->xOutput[i] = x[i];
+  }
+  return std::equal(x.begin(), x.end(), this->xOutput.begin());
+}
+
+// h *= eta; z_j *= eta^j
+void BDFStepper::rescale(double eta) {
+  double factor = eta;
+  for (auto j = 1; j <= this->q; j++) {
+    this->z[j] *= factor;
+    factor *= eta;
+  }
+  this->h *= eta;
+}
+
+// z <- z * P, P being the Pascal matrix; a Taylor shift of the history by h
+void BDFStepper::predict() {
+  for (auto k = 1; k <= this->q; k++) {
+    for (auto j = this->q - k; j < this->q; j++) {
+      this->z[j] += this->z[j + 1];
+    }
+  }
+}
+
+// undoes predict()
+void BDFStepper::retract() {
+  for (auto k = 1; k <= this->q; k++) {
+    for (auto j = this->q - k; j < this->q; j++) {
+      this->z[j] -= this->z[j + 1];
+    }
+  }
+}
+
+/*
+ * Modified Newton iteration for e with h * f(z_0 + l_0 * e) = z_1 + e, iterating on
+ * (I - gamma * J) delta = h * f(y) - z_1 - e.
+ */
+bool BDFStepper::solveCorrector(const system_function &system) {
+  double gamma = this->h * L[this->q][0];
+  double t = this->tn + this->h;
+
+  if (this->stepsSinceJacobian >= MAX_STEPS_BETWEEN_JACOBIANS) {
+    this->jacobian(this->z[0], this->J, t);
+    this->numJacobianEvaluations++;
+    this->stepsSinceJacobian = 0;
+    this->jacobianFresh = true;
+    this->gammaFactored = 0.0;
+  }
+  if (this->gammaFactored == 0.0 || std::fabs(gamma / this->gammaFactored - 1.0) > MAX_GAMMA_CHANGE) {
+    this->gammaFactored = gamma;
+    this->convergenceRate = 1.0;
+    if (!factorize()) {
+      this->gammaFactored = 0.0;
+      return false;
+    }
+  }
+  // the factored M belongs to a slightly different gamma
+  double scale = 2.0 / (1.0 + gamma / this->gammaFactored);
+  double tolerance = NEWTON_TOLERANCE / errorConstant(this->q);
+
+  this->e.clear();
+  this->y = this->z[0];
+  double previous = 0.0;
+  for (auto m = 0; m < MAX_NEWTON_ITERATIONS; m++) {
+    system(this->y, this->f, t);
+    this->delta = this->h * this->f - this->z[1] - this->e;
+    ublas::lu_substitute(this->M, this->pivots, this->delta);
+    if (scale != 1.0) {
+      this->delta *= scale;
+    }
+    this->e += this->delta;
+    this->y = this->z[0] + L[this->q][0] * this->e;
+
+    double current = norm(this->delta);
+    if (m > 0) {
+      this->convergenceRate = std::max(0.3 * this->convergenceRate, current / previous);
+    }
+    if (current * std::min(1.0, this->convergenceRate) <= tolerance) {
+      return true;
+    }
+    if (m > 0 && current > 2.0 * previous) {
+      return false;
+    }
+    previous = current;
+  }
+  return false;
+}
+
+bool BDFStepper::factorize() {
+  auto n = this->J.size1();
+  this->M = -this->gammaFactored * this->J;
+  for (auto i = 0; i < n; i++) {
+    this->M(i, i) += 1.0;
+  }
+  this->pivots = ublas::permutation_matrix<std::size_t>(n);
+  this->numFactorizations++;
+  return ublas::lu_factorize(this->M, this->pivots) == 0;
+}
+
+void BDFStepper::updateWeights(const state &x) {
+  for (auto i = 0; i < x.size(); i++) {
+    this->weights[i] = 1.0 / (this->relativeTolerance * std::fabs(x[i]) + this->absoluteTolerance);
+  }
+}
+
+// weighted root-mean-square norm; 1 is the tolerance
+double BDFStepper::norm(const state &v) const {
+  if (v.empty()) {
+    return 0.0;
+  }
+  double sum = 0.0;
+  for (auto i = 0; i < v.size(); i++) {
+    double scaled = v[i] * this->weights[i];
+    sum += scaled * scaled;
+  }
+  return std::sqrt(sum / v.size());
+}
+
+/*
+ * After q + 1 steps at the same h and order, compares the step sizes the local error estimates of orders
+ * q - 1, q and q + 1 allow and switches to the best one.
+ */
+void BDFStepper::selectStepAndOrder(double error) {
+  if (this->stepsUntilChange > 1) {
+    this->stepsUntilChange--;
+    return;
+  }
+
+  double etaSame = 1.0 / (std::pow(1.2 * error, 1.0 / (this->q + 1)) + 1e-6);
+  double etaDown = 0.0;
+  if (this->q > 1) {
+    double errorDown = errorConstant(this->q - 1) * FACTORIAL[this->q] * norm(this->z[this->q]);
+    etaDown = 1.0 / (std::pow(1.3 * errorDown, 1.0 / this->q) + 1e-6);
+  }
+  double etaUp = 0.0;
+  if (this->q < MAX_ORDER) {
+    this->delta = this->e - this->ePrevious;
+    double errorUp = errorConstant(this->q + 1) * norm(this->delta);
+    etaUp = 1.0 / (std::pow(1.4 * errorUp, 1.0 / (this->q + 2)) + 1e-6);
+  }
+
+  double eta = etaSame;
+  unsigned int order = this->q;
+  if (etaDown > eta) {
+    eta = etaDown;
+    order = this->q - 1;
+  }
+  if (etaUp > eta) {
+    eta = etaUp;
+    order = this->q + 1;
+  }
+
+  if (eta < MIN_ETA_TO_CHANGE) {
+    // not worth refactoring; look again in a few steps
+    this->stepsUntilChange = 3;
+    return;
+  }
+
+  if (order > this->q) {
+    this->z[order] = this->e * (L[this->q][this->q] / order);
+  } else if (order < this->q) {
+    this->z[this->q].clear();
+  }
+  this->q = order;
+  rescale(std::min(eta, MAX_ETA));
+  this->stepsUntilChange = this->q + 1;
+}
@@ -1,12 +1,12 @@
 #include "sbmlsim/internal/observer/ObserveTarget.h"
 
-ObserveTarget::ObserveTarget(const std::string &id, unsigned int stateIndex)
-    : id(id), stateIndex(stateIndex) {
+ObserveTarget::ObserveTarget(const std::string &id, unsigned int stateIndex, bool constant)
+    : id(id), stateIndex(stateIndex), constant(constant) {
   // nothing to do
 }
 
 ObserveTarget::ObserveTarget(const ObserveTarget &observeTarget)
-    : id(observeTarget.id), stateIndex(observeTarget.stateIndex) {
+    : id(observeTarget.id), stateIndex(observeTarget.stateIndex), constant(observeTarget.constant) {
   // nothing to do
 }
 
@@ -21,3 +21,7 @@ const std::string &ObserveTarget::getId() const {
 unsigned int ObserveTarget::getStateIndex() const {
   return this->stateIndex;
 }
+
+bool ObserveTarget::isConstant() const {
+  return this->constant;
+}
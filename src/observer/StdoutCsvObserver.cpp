@@ -3,13 +3,13 @@
 
 #define OUTPUT_PRECISION 15
 
-StdoutCsvObserver::StdoutCsvObserver(const std::vector<ObserveTarget> &targets)
-    : targets(targets) {
+StdoutCsvObserver::StdoutCsvObserver(const std::vector<ObserveTarget> &targets, const std::vector<double> &constants)
+    : targets(targets), constants(constants) {
   // nothing to do
 }
 
 StdoutCsvObserver::StdoutCsvObserver(const StdoutCsvObserver &observer)
-    : targets(observer.targets) {
+    : targets(observer.targets), constants(observer.constants) {
   // nothing to do
 }
 
@@ -26,7 +26,7 @@ void StdoutCsvObserver::outputState(const SBMLSystem::state &x, double t) {
   std::cout << std::setprecision(OUTPUT_PRECISION);
   for (auto target : this->targets) {
     auto index = target.getStateIndex();
-    std::cout << "," << x[index];
+    std::cout << "," << (target.isConstant() ? this->constants[index] : x[index]);
   }
   std::cout << std::endl;
 }
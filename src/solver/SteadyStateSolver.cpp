@@ -0,0 +1,346 @@
+#include "sbmlsim/internal/solver/SteadyStateSolver.h"
+#include <algorithm>
+#include <cmath>
+#include "sbmlsim/internal/integrate/BDFStepper.h"
+
+namespace {
+
+const unsigned int MAX_NEWTON_ITERATIONS = 50;
+const double MIN_DAMPING = 1.0 / 1024.0;
+const double SUFFICIENT_DECREASE = 1e-4;
+const unsigned int MAX_PSEUDO_TRANSIENT_ITERATIONS = 500;
+const double INITIAL_PSEUDO_TIME_STEP = 1e-3;
+const double MAX_PSEUDO_TIME_STEP = 1e12;
+const double INITIAL_HORIZON = 1.0;
+const double HORIZON_GROWTH = 10.0;
+const unsigned int MAX_STEPS_PER_HORIZON = 100000;
+const double RANK_TOLERANCE = 1e-10;
+
+}  // namespace
+
+SteadyStateSolver::SteadyStateSolver(system_function system, jacobian_function jacobian, double absoluteTolerance,
+                                     double relativeTolerance, double maxTime)
+    : system(system), jacobian(jacobian), absoluteTolerance(absoluteTolerance),
+      relativeTolerance(relativeTolerance), maxTime(maxTime), t(0.0), pivots(0) {
+  // nothing to do
+}
+
+SteadyStateSolver::SteadyStateSolver(const SteadyStateSolver &solver)
+    : system(solver.system), jacobian(solver.jacobian), absoluteTolerance(solver.absoluteTolerance),
+      relativeTolerance(solver.relativeTolerance), maxTime(solver.maxTime), t(solver.t), f(solver.f),
+      trial(solver.trial), fTrial(solver.fTrial), dx(solver.dx), J(solver.J), M(solver.M), pivots(solver.pivots),
+      fixedRows(solver.fixedRows), conservationLaws(solver.conservationLaws), dependentRows(solver.dependentRows),
+      conservedTotals(solver.conservedTotals) {
+  // nothing to do
+}
+
+SteadyStateSolver::~SteadyStateSolver() {
+  // nothing to do
+}
+
+/*
+ * Conserved moieties span the left null space of the stoichiometry matrix N, the null space of N^T. N^T is
+ * brought to reduced row echelon form and every free column yields one law, which is 1 there and 0 at the
+ * other free columns; so replacing the rows of the free columns keeps the Newton matrix regular. Empty rows
+ * of N belong to variables that reactions do not change and take part in no law.
+ */
+void SteadyStateSolver::setStoichiometryMatrix(const matrix &stoichiometry) {
+  auto n = stoichiometry.size1();
+  auto m = stoichiometry.size2();
+  std::vector<unsigned int> species;
+  for (auto i = 0; i < n; i++) {
+    for (auto j = 0; j < m; j++) {
+      if (stoichiometry(i, j) != 0.0) {
+        species.push_back(i);
+        break;
+      }
+    }
+  }
+
+  // A = N^T restricted to the species
+  auto numSpecies = species.size();
+  matrix A(m, numSpecies);
+  double scale = 0.0;
+  for (auto r = 0; r < m; r++) {
+    for (auto c = 0; c < numSpecies; c++) {
+      A(r, c) = stoichiometry(species[c], r);
+      scale = std::max(scale, std::fabs(A(r, c)));
+    }
+  }
+
+  // Gauss-Jordan elimination with partial pivoting
+  std::vector<unsigned int> pivotColumns;
+  std::vector<bool> isPivot(numSpecies, false);
+  for (auto c = 0; c < numSpecies && pivotColumns.size() < m; c++) {
+    auto row = pivotColumns.size();
+    auto best = row;
+    for (auto r = row + 1; r < m; r++) {
+      if (std::fabs(A(r, c)) > std::fabs(A(best, c))) {
+        best = r;
+      }
+    }
+    if (std::fabs(A(best, c)) <= RANK_TOLERANCE * scale) {
+      continue;
+    }
+    for (auto k = 0; k < numSpecies; k++) {
+      std::swap(A(row, k), A(best, k));
+    }
+    double pivot = A(row, c);
+    for (auto k = 0; k < numSpecies; k++) {
+      A(row, k) /= pivot;
+    }
+    for (auto r = 0; r < m; r++) {
+      double factor = A(r, c);
+      if (r == row || factor == 0.0) {
+        continue;
+      }
+      for (auto k = 0; k < numSpecies; k++) {
+        A(r, k) -= factor * A(row, k);
+      }
+    }
+    pivotColumns.push_back(c);
+    isPivot[c] = true;
+  }
+
+  this->conservationLaws.resize(numSpecies - pivotColumns.size(), n, false);
+  this->conservationLaws.clear();
+  this->dependentRows.clear();
+  for (auto c = 0; c < numSpecies; c++) {
+    if (isPivot[c]) {
+      continue;
+    }
+    auto k = this->dependentRows.size();
+    this->conservationLaws(k, species[c]) = 1.0;
+    for (auto r = 0; r < pivotColumns.size(); r++) {
+      this->conservationLaws(k, species[pivotColumns[r]]) = -A(r, c);
+    }
+    this->dependentRows.push_back(species[c]);
+  }
+}
+
+SteadyState SteadyStateSolver::solve(const state &x0, double t) {
+  auto n = x0.size();
+  this->t = t;
+  this->f.resize(n);
+  this->trial.resize(n);
+  this->fTrial.resize(n);
+  this->dx.resize(n);
+  this->J.resize(n, n);
+  this->conservedTotals.resize(this->dependentRows.size());
+  for (auto k = 0; k < this->dependentRows.size(); k++) {
+    this->conservedTotals[k] = ublas::inner_prod(ublas::row(this->conservationLaws, k), x0);
+  }
+
+  SteadyState result;
+  result.x = x0;
+  result.method = SteadyStateMethod::NONE;
+  result.residualNorm = 0.0;
+  result.time = 0.0;
+  result.newtonIterations = 0;
+  result.pseudoTransientIterations = 0;
+  result.numLinearSolves = 0;
+  result.numJacobianEvaluations = 0;
+
+  // every phase starts over from x0
+  state x = x0;
+  if (newton(x, result)) {
+    result.method = SteadyStateMethod::NEWTON;
+  } else {
+    x = x0;
+    if (pseudoTransientContinuation(x, result)) {
+      result.method = SteadyStateMethod::PSEUDO_TRANSIENT_CONTINUATION;
+    } else {
+      x = x0;
+      if (timeCourse(x, result)) {
+        result.method = SteadyStateMethod::TIME_COURSE;
+      }
+    }
+  }
+
+  this->system(x, this->f, this->t);
+  result.x = x;
+  result.residualNorm = residualNorm(x, this->f);
+  return result;
+}
+
+bool SteadyStateSolver::newton(state &x, SteadyState &result) {
+  this->system(x, this->f, this->t);
+  double norm = ublas::norm_2(this->f);
+  for (auto k = 0; k < MAX_NEWTON_ITERATIONS; k++) {
+    if (!isFinite(this->f)) {
+      return false;
+    }
+    if (residualNorm(x, this->f) <= 1.0) {
+      return true;
+    }
+    result.newtonIterations++;
+
+    // -J dx = f, with L dx = T - L x in place of the dependent rows
+    evaluateJacobian(x, result);
+    if (!factorize(0.0, true)) {
+      return false;
+    }
+    this->dx = this->f;
+    for (auto k = 0; k < this->dependentRows.size(); k++) {
+      this->dx[this->dependentRows[k]] =
+          this->conservedTotals[k] - ublas::inner_prod(ublas::row(this->conservationLaws, k), x);
+    }
+    ublas::lu_substitute(this->M, this->pivots, this->dx);
+    result.numLinearSolves++;
+
+    // backtrack until ||f|| decreases sufficiently
+    double lambda = 1.0;
+    while (true) {
+      this->trial = x + lambda * this->dx;
+      this->system(this->trial, this->fTrial, this->t);
+      double trialNorm = ublas::norm_2(this->fTrial);
+      if (isFinite(this->fTrial) && trialNorm <= (1.0 - SUFFICIENT_DECREASE * lambda) * norm) {
+        x.swap(this->trial);
+        this->f.swap(this->fTrial);
+        norm = trialNorm;
+        break;
+      }
+      lambda *= 0.5;
+      if (lambda < MIN_DAMPING) {
+        return false;
+      }
+    }
+  }
+  return residualNorm(x, this->f) <= 1.0;
+}
+
+bool SteadyStateSolver::pseudoTransientContinuation(state &x, SteadyState &result) {
+  double tau = INITIAL_PSEUDO_TIME_STEP;
+  this->system(x, this->f, this->t);
+  double norm = ublas::norm_2(this->f);
+  for (auto k = 0; k < MAX_PSEUDO_TRANSIENT_ITERATIONS; k++) {
+    if (residualNorm(x, this->f) <= 1.0) {
+      return true;
+    }
+    result.pseudoTransientIterations++;
+
+    // (I / tau - J) dx = f, a linearly implicit Euler step of size tau
+    evaluateJacobian(x, result);
+    if (!factorize(1.0 / tau, false)) {
+      tau *= 0.1;
+      continue;
+    }
+    this->dx = this->f;
+    ublas::lu_substitute(this->M, this->pivots, this->dx);
+    result.numLinearSolves++;
+
+    this->trial = x + this->dx;
+    this->system(this->trial, this->fTrial, this->t);
+    if (!isFinite(this->trial) || !isFinite(this->fTrial)) {
+      tau *= 0.1;
+      continue;
+    }
+    double trialNorm = ublas::norm_2(this->fTrial);
+    x.swap(this->trial);
+    this->f.swap(this->fTrial);
+
+    // switched evolution relaxation: tau grows as the residual falls
+    tau = std::min(MAX_PSEUDO_TIME_STEP, tau * norm / std::max(trialNorm, 1e-300));
+    norm = trialNorm;
+  }
+  return residualNorm(x, this->f) <= 1.0;
+}
+
+bool SteadyStateSolver::timeCourse(state &x, SteadyState &result) {
+  BDFStepper stepper(this->jacobian, this->absoluteTolerance, this->relativeTolerance);
+  double time = this->t;
+  double dt = INITIAL_PSEUDO_TIME_STEP;
+  double horizon = INITIAL_HORIZON;
+  while (time - this->t < this->maxTime) {
+    double end = this->t + std::min(horizon, this->maxTime);
+    for (auto step = 0; step < MAX_STEPS_PER_HORIZON && time < end; step++) {
+      dt = std::min(dt, end - time);
+      stepper.try_step(this->system, x, time, dt);
+    }
+    result.time = time - this->t;
+    if (time < end || !isFinite(x)) {
+      return false;
+    }
+
+    // polish from the integrated state
+    state polished = x;
+    if (newton(polished, result)) {
+      x.swap(polished);
+      return true;
+    }
+    horizon *= HORIZON_GROWTH;
+  }
+  this->system(x, this->f, this->t);
+  return residualNorm(x, this->f) <= 1.0;
+}
+
+/*
+ * A row with no structural entries and a zero rate belongs to a variable that does not move; it is
+ * replaced by the identity so that the linear systems stay regular.
+ */
+void SteadyStateSolver::evaluateJacobian(const state &x, SteadyState &result) {
+  this->jacobian(x, this->J, this->t);
+  result.numJacobianEvaluations++;
+  auto n = x.size();
+  this->fixedRows.assign(n, false);
+  for (auto i = 0; i < n; i++) {
+    bool zero = this->f[i] == 0.0;
+    for (auto j = 0; zero && j < n; j++) {
+      zero = this->J(i, j) == 0.0;
+    }
+    this->fixedRows[i] = zero;
+  }
+}
+
+// M = shift * I - J, or the identity on fixed rows; if conserved, the conservation laws on the dependent rows
+bool SteadyStateSolver::factorize(double shift, bool conserved) {
+  auto n = this->J.size1();
+  this->M = -this->J;
+  for (auto i = 0; i < n; i++) {
+    if (this->fixedRows[i]) {
+      for (auto j = 0; j < n; j++) {
+        this->M(i, j) = 0.0;
+      }
+      this->M(i, i) = 1.0;
+    } else {
+      this->M(i, i) += shift;
+    }
+  }
+  if (conserved) {
+    for (auto k = 0; k < this->dependentRows.size(); k++) {
+      ublas::row(this->M, this->dependentRows[k]) = ublas::row(this->conservationLaws, k);
+    }
+  }
+  this->pivots = ublas::permutation_matrix<std::size_t>(n);
+  if (ublas::lu_factorize(this->M, this->pivots) != 0) {
+    return false;
+  }
+  for (auto i = 0; i < n; i++) {
+    if (!std::isfinite(this->M(i, i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+double SteadyStateSolver::residualNorm(const state &x, const state &residual) const {
+  auto n = x.size();
+  if (n == 0) {
+    return 0.0;
+  }
+  double sum = 0.0;
+  for (auto i = 0; i < n; i++) {
+    double r = residual[i] / (this->absoluteTolerance + this->relativeTolerance * std::fabs(x[i]));
+    sum += r * r;
+  }
+  return std::sqrt(sum / n);
+}
+
+bool SteadyStateSolver::isFinite(const state &v) {
+  for (auto value : v) {
+    if (!std::isfinite(value)) {
+      return false;
+    }
+  }
+  return true;
+}
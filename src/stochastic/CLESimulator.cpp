@@ -0,0 +1,127 @@
+#include "sbmlsim/internal/stochastic/CLESimulator.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+CLESimulator::CLESimulator(SBMLSystem &system, unsigned long seed, double stepSize, CLEScheme scheme)
+    : network(system), engine(seed), stepSize(stepSize), scheme(scheme), hasEvents(system.getNumEvents() > 0),
+      roots(network.getNumReactions(), 0.0), supportRoots(network.getNumReactions(), 0.0),
+      increments(network.getNumReactions(), 0.0), numSteps(0) {
+  // nothing to do
+}
+
+CLESimulator::CLESimulator(const CLESimulator &simulator)
+    : network(simulator.network), engine(simulator.engine), stepSize(simulator.stepSize),
+      scheme(simulator.scheme), hasEvents(simulator.hasEvents), roots(simulator.roots),
+      supportRoots(simulator.supportRoots), increments(simulator.increments), drift(simulator.drift),
+      support(simulator.support), next(simulator.next), numSteps(simulator.numSteps) {
+  // nothing to do
+}
+
+CLESimulator::~CLESimulator() {
+  // nothing to do
+}
+
+void CLESimulator::initialize(const state &x, double t) {
+  this->drift.resize(x.size());
+  this->support.resize(x.size());
+  this->next.resize(x.size());
+}
+
+/*
+ * Takes one step of at most stepSize, shortened to end exactly at until or at the next scheduled event, and
+ * returns whether until is still ahead; the same contract as SSASimulator::step with a step in place of a
+ * firing.
+ */
+bool CLESimulator::step(state &x, double &t, double until) {
+  if (t >= until) {
+    handleEvent(x, t);
+    return false;
+  }
+  double limit = this->network.getStepLimit(t, until);
+  if (limit <= t) {
+    // an event due now
+    handleEvent(x, t);
+    return true;
+  }
+  double h = limit - t <= this->stepSize * (1.0 + 1e-9) ? limit - t : this->stepSize;
+  double sqrtH = std::sqrt(h);
+
+  evaluateRoots(x, t, this->roots);
+  std::normal_distribution<double> normal(0.0, 1.0);
+  this->next = x;
+  for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+    this->increments[j] = sqrtH * normal(this->engine);
+    double a = this->roots[j] * this->roots[j];
+    this->network.applyStateChanges(j, a * h + this->roots[j] * this->increments[j], this->next);
+  }
+  if (this->scheme == CLEScheme::MILSTEIN) {
+    addMilsteinCorrection(x, t, h);
+  }
+
+  x.swap(this->next);
+  t = limit - t <= h ? limit : t + h;
+  this->network.applyAssignmentRules(x, t);
+  this->numSteps++;
+  handleEvent(x, t);
+  return t < until;
+}
+
+// switches to stream of the seed, e.g. the index of a trajectory in an ensemble
+void CLESimulator::setStream(unsigned long stream) {
+  this->engine.setStream(stream);
+}
+
+unsigned long CLESimulator::getNumSteps() const {
+  return this->numSteps;
+}
+
+/*
+ * The noise can take amounts below zero, where mass-action rates turn negative; those reactions are
+ * truncated to a zero rate, as usual for the chemical Langevin equation. Reversible reactions, the other
+ * source of negative rates, are rejected by ReactionNetwork.
+ */
+void CLESimulator::evaluateRoots(const state &x, double t, std::vector<double> &roots) {
+  for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+    roots[j] = std::sqrt(std::max(this->network.evaluateRate(j, x, t), 0.0));
+  }
+}
+
+/*
+ * Adds sum_{j,k} L^k b_j I_(k,j) with I_(k,j) + I_(j,k) = dW_j dW_k, I_(k,k) = (dW_k^2 - h) / 2 and
+ * L^k b_j ~ v_j (sqrt(a_j(Y_k)) - sqrt(a_j(x))) / sqrt(h), Y_k = x + f h + v_k sqrt(a_k(x) h).
+ * Reactions with a_k = 0 have b_k = 0 and contribute nothing.
+ */
+void CLESimulator::addMilsteinCorrection(const state &x, double t, double h) {
+  auto numReactions = this->network.getNumReactions();
+  double sqrtH = std::sqrt(h);
+  std::fill(this->drift.begin(), this->drift.end(), 0.0);
+  for (unsigned int j = 0; j < numReactions; j++) {
+    this->network.applyStateChanges(j, this->roots[j] * this->roots[j], this->drift);
+  }
+
+  for (unsigned int k = 0; k < numReactions; k++) {
+    if (this->roots[k] <= 0.0) {
+      continue;
+    }
+    this->support = x + h * this->drift;
+    this->network.applyStateChanges(k, this->roots[k] * sqrtH, this->support);
+    this->network.applyAssignmentRules(this->support, t);
+    evaluateRoots(this->support, t, this->supportRoots);
+    for (unsigned int j = 0; j < numReactions; j++) {
+      double difference = this->supportRoots[j] - this->roots[j];
+      if (difference == 0.0) {
+        continue;
+      }
+      double product = this->increments[j] * this->increments[k] - (j == k ? h : 0.0);
+      this->network.applyStateChanges(j, 0.5 * difference * product / sqrtH, this->next);
+    }
+  }
+}
+
+void CLESimulator::handleEvent(state &x, double t) {
+  if (!this->hasEvents) {
+    return;
+  }
+  this->network.getSystem().handleEvent(x, t);
+}
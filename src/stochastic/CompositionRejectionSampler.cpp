@@ -0,0 +1,116 @@
+#include "sbmlsim/internal/stochastic/CompositionRejectionSampler.h"
+
+CompositionRejectionSampler::CompositionRejectionSampler() : total(0.0) {
+  // nothing to do
+}
+
+CompositionRejectionSampler::CompositionRejectionSampler(unsigned int numReactions)
+    : propensities(numReactions, 0.0), groupOf(numReactions, NO_GROUP), positionOf(numReactions, 0), total(0.0) {
+  // nothing to do
+}
+
+CompositionRejectionSampler::CompositionRejectionSampler(const CompositionRejectionSampler &sampler)
+    : propensities(sampler.propensities), groupOf(sampler.groupOf), positionOf(sampler.positionOf),
+      groups(sampler.groups), groupIndex(sampler.groupIndex), total(sampler.total) {
+  // nothing to do
+}
+
+CompositionRejectionSampler::~CompositionRejectionSampler() {
+  // nothing to do
+}
+
+void CompositionRejectionSampler::update(unsigned int reaction, double propensity) {
+  if (!(propensity > 0.0)) {
+    propensity = 0.0;
+  }
+  int exponent;
+  std::frexp(propensity, &exponent);
+  auto g = this->groupOf[reaction];
+  if (g != NO_GROUP && propensity > 0.0 && this->groups[g].exponent == exponent) {
+    // stays in its group
+    double delta = propensity - this->propensities[reaction];
+    this->propensities[reaction] = propensity;
+    addToSum(g, delta);
+  } else {
+    remove(reaction);
+    insert(reaction, propensity);
+  }
+  updateTotal();
+}
+
+double CompositionRejectionSampler::getPropensity(unsigned int reaction) const {
+  return this->propensities[reaction];
+}
+
+double CompositionRejectionSampler::getTotal() const {
+  return this->total;
+}
+
+void CompositionRejectionSampler::remove(unsigned int reaction) {
+  auto g = this->groupOf[reaction];
+  if (g == NO_GROUP) {
+    return;
+  }
+  auto &group = this->groups[g];
+  auto position = this->positionOf[reaction];
+  auto last = group.members.back();
+  group.members[position] = last;
+  this->positionOf[last] = position;
+  group.members.pop_back();
+  double delta = -this->propensities[reaction];
+  this->groupOf[reaction] = NO_GROUP;
+  this->propensities[reaction] = 0.0;
+  addToSum(g, delta);
+}
+
+void CompositionRejectionSampler::insert(unsigned int reaction, double propensity) {
+  this->propensities[reaction] = propensity;
+  if (propensity == 0.0) {
+    return;
+  }
+  int exponent;
+  std::frexp(propensity, &exponent);
+  auto found = this->groupIndex.find(exponent);
+  unsigned int g;
+  if (found != this->groupIndex.end()) {
+    g = found->second;
+  } else {
+    g = this->groups.size();
+    Group group;
+    group.exponent = exponent;
+    group.sum = 0.0;
+    group.numChanges = 0;
+    this->groups.push_back(group);
+    this->groupIndex[exponent] = g;
+  }
+  auto &group = this->groups[g];
+  this->groupOf[reaction] = g;
+  this->positionOf[reaction] = group.members.size();
+  group.members.push_back(reaction);
+  addToSum(g, propensity);
+}
+
+// an empty group is recomputed right away, so it is exactly 0
+void CompositionRejectionSampler::addToSum(unsigned int g, double delta) {
+  auto &group = this->groups[g];
+  group.numChanges++;
+  if (group.numChanges < group.members.size()) {
+    group.sum += delta;
+    return;
+  }
+  double sum = 0.0;
+  for (auto reaction : group.members) {
+    sum += this->propensities[reaction];
+  }
+  group.sum = sum;
+  group.numChanges = 0;
+}
+
+// the number of groups is bounded by the dynamic range of the propensities, not by the number of reactions
+void CompositionRejectionSampler::updateTotal() {
+  double sum = 0.0;
+  for (auto &group : this->groups) {
+    sum += group.sum;
+  }
+  this->total = sum;
+}
@@ -0,0 +1,200 @@
+#include "sbmlsim/internal/stochastic/HybridSimulator.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+
+namespace {
+
+const unsigned int MAX_BISECTIONS = 60;
+const unsigned int REPARTITION_STEPS = 20;  // ODE steps between two checks of the partition
+
+}  // namespace
+
+HybridSimulator::HybridSimulator(SBMLSystem &system, unsigned long seed, double absoluteTolerance,
+                                 double relativeTolerance, double propensityThreshold, double copyNumberThreshold)
+    : network(system),
+      stepper(odeint::make_dense_output(absoluteTolerance, relativeTolerance, odeint::runge_kutta_dopri5<state>())),
+      engine(seed), propensityThreshold(propensityThreshold), copyNumberThreshold(copyNumberThreshold),
+      hasEvents(system.getNumEvents() > 0), fast(network.getNumReactions(), false),
+      propensities(network.getNumReactions(), 0.0), numFirings(0) {
+  // nothing to do
+}
+
+HybridSimulator::HybridSimulator(const HybridSimulator &simulator)
+    : network(simulator.network), stepper(simulator.stepper), engine(simulator.engine),
+      propensityThreshold(simulator.propensityThreshold), copyNumberThreshold(simulator.copyNumberThreshold),
+      hasEvents(simulator.hasEvents), fast(simulator.fast), propensities(simulator.propensities), y(simulator.y),
+      probe(simulator.probe), buffer(simulator.buffer), numFirings(simulator.numFirings) {
+  // nothing to do
+}
+
+HybridSimulator::~HybridSimulator() {
+  // nothing to do
+}
+
+void HybridSimulator::initialize(const state &x, double t) {
+  this->y.resize(x.size() + 1);
+  this->probe.resize(x.size() + 1);
+  this->buffer.resize(x.size() + 1);
+  partition(x, t);
+}
+
+/*
+ * Integrates the fast reactions until the next slow firing, the next scheduled event, until, or the first
+ * check after which the partition would change, whichever comes first. Same contract as SSASimulator::step,
+ * a slow firing, a scheduled event and a repartition each counting as one step.
+ */
+bool HybridSimulator::step(state &x, double &t, double until) {
+  if (t >= until) {
+    handleEvent(x, t);
+    return false;
+  }
+  double limit = this->network.getStepLimit(t, until);
+  partition(x, t);
+  std::copy(x.begin(), x.end(), this->y.begin());
+  auto n = x.size();
+  this->y[n] = 0.0;
+
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double threshold = -std::log(1.0 - uniform(this->engine));
+  this->stepper.initialize(this->y, t, std::min(limit - t, 1e-3 * std::max(1.0, limit - t)));
+
+  double firingTime = limit;
+  bool fires = false;
+  bool repartitions = false;
+  for (unsigned int k = 1; ; k++) {
+    double t0 = this->stepper.current_time();
+    if (t0 < limit) {
+      this->stepper.do_step(std::ref(*this));
+    }
+    double t1 = std::min(this->stepper.current_time(), limit);
+    this->stepper.calc_state(t1, this->probe);
+    if (this->probe[n] >= threshold) {
+      firingTime = locateFiring(t0, t1, threshold);
+      fires = true;
+      break;
+    }
+    if (t1 >= limit) {
+      break;
+    }
+    if (k % REPARTITION_STEPS == 0 && isPartitionOutdated(t1)) {
+      firingTime = t1;
+      repartitions = true;
+      break;
+    }
+  }
+
+  this->stepper.calc_state(firingTime, this->probe);
+  std::copy(this->probe.begin(), this->probe.begin() + n, x.begin());
+  t = firingTime;
+  this->network.applyAssignmentRules(x, t);
+  if (fires) {
+    // one slow reaction, chosen in proportion to its propensity at the firing time
+    double total = 0.0;
+    for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+      this->propensities[j] = this->fast[j] ? 0.0 : this->network.evaluatePropensity(j, x, t);
+      total += this->propensities[j];
+    }
+    double target = uniform(this->engine) * total;
+    unsigned int chosen = 0;
+    for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+      if (this->propensities[j] <= 0.0) {
+        continue;
+      }
+      chosen = j;
+      target -= this->propensities[j];
+      if (target < 0.0) {
+        break;
+      }
+    }
+    if (total > 0.0) {
+      this->network.fire(chosen, x, t);
+      this->numFirings++;
+    }
+  }
+  handleEvent(x, t);
+  return fires || repartitions || t < until;
+}
+
+/*
+ * Fast reactions feed dx/dt with their kinetic laws as they are, like a deterministic simulation would;
+ * slow reactions feed dg/dt with their propensities.
+ */
+void HybridSimulator::operator()(const state &y, state &dydt, double t) {
+  auto n = y.size() - 1;
+  std::copy(y.begin(), y.end(), this->buffer.begin());
+  this->network.applyAssignmentRules(this->buffer, t);
+  std::fill(dydt.begin(), dydt.end(), 0.0);
+  for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+    if (this->fast[j]) {
+      this->network.applyStateChanges(j, this->network.evaluateRate(j, this->buffer, t), dydt);
+    } else {
+      dydt[n] += this->network.evaluatePropensity(j, this->buffer, t);
+    }
+  }
+}
+
+// switches to stream of the seed, e.g. the index of a trajectory in an ensemble
+void HybridSimulator::setStream(unsigned long stream) {
+  this->engine.setStream(stream);
+}
+
+unsigned long HybridSimulator::getNumFirings() const {
+  return this->numFirings;
+}
+
+unsigned int HybridSimulator::getNumFastReactions() const {
+  return std::count(this->fast.begin(), this->fast.end(), true);
+}
+
+void HybridSimulator::partition(const state &x, double t) {
+  for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+    this->fast[j] = isFast(j, x, t);
+  }
+}
+
+bool HybridSimulator::isFast(unsigned int reaction, const state &x, double t) {
+  bool fast = this->network.evaluatePropensity(reaction, x, t) >= this->propensityThreshold;
+  for (auto &reactant : this->network.getReactants(reaction)) {
+    fast = fast && x[reactant.index] >= this->copyNumberThreshold;
+  }
+  for (auto &change : this->network.getStateChanges(reaction)) {
+    fast = fast && (change.delta >= 0.0 || x[change.index] >= this->copyNumberThreshold);
+  }
+  return fast;
+}
+
+// whether the state in probe at t would be partitioned differently
+bool HybridSimulator::isPartitionOutdated(double t) {
+  std::copy(this->probe.begin(), this->probe.end(), this->buffer.begin());
+  this->network.applyAssignmentRules(this->buffer, t);
+  for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+    if (isFast(j, this->buffer, t) != this->fast[j]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// g is non-decreasing, so bisection on the interpolant brackets the crossing
+double HybridSimulator::locateFiring(double t0, double t1, double threshold) {
+  auto n = this->y.size() - 1;
+  for (unsigned int k = 0; k < MAX_BISECTIONS && t1 - t0 > 1e-12 * std::max(1.0, std::fabs(t1)); k++) {
+    double mid = 0.5 * (t0 + t1);
+    this->stepper.calc_state(mid, this->probe);
+    if (this->probe[n] >= threshold) {
+      t1 = mid;
+    } else {
+      t0 = mid;
+    }
+  }
+  return t1;
+}
+
+void HybridSimulator::handleEvent(state &x, double t) {
+  if (!this->hasEvents) {
+    return;
+  }
+  this->network.getSystem().handleEvent(x, t);
+}
@@ -0,0 +1,85 @@
+#include "sbmlsim/internal/stochastic/IndexedPriorityQueue.h"
+#include <limits>
+
+IndexedPriorityQueue::IndexedPriorityQueue() {
+  // nothing to do
+}
+
+IndexedPriorityQueue::IndexedPriorityQueue(unsigned int size)
+    : times(size, std::numeric_limits<double>::infinity()), heap(size), position(size) {
+  for (unsigned int i = 0; i < size; i++) {
+    this->heap[i] = i;
+    this->position[i] = i;
+  }
+}
+
+IndexedPriorityQueue::IndexedPriorityQueue(const IndexedPriorityQueue &queue)
+    : times(queue.times), heap(queue.heap), position(queue.position) {
+  // nothing to do
+}
+
+IndexedPriorityQueue::~IndexedPriorityQueue() {
+  // nothing to do
+}
+
+unsigned int IndexedPriorityQueue::size() const {
+  return this->heap.size();
+}
+
+unsigned int IndexedPriorityQueue::top() const {
+  return this->heap[0];
+}
+
+double IndexedPriorityQueue::getTime(unsigned int reaction) const {
+  return this->times[reaction];
+}
+
+void IndexedPriorityQueue::update(unsigned int reaction, double time) {
+  double previous = this->times[reaction];
+  this->times[reaction] = time;
+  if (time < previous) {
+    siftUp(this->position[reaction]);
+  } else if (time > previous) {
+    siftDown(this->position[reaction]);
+  }
+}
+
+void IndexedPriorityQueue::swap(unsigned int i, unsigned int j) {
+  auto a = this->heap[i];
+  auto b = this->heap[j];
+  this->heap[i] = b;
+  this->heap[j] = a;
+  this->position[a] = j;
+  this->position[b] = i;
+}
+
+void IndexedPriorityQueue::siftUp(unsigned int i) {
+  while (i > 0) {
+    auto parent = (i - 1) / 2;
+    if (!(this->times[this->heap[i]] < this->times[this->heap[parent]])) {
+      break;
+    }
+    swap(i, parent);
+    i = parent;
+  }
+}
+
+void IndexedPriorityQueue::siftDown(unsigned int i) {
+  auto n = this->heap.size();
+  while (true) {
+    auto smallest = i;
+    auto left = 2 * i + 1;
+    auto right = left + 1;
+    if (left < n && this->times[this->heap[left]] < this->times[this->heap[smallest]]) {
+      smallest = left;
+    }
+    if (right < n && this->times[this->heap[right]] < this->times[this->heap[smallest]]) {
+      smallest = right;
+    }
+    if (smallest == i) {
+      break;
+    }
+    swap(i, smallest);
+    i = smallest;
+  }
+}
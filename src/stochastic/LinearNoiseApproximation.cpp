@@ -0,0 +1,100 @@
+#include "sbmlsim/internal/stochastic/LinearNoiseApproximation.h"
+#include <algorithm>
+#include <boost/numeric/ublas/matrix_proxy.hpp>
+#include "sbmlsim/internal/util/RuntimeExceptionUtil.h"
+
+LinearNoiseApproximation::LinearNoiseApproximation(SBMLSystem &system, JacobianMethod jacobianMethod)
+    : system(&system), jacobi(system, jacobianMethod), network(system), numStates(system.getInitialState().size()),
+      x(numStates), f(numStates), covariance(numStates, numStates), product(numStates, numStates),
+      diffusion(numStates, numStates) {
+  if (system.getNumEvents() > 0) {
+    RuntimeExceptionUtil::throwUnsupportedFeatureException("events in the linear noise approximation");
+  }
+}
+
+LinearNoiseApproximation::LinearNoiseApproximation(const LinearNoiseApproximation &lna)
+    : system(lna.system), jacobi(lna.jacobi), network(lna.network), numStates(lna.numStates), x(lna.x), f(lna.f),
+      covariance(lna.covariance), product(lna.product), diffusion(lna.diffusion) {
+  // nothing to do
+}
+
+LinearNoiseApproximation::~LinearNoiseApproximation() {
+  // nothing to do
+}
+
+void LinearNoiseApproximation::operator()(const state &y, state &dydt, double t) {
+  auto n = this->numStates;
+  std::copy(y.begin(), y.begin() + n, this->x.begin());
+  this->system->handleAssignmentRule(this->x, t);
+
+  // mean
+  (*this->system)(this->x, this->f, t);
+  std::copy(this->f.begin(), this->f.end(), dydt.begin());
+
+  // J Sigma over the non-zeros of J
+  getCovariance(y, this->covariance);
+  this->jacobi.evaluate(this->x, t);
+  auto &rowPointers = this->jacobi.getRowPointers();
+  auto &columnIndices = this->jacobi.getColumnIndices();
+  auto &values = this->jacobi.getValues();
+  this->product.clear();
+  for (unsigned int i = 0; i < n; i++) {
+    for (auto p = rowPointers[i]; p < rowPointers[i + 1]; p++) {
+      ublas::row(this->product, i) += values[p] * ublas::row(this->covariance, columnIndices[p]);
+    }
+  }
+
+  // D = sum_j a_j v_j v_j^T
+  this->diffusion.clear();
+  for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+    double a = this->network.evaluatePropensity(j, this->x, t);
+    if (a == 0.0) {
+      continue;
+    }
+    auto &changes = this->network.getStateChanges(j);
+    for (auto &p : changes) {
+      for (auto &q : changes) {
+        this->diffusion(p.index, q.index) += a * p.delta * q.delta;
+      }
+    }
+  }
+
+  // Sigma J^T = (J Sigma)^T
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int k = i; k < n; k++) {
+      dydt[getCovarianceIndex(i, k)] = this->product(i, k) + this->product(k, i) + this->diffusion(i, k);
+    }
+  }
+}
+
+unsigned int LinearNoiseApproximation::getNumStates() const {
+  return this->numStates + this->numStates * (this->numStates + 1) / 2;
+}
+
+LinearNoiseApproximation::state LinearNoiseApproximation::createInitialState(const state &x) const {
+  state y(getNumStates());
+  y.clear();
+  std::copy(x.begin(), x.end(), y.begin());
+  return y;
+}
+
+void LinearNoiseApproximation::getMean(const state &y, state &x) const {
+  x.resize(this->numStates);
+  std::copy(y.begin(), y.begin() + this->numStates, x.begin());
+}
+
+void LinearNoiseApproximation::getCovariance(const state &y, matrix &covariance) const {
+  covariance.resize(this->numStates, this->numStates, false);
+  for (unsigned int i = 0; i < this->numStates; i++) {
+    for (unsigned int k = i; k < this->numStates; k++) {
+      covariance(i, k) = covariance(k, i) = y[getCovarianceIndex(i, k)];
+    }
+  }
+}
+
+unsigned int LinearNoiseApproximation::getCovarianceIndex(unsigned int i, unsigned int k) const {
+  if (i > k) {
+    std::swap(i, k);
+  }
+  return this->numStates + i * this->numStates - i * (i - 1) / 2 + (k - i);
+}
@@ -0,0 +1,110 @@
+#include "sbmlsim/internal/stochastic/NextReactionSimulator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+NextReactionSimulator::NextReactionSimulator(SBMLSystem &system, unsigned long seed)
+    : network(system), queue(network.getNumReactions()), propensities(network.getNumReactions(), 0.0),
+      engine(seed), hasEvents(system.getNumEvents() > 0), numFirings(0) {
+  // nothing to do
+}
+
+NextReactionSimulator::NextReactionSimulator(const NextReactionSimulator &simulator)
+    : network(simulator.network), queue(simulator.queue), propensities(simulator.propensities),
+      engine(simulator.engine), hasEvents(simulator.hasEvents), previous(simulator.previous),
+      numFirings(simulator.numFirings) {
+  // nothing to do
+}
+
+NextReactionSimulator::~NextReactionSimulator() {
+  // nothing to do
+}
+
+void NextReactionSimulator::initialize(const state &x, double t) {
+  resetReactions(x, t);
+}
+
+/*
+ * Same contract as SSASimulator::step. The putative times stay valid when the limit is reached first, so
+ * nothing is redrawn at sample times or at scheduled events that leave the state alone.
+ */
+bool NextReactionSimulator::step(state &x, double &t, double until) {
+  double limit = this->network.getStepLimit(t, until);
+  if (this->queue.size() == 0 || this->queue.getTime(this->queue.top()) > limit) {
+    t = limit;
+    handleEvent(x, t);
+    return t < until;
+  }
+
+  auto reaction = this->queue.top();
+  t = this->queue.getTime(reaction);
+  this->network.fire(reaction, x, t);
+  this->numFirings++;
+  for (auto j : this->network.getDependents(reaction)) {
+    if (j != reaction) {
+      updateReaction(j, x, t);
+    }
+  }
+  for (auto j : this->network.getVolatileReactions()) {
+    if (j != reaction) {
+      updateReaction(j, x, t);
+    }
+  }
+  // the fired reaction always needs a fresh time
+  this->propensities[reaction] = this->network.evaluatePropensity(reaction, x, t);
+  this->queue.update(reaction, drawFiringTime(this->propensities[reaction], t));
+  handleEvent(x, t);
+  return true;
+}
+
+// switches to stream of the seed, e.g. the index of a trajectory in an ensemble
+void NextReactionSimulator::setStream(unsigned long stream) {
+  this->engine.setStream(stream);
+}
+
+unsigned long NextReactionSimulator::getNumFirings() const {
+  return this->numFirings;
+}
+
+double NextReactionSimulator::drawFiringTime(double propensity, double t) {
+  if (propensity <= 0.0) {
+    return std::numeric_limits<double>::infinity();
+  }
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  return t - std::log(1.0 - uniform(this->engine)) / propensity;
+}
+
+// tau_new = t + (a_old / a_new) * (tau_old - t), reusing the random number behind tau_old
+void NextReactionSimulator::updateReaction(unsigned int reaction, const state &x, double t) {
+  double before = this->propensities[reaction];
+  double after = this->network.evaluatePropensity(reaction, x, t);
+  this->propensities[reaction] = after;
+  double time;
+  if (after <= 0.0) {
+    time = std::numeric_limits<double>::infinity();
+  } else if (before > 0.0) {
+    time = t + (before / after) * (this->queue.getTime(reaction) - t);
+  } else {
+    time = drawFiringTime(after, t);
+  }
+  this->queue.update(reaction, time);
+}
+
+void NextReactionSimulator::resetReactions(const state &x, double t) {
+  for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+    this->propensities[j] = this->network.evaluatePropensity(j, x, t);
+    this->queue.update(j, drawFiringTime(this->propensities[j], t));
+  }
+}
+
+void NextReactionSimulator::handleEvent(state &x, double t) {
+  if (!this->hasEvents) {
+    return;
+  }
+  this->previous = x;
+  this->network.getSystem().handleEvent(x, t);
+  if (!std::equal(x.begin(), x.end(), this->previous.begin())) {
+    resetReactions(x, t);
+  }
+}
@@ -0,0 +1,84 @@
+#include "sbmlsim/internal/stochastic/Philox4x32.h"
+
+namespace {
+
+const std::uint32_t MULTIPLIER_0 = 0xD2511F53;
+const std::uint32_t MULTIPLIER_1 = 0xCD9E8D57;
+const std::uint32_t WEYL_0 = 0x9E3779B9;  // golden ratio
+const std::uint32_t WEYL_1 = 0xBB67AE85;  // sqrt(3) - 1
+const unsigned int NUM_ROUNDS = 10;
+
+}  // namespace
+
+Philox4x32::Philox4x32(std::uint64_t seed, std::uint64_t stream)
+    : stream(stream), counter(0), position(2) {
+  this->key[0] = static_cast<std::uint32_t>(seed);
+  this->key[1] = static_cast<std::uint32_t>(seed >> 32);
+  this->output.fill(0);
+}
+
+Philox4x32::Philox4x32(const Philox4x32 &engine)
+    : key(engine.key), stream(engine.stream), counter(engine.counter), output(engine.output),
+      position(engine.position) {
+  // nothing to do
+}
+
+Philox4x32::~Philox4x32() {
+  // nothing to do
+}
+
+// restarts at the first block of stream
+void Philox4x32::setStream(std::uint64_t stream) {
+  this->stream = stream;
+  this->counter = 0;
+  this->position = this->output.size();
+}
+
+std::uint64_t Philox4x32::getStream() const {
+  return this->stream;
+}
+
+void Philox4x32::discard(unsigned long long n) {
+  unsigned long long available = this->output.size() - this->position;
+  if (n < available) {
+    this->position += n;
+    return;
+  }
+  n -= available;
+  this->counter += n / this->output.size();
+  this->position = this->output.size();
+  if (n % this->output.size() != 0) {
+    generate();
+    this->position = n % this->output.size();
+  }
+}
+
+Philox4x32::counter_type Philox4x32::generateBlock(counter_type counter, key_type key) {
+  for (unsigned int round = 0; round < NUM_ROUNDS; round++) {
+    if (round > 0) {
+      key[0] += WEYL_0;
+      key[1] += WEYL_1;
+    }
+    std::uint64_t product0 = static_cast<std::uint64_t>(MULTIPLIER_0) * counter[0];
+    std::uint64_t product1 = static_cast<std::uint64_t>(MULTIPLIER_1) * counter[2];
+    counter = {{
+        static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+        static_cast<std::uint32_t>(product1),
+        static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+        static_cast<std::uint32_t>(product0)
+    }};
+  }
+  return counter;
+}
+
+void Philox4x32::generate() {
+  counter_type block = {{
+      static_cast<std::uint32_t>(this->counter), static_cast<std::uint32_t>(this->counter >> 32),
+      static_cast<std::uint32_t>(this->stream), static_cast<std::uint32_t>(this->stream >> 32)
+  }};
+  block = generateBlock(block, this->key);
+  this->output[0] = (static_cast<result_type>(block[1]) << 32) | block[0];
+  this->output[1] = (static_cast<result_type>(block[3]) << 32) | block[2];
+  this->counter++;
+  this->position = 0;
+}
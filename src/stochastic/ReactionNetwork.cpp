@@ -0,0 +1,175 @@
+#include "sbmlsim/internal/stochastic/ReactionNetwork.h"
+#include <algorithm>
+#include <set>
+#include "sbmlsim/internal/util/RuntimeExceptionUtil.h"
+
+ReactionNetwork::ReactionNetwork(SBMLSystem &system) : system(&system) {
+  auto &kineticLaws = system.getKineticLaws();
+  auto numReactions = kineticLaws.size();
+  auto numStates = system.getInitialState().size();
+
+  if (!system.getRateRules().empty()) {
+    RuntimeExceptionUtil::throwUnsupportedFeatureException("rate rules in a stochastic simulation");
+  }
+  for (auto i = 0; i < numReactions; i++) {
+    if (system.getModel()->getReactions()[i].isReversible()) {
+      RuntimeExceptionUtil::throwUnsupportedFeatureException("reversible reactions in a stochastic simulation");
+    }
+    for (auto &expression : system.getReactantStoichiometries()[i]) {
+      if (!expression.empty()) {
+        RuntimeExceptionUtil::throwUnsupportedFeatureException("stoichiometryMath in a stochastic simulation");
+      }
+    }
+    for (auto &expression : system.getProductStoichiometries()[i]) {
+      if (!expression.empty()) {
+        RuntimeExceptionUtil::throwUnsupportedFeatureException("stoichiometryMath in a stochastic simulation");
+      }
+    }
+  }
+
+  // columns of the stoichiometry matrix
+  auto &matrix = system.getStoichiometryMatrix();
+  auto &rowPointers = matrix.getRowPointers();
+  auto &columnIndices = matrix.getColumnIndices();
+  auto &values = matrix.getValues();
+  this->changes.resize(numReactions);
+  for (auto row = 0; row < matrix.getNumRows(); row++) {
+    for (auto k = rowPointers[row]; k < rowPointers[row + 1]; k++) {
+      if (values[k] != 0.0) {
+        StateChange change = {static_cast<unsigned int>(row), values[k]};
+        this->changes[columnIndices[k]].push_back(change);
+      }
+    }
+  }
+
+  // reactants as written, for the order of each reaction
+  auto &reactions = system.getModel()->getReactions();
+  this->reactants.resize(numReactions);
+  for (auto j = 0; j < numReactions; j++) {
+    for (auto &reactant : reactions[j].getReactants()) {
+      StateChange entry = {system.getStateIndexForVariable(reactant.getSpeciesId()), reactant.getStoichiometry()};
+      this->reactants[j].push_back(entry);
+    }
+  }
+
+  // state variables fed by assignment rules change without a reaction firing
+  std::vector<bool> ruleTargets(numStates, false);
+  for (auto &target : system.getAssignmentRuleTargets()) {
+    if (target.type != SymbolType::CONSTANT) {
+      ruleTargets[target.index] = true;
+    }
+  }
+  this->hasAssignmentRules = !system.getAssignmentRules().empty();
+
+  // readers of every state variable
+  std::vector<std::vector<unsigned int> > readers(numStates);
+  unsigned int stackSize = 0;
+  for (unsigned int j = 0; j < numReactions; j++) {
+    std::set<unsigned int> reads;
+    bool readsTime = false;
+    SBMLSystem::collectReads(kineticLaws[j], reads, readsTime);
+    bool isVolatile = readsTime;
+    for (auto index : reads) {
+      readers[index].push_back(j);
+      isVolatile = isVolatile || ruleTargets[index];
+    }
+    if (isVolatile) {
+      this->volatileReactions.push_back(j);
+    }
+    stackSize = std::max(stackSize, kineticLaws[j].getStackSize());
+  }
+  this->stack.resize(stackSize);
+
+  std::vector<bool> volatileReaction(numReactions, false);
+  for (auto j : this->volatileReactions) {
+    volatileReaction[j] = true;
+  }
+  this->dependents.resize(numReactions);
+  for (auto j = 0; j < numReactions; j++) {
+    std::set<unsigned int> affected;
+    for (auto &change : this->changes[j]) {
+      for (auto k : readers[change.index]) {
+        if (!volatileReaction[k]) {
+          affected.insert(k);
+        }
+      }
+    }
+    this->dependents[j].assign(affected.begin(), affected.end());
+  }
+}
+
+ReactionNetwork::ReactionNetwork(const ReactionNetwork &network)
+    : system(network.system), changes(network.changes), reactants(network.reactants), dependents(network.dependents),
+      volatileReactions(network.volatileReactions), hasAssignmentRules(network.hasAssignmentRules),
+      stack(network.stack) {
+  // nothing to do
+}
+
+ReactionNetwork::~ReactionNetwork() {
+  // nothing to do
+}
+
+unsigned int ReactionNetwork::getNumReactions() const {
+  return this->changes.size();
+}
+
+// the kinetic law as it is, which may be negative
+double ReactionNetwork::evaluateRate(unsigned int reaction, const state &x, double t) {
+  return this->system->getKineticLaws()[reaction].evaluate(
+      x.data().begin(), this->system->getConstants().data(), t, this->stack.data());
+}
+
+// a negative rate has no meaning as a propensity, so the model cannot be simulated stochastically
+double ReactionNetwork::evaluatePropensity(unsigned int reaction, const state &x, double t) {
+  double a = evaluateRate(reaction, x, t);
+  if (a < 0.0) {
+    RuntimeExceptionUtil::throwUnsupportedFeatureException("negative propensity in a stochastic simulation");
+  }
+  return a;
+}
+
+void ReactionNetwork::fire(unsigned int reaction, state &x, double t) {
+  applyStateChanges(reaction, 1.0, x);
+  applyAssignmentRules(x, t);
+}
+
+// count firings of reaction at once, without the assignment rules
+void ReactionNetwork::applyStateChanges(unsigned int reaction, double count, state &x) const {
+  for (auto &change : this->changes[reaction]) {
+    x[change.index] += count * change.delta;
+  }
+}
+
+void ReactionNetwork::applyAssignmentRules(state &x, double t) {
+  if (this->hasAssignmentRules) {
+    this->system->handleAssignmentRule(x, t);
+  }
+}
+
+/*
+ * until, or the next scheduled event time if it comes first: a step must not jump over an event whose
+ * assignments change the propensities. An event due at t itself gives t.
+ */
+double ReactionNetwork::getStepLimit(double t, double until) const {
+  return std::min(until, std::max(t, this->system->getNextScheduledTime()));
+}
+
+const std::vector<StateChange> &ReactionNetwork::getStateChanges(unsigned int reaction) const {
+  return this->changes[reaction];
+}
+
+const std::vector<StateChange> &ReactionNetwork::getReactants(unsigned int reaction) const {
+  return this->reactants[reaction];
+}
+
+const std::vector<unsigned int> &ReactionNetwork::getDependents(unsigned int reaction) const {
+  return this->dependents[reaction];
+}
+
+const std::vector<unsigned int> &ReactionNetwork::getVolatileReactions() const {
+  return this->volatileReactions;
+}
+
+SBMLSystem &ReactionNetwork::getSystem() const {
+  return *this->system;
+}
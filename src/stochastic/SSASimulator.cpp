@@ -0,0 +1,83 @@
+#include "sbmlsim/internal/stochastic/SSASimulator.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+SSASimulator::SSASimulator(SBMLSystem &system, unsigned long seed)
+    : network(system), sampler(network.getNumReactions()), engine(seed), hasEvents(system.getNumEvents() > 0),
+      numFirings(0) {
+  // nothing to do
+}
+
+SSASimulator::SSASimulator(const SSASimulator &simulator)
+    : network(simulator.network), sampler(simulator.sampler), engine(simulator.engine),
+      hasEvents(simulator.hasEvents), previous(simulator.previous), numFirings(simulator.numFirings) {
+  // nothing to do
+}
+
+SSASimulator::~SSASimulator() {
+  // nothing to do
+}
+
+void SSASimulator::initialize(const state &x, double t) {
+  updateAllPropensities(x, t);
+}
+
+/*
+ * Fires the next reaction if it happens no later than until and returns true; otherwise advances t to until
+ * and returns false. A scheduled event before until is a stop of its own: t advances to it, the event is
+ * executed and true is returned. By the memorylessness of the exponential distribution nothing is lost by
+ * discarding the sampled waiting time at such a stop.
+ */
+bool SSASimulator::step(state &x, double &t, double until) {
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double limit = this->network.getStepLimit(t, until);
+  double total = this->sampler.getTotal();
+  double tau = total > 0.0 ? -std::log(1.0 - uniform(this->engine)) / total : limit - t;
+  if (total <= 0.0 || t + tau > limit) {
+    t = limit;
+    handleEvent(x, t);
+    return t < until;
+  }
+
+  t += tau;
+  auto reaction = this->sampler.select(this->engine);
+  this->network.fire(reaction, x, t);
+  this->numFirings++;
+  updatePropensities(this->network.getDependents(reaction), x, t);
+  updatePropensities(this->network.getVolatileReactions(), x, t);
+  handleEvent(x, t);
+  return true;
+}
+
+// switches to stream of the seed, e.g. the index of a trajectory in an ensemble
+void SSASimulator::setStream(unsigned long stream) {
+  this->engine.setStream(stream);
+}
+
+unsigned long SSASimulator::getNumFirings() const {
+  return this->numFirings;
+}
+
+void SSASimulator::updatePropensities(const std::vector<unsigned int> &reactions, const state &x, double t) {
+  for (auto j : reactions) {
+    this->sampler.update(j, this->network.evaluatePropensity(j, x, t));
+  }
+}
+
+void SSASimulator::updateAllPropensities(const state &x, double t) {
+  for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+    this->sampler.update(j, this->network.evaluatePropensity(j, x, t));
+  }
+}
+
+void SSASimulator::handleEvent(state &x, double t) {
+  if (!this->hasEvents) {
+    return;
+  }
+  this->previous = x;
+  this->network.getSystem().handleEvent(x, t);
+  if (!std::equal(x.begin(), x.end(), this->previous.begin())) {
+    updateAllPropensities(x, t);
+  }
+}
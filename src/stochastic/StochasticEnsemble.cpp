@@ -0,0 +1,90 @@
+#include "sbmlsim/internal/stochastic/StochasticEnsemble.h"
+
+const unsigned long StochasticEnsemble::MAX_BLOCKS;
+
+StochasticEnsemble::StochasticEnsemble(const SBMLSystem &system, const std::vector<ObserveTarget> &targets,
+                                       unsigned int numThreads)
+    : prototype(system), targets(targets), constants(system.getConstants()), pool(numThreads) {
+  // nothing to do
+}
+
+StochasticEnsemble::~StochasticEnsemble() {
+  // nothing to do
+}
+
+unsigned int StochasticEnsemble::getNumThreads() const {
+  return this->pool.getNumThreads();
+}
+
+// initial assignments and rules are evaluated once, on the calling thread
+StochasticEnsemble::state StochasticEnsemble::prepareInitialState(double start) {
+  SBMLSystem system(this->prototype);
+  auto x = system.getInitialState();
+  system.handleInitialAssignment(x, start);
+  system.handleAssignmentRule(x, start);
+  return x;
+}
+
+void StochasticEnsemble::observe(const state &x, std::vector<double> &values) const {
+  for (auto i = 0; i < this->targets.size(); i++) {
+    auto index = this->targets[i].getStateIndex();
+    values[i] = this->targets[i].isConstant() ? this->constants[index] : x[index];
+  }
+}
+
+EnsembleStatistics StochasticEnsemble::reduce(std::vector<Accumulator> &blocks, unsigned long numSamples,
+                                              double start, double interval) const {
+  Accumulator total;
+  total.reset(numSamples * this->targets.size());
+  for (auto &block : blocks) {
+    total.merge(block);
+  }
+
+  EnsembleStatistics statistics;
+  statistics.numTrajectories = total.count;
+  for (auto &target : this->targets) {
+    statistics.ids.push_back(target.getId());
+  }
+  for (unsigned long k = 0; k < numSamples; k++) {
+    statistics.times.push_back(start + k * interval);
+    auto begin = k * this->targets.size();
+    auto end = begin + this->targets.size();
+    statistics.means.push_back(std::vector<double>(total.mean.begin() + begin, total.mean.begin() + end));
+    std::vector<double> variances;
+    for (auto i = begin; i < end; i++) {
+      variances.push_back(total.count > 1 ? total.m2[i] / (total.count - 1) : 0.0);
+    }
+    statistics.variances.push_back(variances);
+  }
+  return statistics;
+}
+
+void StochasticEnsemble::Accumulator::reset(std::size_t size) {
+  this->count = 0;
+  this->mean.assign(size, 0.0);
+  this->m2.assign(size, 0.0);
+}
+
+// count must already include the trajectory of values
+void StochasticEnsemble::Accumulator::add(unsigned long sample, const std::vector<double> &values) {
+  auto offset = sample * values.size();
+  for (auto i = 0; i < values.size(); i++) {
+    double delta = values[i] - this->mean[offset + i];
+    this->mean[offset + i] += delta / this->count;
+    this->m2[offset + i] += delta * (values[i] - this->mean[offset + i]);
+  }
+}
+
+// Chan, Golub and LeVeque's pairwise update
+void StochasticEnsemble::Accumulator::merge(const Accumulator &other) {
+  if (other.count == 0) {
+    return;
+  }
+  double n = this->count + other.count;
+  for (auto i = 0; i < this->mean.size(); i++) {
+    double delta = other.mean[i] - this->mean[i];
+    this->mean[i] += delta * other.count / n;
+    this->m2[i] += other.m2[i] + delta * delta * this->count * other.count / n;
+  }
+  this->count += other.count;
+}
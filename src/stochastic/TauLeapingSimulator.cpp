@@ -0,0 +1,306 @@
+#include "sbmlsim/internal/stochastic/TauLeapingSimulator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+TauLeapingSimulator::TauLeapingSimulator(SBMLSystem &system, unsigned long seed, double epsilon)
+    : network(system), sampler(network.getNumReactions()), engine(seed), epsilon(epsilon),
+      hasEvents(system.getNumEvents() > 0), exactStepsLeft(0), numFirings(0), numLeaps(0), numExactSteps(0) {
+  auto numStates = system.getInitialState().size();
+  auto numReactions = this->network.getNumReactions();
+  this->highestOrder.assign(numStates, 0);
+  this->highestOrderStoichiometry.assign(numStates, 0.0);
+  this->firingsLeft.assign(numReactions, 0.0);
+  this->critical.assign(numReactions, false);
+  this->mean.assign(numStates, 0.0);
+  this->variance.assign(numStates, 0.0);
+  this->reactantOfNonCritical.assign(numStates, false);
+
+  // order of a reaction: the sum of its reactant stoichiometries, as for mass action
+  for (unsigned int j = 0; j < numReactions; j++) {
+    double order = 0.0;
+    for (auto &reactant : this->network.getReactants(j)) {
+      order += reactant.delta;
+    }
+    for (auto &reactant : this->network.getReactants(j)) {
+      auto i = reactant.index;
+      auto rounded = static_cast<unsigned int>(std::lround(order));
+      if (rounded > this->highestOrder[i]
+          || (rounded == this->highestOrder[i] && reactant.delta > this->highestOrderStoichiometry[i])) {
+        this->highestOrder[i] = rounded;
+        this->highestOrderStoichiometry[i] = reactant.delta;
+      }
+    }
+  }
+}
+
+TauLeapingSimulator::TauLeapingSimulator(const TauLeapingSimulator &simulator)
+    : network(simulator.network), sampler(simulator.sampler), engine(simulator.engine), epsilon(simulator.epsilon),
+      hasEvents(simulator.hasEvents), highestOrder(simulator.highestOrder),
+      highestOrderStoichiometry(simulator.highestOrderStoichiometry), firingsLeft(simulator.firingsLeft),
+      critical(simulator.critical), mean(simulator.mean), variance(simulator.variance),
+      reactantOfNonCritical(simulator.reactantOfNonCritical), trial(simulator.trial), previous(simulator.previous),
+      exactStepsLeft(simulator.exactStepsLeft), numFirings(simulator.numFirings), numLeaps(simulator.numLeaps),
+      numExactSteps(simulator.numExactSteps) {
+  // nothing to do
+}
+
+TauLeapingSimulator::~TauLeapingSimulator() {
+  // nothing to do
+}
+
+void TauLeapingSimulator::initialize(const state &x, double t) {
+  updateAllPropensities(x, t);
+  this->exactStepsLeft = 0;
+}
+
+// same contract as SSASimulator::step, a leap counting as one step; leaps end at scheduled events
+bool TauLeapingSimulator::step(state &x, double &t, double until) {
+  double limit = this->network.getStepLimit(t, until);
+  if (this->sampler.getTotal() <= 0.0) {
+    t = limit;
+    handleEvent(x, t);
+    return t < until;
+  }
+  if (this->exactStepsLeft > 0) {
+    this->exactStepsLeft--;
+    return exactStep(x, t, limit) || t < until;
+  }
+  return leap(x, t, limit) || t < until;
+}
+
+// switches to stream of the seed, e.g. the index of a trajectory in an ensemble
+void TauLeapingSimulator::setStream(unsigned long stream) {
+  this->engine.setStream(stream);
+}
+
+unsigned long TauLeapingSimulator::getNumFirings() const {
+  return this->numFirings;
+}
+
+unsigned long TauLeapingSimulator::getNumLeaps() const {
+  return this->numLeaps;
+}
+
+unsigned long TauLeapingSimulator::getNumExactSteps() const {
+  return this->numExactSteps;
+}
+
+bool TauLeapingSimulator::exactStep(state &x, double &t, double until) {
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double tau = -std::log(1.0 - uniform(this->engine)) / this->sampler.getTotal();
+  if (t + tau > until) {
+    t = until;
+    handleEvent(x, t);
+    return false;
+  }
+
+  t += tau;
+  auto reaction = this->sampler.select(this->engine);
+  this->network.fire(reaction, x, t);
+  this->numFirings++;
+  this->numExactSteps++;
+  for (auto j : this->network.getDependents(reaction)) {
+    this->sampler.update(j, this->network.evaluatePropensity(j, x, t));
+  }
+  for (auto j : this->network.getVolatileReactions()) {
+    this->sampler.update(j, this->network.evaluatePropensity(j, x, t));
+  }
+  handleEvent(x, t);
+  return true;
+}
+
+bool TauLeapingSimulator::leap(state &x, double &t, double until) {
+  auto numReactions = this->network.getNumReactions();
+  double total = this->sampler.getTotal();
+
+  // critical reactions and the sum of their propensities
+  double criticalTotal = 0.0;
+  for (unsigned int j = 0; j < numReactions; j++) {
+    double left = std::numeric_limits<double>::infinity();
+    for (auto &change : this->network.getStateChanges(j)) {
+      if (change.delta < 0.0) {
+        left = std::min(left, std::floor(x[change.index] / -change.delta));
+      }
+    }
+    this->firingsLeft[j] = left;
+    this->critical[j] = this->sampler.getPropensity(j) > 0.0 && left < CRITICAL_FIRINGS;
+    if (this->critical[j]) {
+      criticalTotal += this->sampler.getPropensity(j);
+    }
+  }
+
+  double nonCriticalTau = selectLeapTime(x);
+  if (nonCriticalTau < EXACT_THRESHOLD / total) {
+    // leaping would not pay off
+    return startExactSteps(x, t, until);
+  }
+
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double criticalTau = criticalTotal > 0.0
+                       ? -std::log(1.0 - uniform(this->engine)) / criticalTotal
+                       : std::numeric_limits<double>::infinity();
+  while (true) {
+    double tau = std::min(nonCriticalTau, criticalTau);
+    bool fireCritical = criticalTau <= nonCriticalTau;
+    bool reachesLimit = t + tau >= until;
+    if (reachesLimit) {
+      tau = until - t;
+      fireCritical = false;
+    }
+
+    this->trial = x;
+    unsigned long firings = 0;
+    for (unsigned int j = 0; j < numReactions; j++) {
+      if (this->critical[j] || this->sampler.getPropensity(j) <= 0.0) {
+        continue;
+      }
+      double k = drawFirings(j, tau);
+      this->network.applyStateChanges(j, k, this->trial);
+      firings += static_cast<unsigned long>(k);
+    }
+    if (fireCritical) {
+      // one critical reaction, chosen in proportion to its propensity
+      double target = uniform(this->engine) * criticalTotal;
+      unsigned int chosen = numReactions;
+      for (unsigned int j = 0; j < numReactions; j++) {
+        if (!this->critical[j]) {
+          continue;
+        }
+        chosen = j;
+        target -= this->sampler.getPropensity(j);
+        if (target < 0.0) {
+          break;
+        }
+      }
+      this->network.applyStateChanges(chosen, 1.0, this->trial);
+      firings++;
+    }
+
+    // only amounts the leap drove below zero count; other variables may well be negative
+    bool negative = false;
+    for (unsigned int i = 0; i < x.size(); i++) {
+      negative = negative || (this->trial[i] < 0.0 && x[i] >= 0.0);
+    }
+    if (negative) {
+      // nor would it once the halved tau drops below the threshold
+      nonCriticalTau *= 0.5;
+      if (nonCriticalTau < EXACT_THRESHOLD / total) {
+        return startExactSteps(x, t, until);
+      }
+      continue;
+    }
+
+    x.swap(this->trial);
+    t = reachesLimit ? until : t + tau;
+    this->network.applyAssignmentRules(x, t);
+    this->numFirings += firings;
+    this->numLeaps++;
+    updateAllPropensities(x, t);
+    handleEvent(x, t);
+    return !reachesLimit;
+  }
+}
+
+bool TauLeapingSimulator::startExactSteps(state &x, double &t, double until) {
+  this->exactStepsLeft = EXACT_STEPS - 1;
+  return exactStep(x, t, until);
+}
+
+/*
+ * tau = min_i min(max(epsilon x_i / g_i, 1) / |mu_i|, max(epsilon x_i / g_i, 1)^2 / sigma_i^2) over the
+ * reactants of non-critical reactions, mu_i and sigma_i^2 being the expected change of x_i per unit time
+ * and its variance.
+ */
+double TauLeapingSimulator::selectLeapTime(const state &x) {
+  std::fill(this->mean.begin(), this->mean.end(), 0.0);
+  std::fill(this->variance.begin(), this->variance.end(), 0.0);
+  std::fill(this->reactantOfNonCritical.begin(), this->reactantOfNonCritical.end(), false);
+  for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+    double a = this->sampler.getPropensity(j);
+    if (this->critical[j] || a <= 0.0) {
+      continue;
+    }
+    for (auto &change : this->network.getStateChanges(j)) {
+      this->mean[change.index] += change.delta * a;
+      this->variance[change.index] += change.delta * change.delta * a;
+    }
+    for (auto &reactant : this->network.getReactants(j)) {
+      this->reactantOfNonCritical[reactant.index] = true;
+    }
+  }
+
+  double tau = std::numeric_limits<double>::infinity();
+  for (unsigned int i = 0; i < x.size(); i++) {
+    if (!this->reactantOfNonCritical[i]) {
+      continue;
+    }
+    // g_i of Cao et al., from the highest order reaction consuming x_i
+    double g;
+    double xi = x[i];
+    double stoichiometry = this->highestOrderStoichiometry[i];
+    switch (this->highestOrder[i]) {
+      case 0:
+      case 1:
+        g = 1.0;
+        break;
+      case 2:
+        g = stoichiometry >= 2.0 && xi > 1.0 ? 2.0 + 1.0 / (xi - 1.0) : 2.0;
+        break;
+      case 3:
+        if (stoichiometry >= 3.0 && xi > 2.0) {
+          g = 3.0 + 1.0 / (xi - 1.0) + 2.0 / (xi - 2.0);
+        } else if (stoichiometry >= 2.0 && xi > 1.0) {
+          g = 1.5 * (2.0 + 1.0 / (xi - 1.0));
+        } else {
+          g = 3.0;
+        }
+        break;
+      default:
+        g = this->highestOrder[i];
+        break;
+    }
+    double bound = std::max(this->epsilon * xi / g, 1.0);
+    if (this->mean[i] != 0.0) {
+      tau = std::min(tau, bound / std::fabs(this->mean[i]));
+    }
+    if (this->variance[i] > 0.0) {
+      tau = std::min(tau, bound * bound / this->variance[i]);
+    }
+  }
+  return tau;
+}
+
+// binomial when the reaction can only fire L_j more times, Poisson otherwise
+double TauLeapingSimulator::drawFirings(unsigned int reaction, double tau) {
+  double expected = this->sampler.getPropensity(reaction) * tau;
+  if (expected <= 0.0) {
+    return 0.0;
+  }
+  double left = this->firingsLeft[reaction];
+  if (std::isinf(left)) {
+    std::poisson_distribution<unsigned long> poisson(expected);
+    return poisson(this->engine);
+  }
+  std::binomial_distribution<unsigned long> binomial(static_cast<unsigned long>(left),
+                                                     std::min(1.0, expected / left));
+  return binomial(this->engine);
+}
+
+void TauLeapingSimulator::updateAllPropensities(const state &x, double t) {
+  for (unsigned int j = 0; j < this->network.getNumReactions(); j++) {
+    this->sampler.update(j, this->network.evaluatePropensity(j, x, t));
+  }
+}
+
+void TauLeapingSimulator::handleEvent(state &x, double t) {
+  if (!this->hasEvents) {
+    return;
+  }
+  this->previous = x;
+  this->network.getSystem().handleEvent(x, t);
+  if (!std::equal(x.begin(), x.end(), this->previous.begin())) {
+    updateAllPropensities(x, t);
+  }
+}
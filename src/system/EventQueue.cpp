@@ -0,0 +1,64 @@
+#include "sbmlsim/internal/system/EventQueue.h"
+#include <limits>
+#include <utility>
+
+EventQueue::EventQueue() : sequence(0) {
+  // nothing to do
+}
+
+EventQueue::EventQueue(unsigned int numEvents) : generations(numEvents, 0), sequence(0) {
+  // nothing to do
+}
+
+EventQueue::EventQueue(const EventQueue &queue)
+    : queue(queue.queue), generations(queue.generations), sequence(queue.sequence) {
+  // nothing to do
+}
+
+EventQueue::~EventQueue() {
+  // nothing to do
+}
+
+void EventQueue::schedule(double time, unsigned int event, std::vector<double> values) {
+  ScheduledEvent scheduled;
+  scheduled.time = time;
+  scheduled.event = event;
+  scheduled.sequence = this->sequence++;
+  scheduled.generation = this->generations[event];
+  scheduled.values = std::move(values);
+  this->queue.push(std::move(scheduled));
+}
+
+void EventQueue::cancel(unsigned int event) {
+  this->generations[event]++;
+}
+
+bool EventQueue::isCancelled(const ScheduledEvent &scheduled) const {
+  return scheduled.generation != this->generations[scheduled.event];
+}
+
+bool EventQueue::empty() {
+  discardCancelled();
+  return this->queue.empty();
+}
+
+double EventQueue::getNextTime() {
+  discardCancelled();
+  if (this->queue.empty()) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return this->queue.top().time;
+}
+
+ScheduledEvent EventQueue::pop() {
+  discardCancelled();
+  ScheduledEvent scheduled = this->queue.top();
+  this->queue.pop();
+  return scheduled;
+}
+
+void EventQueue::discardCancelled() {
+  while (!this->queue.empty() && isCancelled(this->queue.top())) {
+    this->queue.pop();
+  }
+}
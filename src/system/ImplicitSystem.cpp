@@ -0,0 +1,30 @@
+#include "sbmlsim/internal/system/ImplicitSystem.h"
+
+ImplicitSystem::ImplicitSystem(SBMLSystem &system, SBMLSystemJacobi &jacobi)
+    : std::pair<std::reference_wrapper<SBMLSystem>, std::reference_wrapper<SBMLSystemJacobi> >(system, jacobi) {
+  // nothing to do
+}
+
+ImplicitSystem::~ImplicitSystem() {
+  // nothing to do
+}
+
+void ImplicitSystem::handleEvent(state &x, double t) {
+  this->first.get().handleEvent(x, t);
+}
+
+void ImplicitSystem::handleInitialAssignment(state &x, double t) {
+  this->first.get().handleInitialAssignment(x, t);
+}
+
+void ImplicitSystem::handleAssignmentRule(state &x, double t) {
+  this->first.get().handleAssignmentRule(x, t);
+}
+
+std::size_t ImplicitSystem::getNumEvents() const {
+  return this->first.get().getNumEvents();
+}
+
+double ImplicitSystem::evaluateEventFunction(unsigned int i, const state &x, double t) {
+  return this->first.get().evaluateEventFunction(i, x, t);
+}
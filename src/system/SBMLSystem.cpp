@@ -1,15 +1,42 @@
 #include "sbmlsim/internal/system/SBMLSystem.h"
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <unordered_set>
+#include "sbmlsim/internal/compiler/ExpressionCompiler.h"
 #include "sbmlsim/internal/util/MathUtil.h"
 #include "sbmlsim/internal/util/ASTNodeUtil.h"
 #include "sbmlsim/internal/util/RuntimeExceptionUtil.h"
 
-SBMLSystem::SBMLSystem(const ModelWrapper *model) : model(const_cast<ModelWrapper *>(model)) {
+SBMLSystem::SBMLSystem(const ModelWrapper *model) : model(model) {
   prepareInitialState();
+  prepareCompiledExpressions();
+  prepareEventIndex();
+  prepareStoichiometryMatrix();
 }
 
 SBMLSystem::SBMLSystem(const SBMLSystem &system)
-    : model(system.model), initialState(system.initialState), stateIndexMap(system.stateIndexMap) {
+    : model(system.model), initialState(system.initialState), stateIndexMap(system.stateIndexMap),
+      constants(system.constants), constantIndexMap(system.constantIndexMap), symbolTable(system.symbolTable),
+      kineticLaws(system.kineticLaws),
+      reactantStoichiometries(system.reactantStoichiometries), productStoichiometries(system.productStoichiometries),
+      rateRules(system.rateRules), initialAssignments(system.initialAssignments),
+      initialAssignmentTargets(system.initialAssignmentTargets), assignmentRules(system.assignmentRules),
+      assignmentRuleTargets(system.assignmentRuleTargets), eventTriggers(system.eventTriggers),
+      eventFunctions(system.eventFunctions), eventAssignments(system.eventAssignments),
+      eventDelays(system.eventDelays), eventPriorities(system.eventPriorities), eventQueue(system.eventQueue),
+      hasDelayedEvents(system.hasDelayedEvents), timeTriggers(system.timeTriggers),
+      nextTimeTrigger(system.nextTimeTrigger), triggerDependents(system.triggerDependents),
+      timeDependentTriggers(system.timeDependentTriggers), eventFunctionEvents(system.eventFunctionEvents),
+      triggerStates(system.triggerStates),
+      triggerInputs(system.triggerInputs), triggersInitialized(system.triggersInitialized),
+      triggerMarked(system.triggerMarked), stack(system.stack), stoichiometryMatrix(system.stoichiometryMatrix),
+      variableStoichiometries(system.variableStoichiometries),
+      variableStoichiometryEntries(system.variableStoichiometryEntries),
+      variableStoichiometryBases(system.variableStoichiometryBases), reactionRates(system.reactionRates),
+      rateRuleIndices(system.rateRuleIndices), fixedSpeciesIndices(system.fixedSpeciesIndices),
+      nativeModel(system.nativeModel) {
   // nothing to do
 }
 
@@ -19,193 +46,266 @@ SBMLSystem::~SBMLSystem() {
 }
 
 void SBMLSystem::operator()(const state &x, state &dxdt, double t) {
+  if (this->nativeModel) {
+    this->nativeModel->rhs(x.data().begin(), dxdt.data().begin(), t);
+    return;
+  }
   handleReaction(x, dxdt, t);
 }
 
 void SBMLSystem::handleReaction(const state& x, state& dxdt, double t) {
-  // initialize
-  for (auto i = 0; i < dxdt.size(); i++) {
-    dxdt[i] = 0.0;
+  // reaction rates
+  for (auto i = 0; i < this->kineticLaws.size(); i++) {
+    this->reactionRates[i] = evaluateCompiledExpression(this->kineticLaws[i], x, t);
   }
 
-  auto reactions = model->getReactions();
-  for (auto i = 0; i < reactions.size(); i++) {
-    auto reaction = reactions[i];
-    auto node = reaction.getMath();
-
-    auto clonedNode = ASTNodeUtil::reduceToBinary(node);
-    auto value = evaluateASTNode(clonedNode, x);
-    delete clonedNode;
-
-    // reactants
-    for (auto reactant : reaction.getReactants()) {
-      auto index = getStateIndexForVariable(reactant.getSpeciesId());
-      double stoichiometry;
-      if (reactant.hasStoichiometryMath()) {
-        stoichiometry = evaluateASTNode(reactant.getStoichiometryMath(), x);
-      } else {
-        stoichiometry = reactant.getStoichiometry();
-      }
-      dxdt[index] -= value * stoichiometry;
-    }
-
-    // products
-    for (auto product : reaction.getProducts()) {
-      auto index = getStateIndexForVariable(product.getSpeciesId());
-      double stoichiometry;
-      if (product.hasStoichiometryMath()) {
-        stoichiometry = evaluateASTNode(product.getStoichiometryMath(), x);
-      } else {
-        stoichiometry = product.getStoichiometry();
-      }
-      dxdt[index] += value * stoichiometry;
-    }
+  // variable stoichiometries
+  for (auto i = 0; i < this->variableStoichiometryEntries.size(); i++) {
+    this->stoichiometryMatrix.setValue(this->variableStoichiometryEntries[i], this->variableStoichiometryBases[i]);
   }
+  for (auto &stoichiometry : this->variableStoichiometries) {
+    auto value = evaluateCompiledExpression(stoichiometry.expression, x, t);
+    this->stoichiometryMatrix.setValue(
+        stoichiometry.entry, this->stoichiometryMatrix.getValues()[stoichiometry.entry] + stoichiometry.sign * value);
+  }
+
+  // dxdt = N * v
+  this->stoichiometryMatrix.multiply(this->reactionRates.data(), dxdt.data().begin());
 
   // rate rule
-  for (auto rateRule : model->getRateRules()) {
-    auto index = getStateIndexForVariable(rateRule->getVariable());
-    auto value = evaluateASTNode(rateRule->getMath(), x);
-    dxdt[index] = value;
+  for (auto i = 0; i < this->rateRules.size(); i++) {
+    dxdt[this->rateRuleIndices[i]] = evaluateCompiledExpression(this->rateRules[i], x, t);
   }
 
   // boundaryCondition and constant
-  auto &specieses = model->getSpecieses();
-  for (auto i = 0; i < specieses.size(); i++) {
-    if (specieses[i].hasBoundaryCondition() || specieses[i].isConstant()) {
-      auto index = getStateIndexForVariable(specieses[i].getId());
-      dxdt[index] = 0.0;
-    }
+  for (auto index : this->fixedSpeciesIndices) {
+    dxdt[index] = 0.0;
   }
 }
 
+/*
+ * Trigger transitions schedule executions at t + delay and executions that are due are popped from the
+ * queue, the one with the highest priority first. Every execution may switch other triggers, so they are
+ * re-examined after each one; events scheduled without delay are executed in the same call.
+ */
 void SBMLSystem::handleEvent(state &x, double t) {
-  for (auto event : model->getEvents()) {
-    bool fire = evaluateTriggerNode(event->getTrigger(), x);
-    if (fire && event->getTriggerState() == false) {
-      for (auto eventAssignment : event->getEventAssignments()) {
-        auto variable = eventAssignment.getVariable();
-        auto index = getStateIndexForVariable(variable);
-        double value = evaluateASTNode(eventAssignment.getMath(), x);
-        x[index] = value;
-        event->setTriggerState(true);
-      }
-    } else if (!fire) {
-      event->setTriggerState(false);
+  updateEventTriggers(x, t);
+  while (true) {
+    while (!this->eventQueue.empty() && this->eventQueue.getNextTime() <= t) {
+      this->dueEvents.push_back(this->eventQueue.pop());
+    }
+    // executions of non-persistent events may have been cancelled by the previous execution
+    auto cancelled = [this](const ScheduledEvent &scheduled) {
+      return this->eventQueue.isCancelled(scheduled);
+    };
+    this->dueEvents.erase(std::remove_if(this->dueEvents.begin(), this->dueEvents.end(), cancelled),
+                          this->dueEvents.end());
+    if (this->dueEvents.empty()) {
+      break;
     }
+
+    auto next = selectDueEvent(x, t);
+    ScheduledEvent scheduled = std::move(this->dueEvents[next]);
+    this->dueEvents.erase(this->dueEvents.begin() + next);
+    executeEvent(scheduled, x, t);
+    // triggers may read targets of assignment rules that read the assigned variables
+    handleAssignmentRule(x, t);
+    updateEventTriggers(x, t);
   }
 }
 
-void SBMLSystem::handleInitialAssignment(state &x, double t) {
-  if (t > 0) {
-    return;
+std::size_t SBMLSystem::getNumEvents() const {
+  bool scheduled = this->hasDelayedEvents || !this->timeTriggers.empty();
+  return this->eventFunctionEvents.size() + (scheduled ? 1 : 0);
+}
+
+/*
+ * The event function of event i changes sign where its trigger switches, so that integrators can locate
+ * the switch by root finding instead of polling the trigger at output points. Triggers of the form
+ * time > c have no function of their own; together with delayed executions they share a last function,
+ * which crosses zero at the next scheduled time.
+ */
+double SBMLSystem::evaluateEventFunction(unsigned int i, const state &x, double t) {
+  if (i == this->eventFunctionEvents.size()) {
+    auto next = getNextScheduledTime();
+    return std::isinf(next) ? -1.0 : t - next;
+  }
+  return evaluateCompiledExpression(this->eventFunctions[this->eventFunctionEvents[i]], x, t);
+}
+
+/*
+ * The earliest time at which handleEvent executes a delayed event or switches a trigger of the form
+ * time > c (just after c) or time >= c; infinity if there is none. Simulators that jump in time stop there.
+ */
+double SBMLSystem::getNextScheduledTime() {
+  auto next = this->eventQueue.getNextTime();
+  if (this->nextTimeTrigger < this->timeTriggers.size()) {
+    auto &trigger = this->timeTriggers[this->nextTimeTrigger];
+    auto time = trigger.inclusive
+                ? trigger.time : std::nextafter(trigger.time, std::numeric_limits<double>::infinity());
+    next = std::min(next, time);
+  }
+  return next;
+}
+
+/*
+ * Returns the event handling to where it was before the first handleEvent, so that one system can run
+ * several trajectories: pending executions are dropped and the triggers take their initial values again.
+ */
+void SBMLSystem::resetEvents() {
+  auto &events = this->model->getEvents();
+  this->eventQueue = EventQueue(events.size());
+  this->dueEvents.clear();
+  for (auto i = 0; i < events.size(); i++) {
+    this->triggerStates[i] = events[i]->getInitialValue();
+    this->triggerMarked[i] = false;
   }
+  this->markedTriggers.clear();
+  this->triggersInitialized = false;
+  this->nextTimeTrigger = 0;
+}
 
-  for (auto initialAssignment : model->getInitialAssignments()) {
-    auto symbol = initialAssignment->getSymbol();
-    auto value = evaluateASTNode(initialAssignment->getMath(), x);
-
-    // species
-    auto specieses = model->getSpecieses();
-    for (auto i = 0; i < specieses.size(); i++) {
-      if (symbol == specieses[i].getId()) {
-        auto speciesIndex = getStateIndexForVariable(specieses[i].getId());
-        if (specieses[i].shouldMultiplyByCompartmentSizeOnAssignment()) {
-          auto compartments = model->getCompartments();
-          for (auto j = 0; j < compartments.size(); j++) {
-            if (specieses[i].getCompartmentId() == compartments[j].getId()) {
-              auto compartmentIndex = getStateIndexForVariable(compartments[j].getId());
-              x[speciesIndex] = value * x[compartmentIndex];
-            }
-          }
-        } else {
-          x[speciesIndex] = value;
+/*
+ * Only the triggers that can have switched are evaluated: those reading a state variable that changed since
+ * the last check and those depending on time in a way that is not known in advance. Triggers of the form
+ * time > c switch exactly once, so they are kept sorted by c and consumed as time passes; this assumes that
+ * t does not decrease between calls, which holds for integrate_const.
+ */
+void SBMLSystem::updateEventTriggers(state &x, double t) {
+  if (!this->triggersInitialized) {
+    for (auto i = 0; i < this->eventTriggers.size(); i++) {
+      updateEventTrigger(i, x, t);
+    }
+    this->triggerInputs = x;
+    this->triggersInitialized = true;
+  } else {
+    for (auto index = 0; index < x.size(); index++) {
+      if (x[index] == this->triggerInputs[index]) {
+        continue;
+      }
+      this->triggerInputs[index] = x[index];
+      for (auto i : this->triggerDependents[index]) {
+        if (!this->triggerMarked[i]) {
+          this->triggerMarked[i] = true;
+          this->markedTriggers.push_back(i);
         }
       }
     }
-
-    // compartment
-    auto compartments = model->getCompartments();
-    for (auto i = 0; i < compartments.size(); i++) {
-      if (symbol == compartments[i].getId()) {
-        auto index = getStateIndexForVariable(compartments[i].getId());
-        x[index] = value;
-      }
+    for (auto i : this->markedTriggers) {
+      this->triggerMarked[i] = false;
+      updateEventTrigger(i, x, t);
     }
+    this->markedTriggers.clear();
+    for (auto i : this->timeDependentTriggers) {
+      updateEventTrigger(i, x, t);
+    }
+  }
 
-    // global parameter
-    auto parameters = model->getParameters();
-    for (auto i = 0; i < parameters.size(); i++) {
-      if (symbol == parameters[i]->getId()) {
-        auto index = getStateIndexForVariable(parameters[i]->getId());
-        x[index] = value;
-      }
+  for (; this->nextTimeTrigger < this->timeTriggers.size(); this->nextTimeTrigger++) {
+    auto &trigger = this->timeTriggers[this->nextTimeTrigger];
+    if (t < trigger.time || (t == trigger.time && !trigger.inclusive)) {
+      break;
+    }
+    if (!this->triggerStates[trigger.event]) {
+      this->triggerStates[trigger.event] = true;
+      scheduleEvent(trigger.event, x, t);
     }
   }
 }
 
-void SBMLSystem::handleAlgebraicRule(state &x, double t) {
-  // TODO
+void SBMLSystem::updateEventTrigger(unsigned int i, state &x, double t) {
+  auto event = model->getEvents()[i];
+  bool fire;
+  if (this->nativeModel) {
+    fire = this->nativeModel->trigger(i, x.data().begin(), t) != 0.0;
+  } else {
+    fire = evaluateCompiledExpression(this->eventTriggers[i], x, t) != 0.0;
+  }
+  if (fire && !this->triggerStates[i]) {
+    this->triggerStates[i] = true;
+    scheduleEvent(i, x, t);
+  } else if (!fire && this->triggerStates[i]) {
+    this->triggerStates[i] = false;
+    if (!event->isPersistent()) {
+      this->eventQueue.cancel(i);
+    }
+  }
 }
 
-void SBMLSystem::handleAssignmentRule(state &x, double t) {
-  auto &assignmentRules = this->model->getAssignmentRules();
-  for (auto i = 0; i < assignmentRules.size(); i++) {
-    auto &variable = assignmentRules[i]->getVariable();
-    auto value = evaluateASTNode(assignmentRules[i]->getMath(), x);
-
-    bool continueImmediately = false;
-
-    // species
-    auto specieses = model->getSpecieses();
-    for (auto i = 0; i < specieses.size(); i++) {
-      if (variable == specieses[i].getId()) {
-        auto speciesIndex = getStateIndexForVariable(specieses[i].getId());
-        if (specieses[i].shouldMultiplyByCompartmentSizeOnAssignment()) {
-          auto compartments = model->getCompartments();
-          for (auto j = 0; j < compartments.size(); j++) {
-            if (specieses[i].getCompartmentId() == compartments[j].getId()) {
-              auto compartmentIndex = getStateIndexForVariable(compartments[j].getId());
-              x[speciesIndex] = value * x[compartmentIndex];
-            }
-          }
-        } else {
-          x[speciesIndex] = value;
-        }
-        continueImmediately = true;
-        break;
-      }
-    }
-    if (continueImmediately) {
-      continue;
+void SBMLSystem::scheduleEvent(unsigned int i, const state &x, double t) {
+  auto event = model->getEvents()[i];
+  double delay = event->hasDelay() ? evaluateCompiledExpression(this->eventDelays[i], x, t) : 0.0;
+  std::vector<double> values;
+  if (event->getUseValuesFromTriggerTime()) {
+    for (auto &assignment : this->eventAssignments[i]) {
+      values.push_back(evaluateCompiledExpression(assignment, x, t));
     }
+  }
+  this->eventQueue.schedule(t + delay, i, std::move(values));
+}
 
-    // compartment
-    auto compartments = model->getCompartments();
-    for (auto i = 0; i < compartments.size(); i++) {
-      if (variable == compartments[i].getId()) {
-        auto index = getStateIndexForVariable(compartments[i].getId());
-        x[index] = value;
-        continueImmediately = true;
-        break;
-      }
-    }
-    if (continueImmediately) {
-      continue;
+/*
+ * Highest priority first; events without a priority come last and ties go to the earliest scheduled.
+ * Priorities are evaluated at execution time, as they may depend on the state.
+ */
+unsigned int SBMLSystem::selectDueEvent(const state &x, double t) {
+  auto &events = model->getEvents();
+  unsigned int selected = 0;
+  double selectedPriority = -std::numeric_limits<double>::infinity();
+  for (auto k = 0; k < this->dueEvents.size(); k++) {
+    auto i = this->dueEvents[k].event;
+    double priority = events[i]->hasPriority()
+                      ? evaluateCompiledExpression(this->eventPriorities[i], x, t)
+                      : -std::numeric_limits<double>::infinity();
+    if (k == 0 || priority > selectedPriority
+        || (priority == selectedPriority && this->dueEvents[k].sequence < this->dueEvents[selected].sequence)) {
+      selected = k;
+      selectedPriority = priority;
     }
+  }
+  return selected;
+}
 
-    // global parameter
-    auto parameters = model->getParameters();
-    for (auto i = 0; i < parameters.size(); i++) {
-      if (variable == parameters[i]->getId()) {
-        auto index = getStateIndexForVariable(parameters[i]->getId());
-        x[index] = value;
-        break;
-      }
+void SBMLSystem::executeEvent(const ScheduledEvent &scheduled, state &x, double t) {
+  auto i = scheduled.event;
+  auto &eventAssignments = model->getEvents()[i]->getEventAssignments();
+  for (auto j = 0; j < eventAssignments.size(); j++) {
+    auto index = getStateIndexForVariable(eventAssignments[j].getVariable());
+    if (scheduled.values.empty()) {
+      x[index] = evaluateCompiledExpression(this->eventAssignments[i][j], x, t);
+    } else {
+      x[index] = scheduled.values[j];
     }
   }
 }
 
+void SBMLSystem::handleInitialAssignment(state &x, double t) {
+  if (t > 0) {
+    return;
+  }
+
+  for (auto i = 0; i < this->initialAssignments.size(); i++) {
+    auto value = evaluateCompiledExpression(this->initialAssignments[i], x, t);
+    assignSymbol(this->initialAssignmentTargets[i], x, value);
+  }
+}
+
+void SBMLSystem::handleAlgebraicRule(state &x, double t) {
+  // TODO
+}
+
+void SBMLSystem::handleAssignmentRule(state &x, double t) {
+  if (this->nativeModel) {
+    this->nativeModel->assignmentRules(x.data().begin(), t);
+    return;
+  }
+
+  for (auto i = 0; i < this->assignmentRules.size(); i++) {
+    auto value = evaluateCompiledExpression(this->assignmentRules[i], x, t);
+    assignSymbol(this->assignmentRuleTargets[i], x, value);
+  }
+}
+
 void SBMLSystem::handleRateRule(state &x, double t) {
   // TODO
 }
@@ -218,19 +318,99 @@ unsigned int SBMLSystem::getStateIndexForVariable(const std::string &variableId)
   return this->stateIndexMap[variableId];
 }
 
+const ModelWrapper *SBMLSystem::getModel() const {
+  return this->model;
+}
+
+const std::vector<CompiledExpression> &SBMLSystem::getKineticLaws() const {
+  return this->kineticLaws;
+}
+
+const std::vector<std::vector<CompiledExpression> > &SBMLSystem::getReactantStoichiometries() const {
+  return this->reactantStoichiometries;
+}
+
+const std::vector<std::vector<CompiledExpression> > &SBMLSystem::getProductStoichiometries() const {
+  return this->productStoichiometries;
+}
+
+const std::vector<CompiledExpression> &SBMLSystem::getRateRules() const {
+  return this->rateRules;
+}
+
+const std::vector<CompiledExpression> &SBMLSystem::getAssignmentRules() const {
+  return this->assignmentRules;
+}
+
+const std::vector<Symbol> &SBMLSystem::getAssignmentRuleTargets() const {
+  return this->assignmentRuleTargets;
+}
+
+const std::vector<CompiledExpression> &SBMLSystem::getEventTriggers() const {
+  return this->eventTriggers;
+}
+
+const std::vector<CompiledExpression> &SBMLSystem::getEventFunctions() const {
+  return this->eventFunctions;
+}
+
+const std::vector<CompiledExpression> &SBMLSystem::getEventPriorities() const {
+  return this->eventPriorities;
+}
+
+const std::vector<std::vector<CompiledExpression> > &SBMLSystem::getEventAssignments() const {
+  return this->eventAssignments;
+}
+
+const SymbolTable &SBMLSystem::getSymbolTable() const {
+  return this->symbolTable;
+}
+
+const StoichiometryMatrix &SBMLSystem::getStoichiometryMatrix() const {
+  return this->stoichiometryMatrix;
+}
+
+void SBMLSystem::setNativeModel(std::shared_ptr<NativeModel> nativeModel) {
+  this->nativeModel = nativeModel;
+}
+
+bool SBMLSystem::hasNativeModel() const {
+  return static_cast<bool>(this->nativeModel);
+}
+
+bool SBMLSystem::isConstant(const std::string &variableId) const {
+  return this->constantIndexMap.find(variableId) != this->constantIndexMap.end();
+}
+
+unsigned int SBMLSystem::getConstantIndexForVariable(const std::string &variableId) {
+  return this->constantIndexMap[variableId];
+}
+
+const std::vector<double> &SBMLSystem::getConstants() const {
+  return this->constants;
+}
+
 std::vector<ObserveTarget> SBMLSystem::createOutputTargetsFromOutputFields(
     const std::vector<OutputField> &outputFields) {
   std::vector<ObserveTarget> ret;
 
   for (auto outputField : outputFields) {
     auto id = outputField.getId();
-    auto stateIndex = getStateIndexForVariable(id);
-    ret.push_back(ObserveTarget(id, stateIndex));
+    if (isConstant(id)) {
+      ret.push_back(ObserveTarget(id, getConstantIndexForVariable(id), true));
+    } else {
+      ret.push_back(ObserveTarget(id, getStateIndexForVariable(id)));
+    }
   }
 
   return ret;
 }
 
+double SBMLSystem::evaluateCompiledExpression(const CompiledExpression &expression, const state &x, double t) {
+  return expression.evaluate(x.data().begin(), this->constants.data(), t, this->stack.data());
+}
+
+// recursive reference interpreter; all model math is evaluated through compiled expressions
 double SBMLSystem::evaluateASTNode(const ASTNode *node, const state& x) {
   double left, right;
 
@@ -280,49 +460,40 @@ double SBMLSystem::evaluateASTNode(const ASTNode *node, const state& x) {
 }
 
 double SBMLSystem::evaluateNameNode(const ASTNode *node, const state &x) {
-  auto name = node->getName();
-
-  // species
-  auto specieses = model->getSpecieses();
-  for (auto i = 0; i < specieses.size(); i++) {
-    if (name == specieses[i].getId()) {
-      if (specieses[i].shouldDivideByCompartmentSizeOnEvaluation()) {
-        auto compartments = model->getCompartments();
-        for (auto j = 0; j < compartments.size(); j++) {
-          if (specieses[i].getCompartmentId() == compartments[j].getId()) {
-            auto speciesIndex = getStateIndexForVariable(specieses[i].getId());
-            auto compartmentIndex = getStateIndexForVariable(compartments[j].getId());
-            return x[speciesIndex] / x[compartmentIndex];
-          }
-        }
-      } else {
-        auto speciesIndex = getStateIndexForVariable(specieses[i].getId());
-        return x[speciesIndex];
-      }
-    }
-  }
+  return evaluateSymbol(this->symbolTable.get(node->getName()), x);
+}
 
-  // compartment
-  auto compartments = model->getCompartments();
-  for (auto i = 0; i < compartments.size(); i++) {
-    if (name == compartments[i].getId()) {
-      auto index = getStateIndexForVariable(compartments[i].getId());
-      return x[index];
-    }
+double SBMLSystem::evaluateSymbol(const Symbol &symbol, const state &x) {
+  switch (symbol.type) {
+    case SymbolType::CONCENTRATION:
+      return x[symbol.index] / x[symbol.compartmentIndex];
+    case SymbolType::CONSTANT:
+      return this->constants[symbol.index];
+    case SymbolType::CONSTANT_SIZE_CONCENTRATION:
+      return x[symbol.index] / this->constants[symbol.compartmentIndex];
+    case SymbolType::VARIABLE:
+    default:
+      return x[symbol.index];
   }
+}
 
-  // global parameter
-  auto parameters = model->getParameters();
-  for (auto i = 0; i < parameters.size(); i++) {
-    if (name == parameters[i]->getId()) {
-      auto index = getStateIndexForVariable(parameters[i]->getId());
-      return x[index];
-    }
+void SBMLSystem::assignSymbol(const Symbol &symbol, state &x, double value) {
+  switch (symbol.type) {
+    case SymbolType::CONCENTRATION:
+      x[symbol.index] = value * x[symbol.compartmentIndex];
+      break;
+    case SymbolType::CONSTANT_SIZE_CONCENTRATION:
+      x[symbol.index] = value * this->constants[symbol.compartmentIndex];
+      break;
+    case SymbolType::CONSTANT:
+      // targets of rules and assignments are never placed in the constants block
+      RuntimeExceptionUtil::throwInvalidFlowException();
+      break;
+    case SymbolType::VARIABLE:
+    default:
+      x[symbol.index] = value;
+      break;
   }
-
-  // not reachable
-  RuntimeExceptionUtil::throwUnknownNodeNameException(name);
-  return 0.0;
 }
 
 double SBMLSystem::evaluateFactorialNode(const ASTNode *node, const state &x) {
@@ -391,32 +562,322 @@ bool SBMLSystem::evaluateTriggerNode(const ASTNode *trigger, const state &x) {
   return false;
 }
 
+/*
+ * Species and every parameter or compartment changed by a rule, an event or an initial assignment form the
+ * integrated state. All other parameters and compartments go to the read-only constants block, so the steppers
+ * never touch them.
+ */
 void SBMLSystem::prepareInitialState() {
   auto &specieses = this->model->getSpecieses();
-  auto numSpecies = specieses.size();
-
   auto &parameters = this->model->getParameters();
-  auto numGlobalParameters = parameters.size();
-
   auto &compartments = this->model->getCompartments();
-  auto numCompartments = compartments.size();
 
-  auto numVariables = numSpecies + numGlobalParameters + numCompartments;
-  state is(numVariables);
+  std::unordered_set<std::string> targets;
+  for (auto rateRule : this->model->getRateRules()) {
+    targets.insert(rateRule->getVariable());
+  }
+  for (auto assignmentRule : this->model->getAssignmentRules()) {
+    targets.insert(assignmentRule->getVariable());
+  }
+  for (auto initialAssignment : this->model->getInitialAssignments()) {
+    targets.insert(initialAssignment->getSymbol());
+  }
+  for (auto event : this->model->getEvents()) {
+    for (auto &eventAssignment : event->getEventAssignments()) {
+      targets.insert(eventAssignment.getVariable());
+    }
+  }
 
-  auto curIndex = 0;
-  for (auto i = 0; i < numSpecies; i++) {
-    this->stateIndexMap[specieses[i].getId()] = curIndex;
-    is[curIndex++] = specieses[i].getInitialAmountValue();
+  std::vector<double> is;
+  for (auto i = 0; i < specieses.size(); i++) {
+    this->stateIndexMap[specieses[i].getId()] = is.size();
+    is.push_back(specieses[i].getInitialAmountValue());
   }
   for (auto i = 0; i < parameters.size(); i++) {
-    this->stateIndexMap[parameters[i]->getId()] = curIndex;
-    is[curIndex++] = parameters[i]->getValue();
+    auto &id = parameters[i]->getId();
+    if (targets.count(id) > 0) {
+      this->stateIndexMap[id] = is.size();
+      is.push_back(parameters[i]->getValue());
+    } else {
+      this->constantIndexMap[id] = this->constants.size();
+      this->constants.push_back(parameters[i]->getValue());
+    }
+  }
+  for (auto i = 0; i < compartments.size(); i++) {
+    auto &id = compartments[i].getId();
+    if (targets.count(id) > 0) {
+      this->stateIndexMap[id] = is.size();
+      is.push_back(compartments[i].getValue());
+    } else {
+      this->constantIndexMap[id] = this->constants.size();
+      this->constants.push_back(compartments[i].getValue());
+    }
+  }
+
+  this->initialState = state(is.size());
+  std::copy(is.begin(), is.end(), this->initialState.begin());
+
+  // symbols: species are read as concentrations unless they have only substance units
+  for (auto i = 0; i < specieses.size(); i++) {
+    auto speciesIndex = this->stateIndexMap[specieses[i].getId()];
+    auto &compartmentId = specieses[i].getCompartmentId();
+    if (!specieses[i].shouldDivideByCompartmentSizeOnEvaluation()) {
+      this->symbolTable.addVariable(specieses[i].getId(), speciesIndex);
+    } else if (isConstant(compartmentId)) {
+      this->symbolTable.addConstantSizeConcentration(specieses[i].getId(), speciesIndex,
+                                                     this->constantIndexMap[compartmentId]);
+    } else {
+      this->symbolTable.addConcentration(specieses[i].getId(), speciesIndex, this->stateIndexMap[compartmentId]);
+    }
+  }
+  for (auto &entry : this->stateIndexMap) {
+    if (!this->symbolTable.contains(entry.first)) {
+      this->symbolTable.addVariable(entry.first, entry.second);
+    }
+  }
+  for (auto &entry : this->constantIndexMap) {
+    this->symbolTable.addConstant(entry.first, entry.second);
+  }
+}
+
+void SBMLSystem::prepareCompiledExpressions() {
+  // reactions
+  auto &reactions = this->model->getReactions();
+  this->reactantStoichiometries.resize(reactions.size());
+  this->productStoichiometries.resize(reactions.size());
+  for (auto i = 0; i < reactions.size(); i++) {
+    this->kineticLaws.push_back(compileExpression(reactions[i].getMath()));
+    for (auto &reactant : reactions[i].getReactants()) {
+      this->reactantStoichiometries[i].push_back(reactant.hasStoichiometryMath()
+                                                 ? compileExpression(reactant.getStoichiometryMath())
+                                                 : CompiledExpression());
+    }
+    for (auto &product : reactions[i].getProducts()) {
+      this->productStoichiometries[i].push_back(product.hasStoichiometryMath()
+                                                ? compileExpression(product.getStoichiometryMath())
+                                                : CompiledExpression());
+    }
+  }
+
+  // rate rules
+  for (auto rateRule : this->model->getRateRules()) {
+    this->rateRules.push_back(compileExpression(rateRule->getMath()));
+  }
+
+  // initial assignments
+  for (auto initialAssignment : this->model->getInitialAssignments()) {
+    this->initialAssignments.push_back(compileExpression(initialAssignment->getMath()));
+    this->initialAssignmentTargets.push_back(this->symbolTable.get(initialAssignment->getSymbol()));
+  }
+
+  // assignment rules
+  for (auto assignmentRule : this->model->getAssignmentRules()) {
+    this->assignmentRules.push_back(compileExpression(assignmentRule->getMath()));
+    this->assignmentRuleTargets.push_back(this->symbolTable.get(assignmentRule->getVariable()));
+  }
+
+  // events
+  auto &events = this->model->getEvents();
+  this->hasDelayedEvents = false;
+  this->eventAssignments.resize(events.size());
+  for (auto i = 0; i < events.size(); i++) {
+    this->eventTriggers.push_back(compileExpression(events[i]->getTrigger()));
+    auto eventFunction = createEventFunctionNode(events[i]->getTrigger());
+    this->eventFunctions.push_back(compileExpression(eventFunction));
+    delete eventFunction;
+    for (auto &eventAssignment : events[i]->getEventAssignments()) {
+      this->eventAssignments[i].push_back(compileExpression(eventAssignment.getMath()));
+    }
+    this->eventDelays.push_back(events[i]->hasDelay() ? compileExpression(events[i]->getDelay())
+                                                      : CompiledExpression());
+    this->eventPriorities.push_back(events[i]->hasPriority() ? compileExpression(events[i]->getPriority())
+                                                             : CompiledExpression());
+    this->hasDelayedEvents = this->hasDelayedEvents || events[i]->hasDelay();
   }
-  for (auto i = 0; i < numCompartments; i++) {
-    this->stateIndexMap[compartments[i].getId()] = curIndex;
-    is[curIndex++] = compartments[i].getValue();
+  this->eventQueue = EventQueue(events.size());
+}
+
+void SBMLSystem::prepareEventIndex() {
+  auto &events = this->model->getEvents();
+  this->triggerDependents.resize(this->initialState.size());
+  this->triggerMarked.resize(events.size(), false);
+  for (auto event : events) {
+    this->triggerStates.push_back(event->getInitialValue());
   }
+  this->triggersInitialized = false;
+  this->nextTimeTrigger = 0;
+
+  for (unsigned int i = 0; i < events.size(); i++) {
+    TimeTrigger timeTrigger;
+    if (isTimeTrigger(events[i]->getTrigger(), timeTrigger)) {
+      timeTrigger.event = i;
+      this->timeTriggers.push_back(timeTrigger);
+      continue;
+    }
+    this->eventFunctionEvents.push_back(i);
+
+    std::set<unsigned int> reads;
+    bool readsTime = false;
+    collectReads(this->eventTriggers[i], reads, readsTime);
+    for (auto index : reads) {
+      this->triggerDependents[index].push_back(i);
+    }
+    if (readsTime) {
+      this->timeDependentTriggers.push_back(i);
+    }
+  }
+
+  auto earlier = [](const TimeTrigger &a, const TimeTrigger &b) {
+    return a.time < b.time;
+  };
+  std::stable_sort(this->timeTriggers.begin(), this->timeTriggers.end(), earlier);
+}
+
+/*
+ * Recognizes time > c, time >= c, c < time and c <= time where c reads neither the state nor time.
+ */
+bool SBMLSystem::isTimeTrigger(const ASTNode *trigger, TimeTrigger &timeTrigger) {
+  auto type = trigger->getType();
+  if (trigger->getNumChildren() != 2) {
+    return false;
+  }
+  const ASTNode *threshold;
+  if ((type == AST_RELATIONAL_GT || type == AST_RELATIONAL_GEQ)
+      && trigger->getLeftChild()->getType() == AST_NAME_TIME) {
+    threshold = trigger->getRightChild();
+  } else if ((type == AST_RELATIONAL_LT || type == AST_RELATIONAL_LEQ)
+             && trigger->getRightChild()->getType() == AST_NAME_TIME) {
+    threshold = trigger->getLeftChild();
+  } else {
+    return false;
+  }
+
+  auto expression = compileExpression(threshold);
+  std::set<unsigned int> reads;
+  bool readsTime = false;
+  collectReads(expression, reads, readsTime);
+  if (!reads.empty() || readsTime) {
+    return false;
+  }
+  timeTrigger.time = evaluateCompiledExpression(expression, this->initialState, 0.0);
+  timeTrigger.inclusive = type == AST_RELATIONAL_GEQ || type == AST_RELATIONAL_LEQ;
+  return true;
+}
+
+void SBMLSystem::collectReads(const CompiledExpression &expression, std::set<unsigned int> &reads, bool &readsTime) {
+  for (auto &instruction : expression.getInstructions()) {
+    switch (instruction.opcode) {
+      case OpCode::LOAD_VARIABLE:
+      case OpCode::LOAD_CONCENTRATION_CONSTANT_SIZE:
+        reads.insert(instruction.operand);
+        break;
+      case OpCode::LOAD_CONCENTRATION:
+        reads.insert(instruction.operand);
+        reads.insert(instruction.compartmentIndex);
+        break;
+      case OpCode::LOAD_TIME:
+        readsTime = true;
+        break;
+      default:
+        break;
+    }
+  }
+}
 
-  this->initialState = is;
+void SBMLSystem::prepareStoichiometryMatrix() {
+  auto numStates = this->initialState.size();
+
+  // rows whose derivative does not come from reactions are left empty
+  std::vector<bool> excluded(numStates, false);
+  for (auto rateRule : this->model->getRateRules()) {
+    auto index = getStateIndexForVariable(rateRule->getVariable());
+    this->rateRuleIndices.push_back(index);
+    excluded[index] = true;
+  }
+  for (auto &species : this->model->getSpecieses()) {
+    if (species.hasBoundaryCondition() || species.isConstant()) {
+      auto index = getStateIndexForVariable(species.getId());
+      this->fixedSpeciesIndices.push_back(index);
+      excluded[index] = true;
+    }
+  }
+
+  // variable stoichiometries get a zero placeholder entry and are added on every evaluation
+  std::vector<StoichiometryEntry> entries;
+  std::vector<std::pair<StoichiometryEntry, double> > variableEntries;
+  std::vector<const CompiledExpression *> variableExpressions;
+  auto &reactions = this->model->getReactions();
+  for (auto i = 0; i < reactions.size(); i++) {
+    auto &reactants = reactions[i].getReactants();
+    for (auto j = 0; j < reactants.size(); j++) {
+      auto index = getStateIndexForVariable(reactants[j].getSpeciesId());
+      if (excluded[index]) {
+        continue;
+      }
+      if (reactants[j].hasStoichiometryMath()) {
+        entries.push_back({index, static_cast<unsigned int>(i), 0.0});
+        variableEntries.push_back(std::make_pair(entries.back(), -1.0));
+        variableExpressions.push_back(&this->reactantStoichiometries[i][j]);
+      } else {
+        entries.push_back({index, static_cast<unsigned int>(i), -reactants[j].getStoichiometry()});
+      }
+    }
+    auto &products = reactions[i].getProducts();
+    for (auto j = 0; j < products.size(); j++) {
+      auto index = getStateIndexForVariable(products[j].getSpeciesId());
+      if (excluded[index]) {
+        continue;
+      }
+      if (products[j].hasStoichiometryMath()) {
+        entries.push_back({index, static_cast<unsigned int>(i), 0.0});
+        variableEntries.push_back(std::make_pair(entries.back(), 1.0));
+        variableExpressions.push_back(&this->productStoichiometries[i][j]);
+      } else {
+        entries.push_back({index, static_cast<unsigned int>(i), products[j].getStoichiometry()});
+      }
+    }
+  }
+
+  this->stoichiometryMatrix = StoichiometryMatrix(numStates, reactions.size(), entries);
+  this->reactionRates.resize(reactions.size());
+
+  for (auto i = 0; i < variableEntries.size(); i++) {
+    auto entry = this->stoichiometryMatrix.findEntry(variableEntries[i].first.row, variableEntries[i].first.column);
+    this->variableStoichiometries.push_back({entry, variableEntries[i].second, *variableExpressions[i]});
+    if (std::find(this->variableStoichiometryEntries.begin(), this->variableStoichiometryEntries.end(), entry)
+        == this->variableStoichiometryEntries.end()) {
+      this->variableStoichiometryEntries.push_back(entry);
+      this->variableStoichiometryBases.push_back(this->stoichiometryMatrix.getValues()[entry]);
+    }
+  }
+}
+
+/*
+ * lhs - rhs for a > or >= trigger and rhs - lhs for < or <=, which cross zero smoothly. Any other trigger is
+ * mapped to +-0.5, which still brackets the switch for bisection.
+ */
+ASTNode *SBMLSystem::createEventFunctionNode(const ASTNode *trigger) {
+  auto type = trigger->getType();
+  ASTNode *ret = new ASTNode(AST_MINUS);
+  if (trigger->getNumChildren() == 2 && (type == AST_RELATIONAL_GT || type == AST_RELATIONAL_GEQ)) {
+    ret->addChild(trigger->getLeftChild()->deepCopy());
+    ret->addChild(trigger->getRightChild()->deepCopy());
+  } else if (trigger->getNumChildren() == 2 && (type == AST_RELATIONAL_LT || type == AST_RELATIONAL_LEQ)) {
+    ret->addChild(trigger->getRightChild()->deepCopy());
+    ret->addChild(trigger->getLeftChild()->deepCopy());
+  } else {
+    ASTNode *half = new ASTNode(AST_REAL);
+    half->setValue(0.5);
+    ret->addChild(trigger->deepCopy());
+    ret->addChild(half);
+  }
+  return ret;
+}
+
+CompiledExpression SBMLSystem::compileExpression(const ASTNode *node) {
+  auto expression = ExpressionCompiler::compile(node, this->symbolTable);
+  if (this->stack.size() < expression.getStackSize()) {
+    this->stack.resize(expression.getStackSize());
+  }
+  return expression;
 }
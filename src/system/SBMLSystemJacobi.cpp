@@ -1,11 +1,611 @@
 #include "sbmlsim/internal/system/SBMLSystemJacobi.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include "sbmlsim/internal/compiler/ExpressionCompiler.h"
+#include "sbmlsim/internal/util/ASTNodeUtil.h"
+#include "sbmlsim/internal/util/MathUtil.h"
+
+namespace {
+
+// not a valid SBML id, so it never clashes with a symbol of the model
+const char *TIME_SYMBOL = "sbmlsim:time";
+
+bool isZero(const ASTNode *node) {
+  return node->isNumber() && node->getValue() == 0.0;
+}
+
+ASTNode *createBinaryNode(ASTNodeType_t type, ASTNode *left, ASTNode *right) {
+  ASTNode *ret = new ASTNode(type);
+  ret->addChild(left);
+  ret->addChild(right);
+  return ret;
+}
+
+ASTNode *createNameNode(const std::string &name) {
+  ASTNode *ret = new ASTNode(AST_NAME);
+  ret->setName(name.c_str());
+  return ret;
+}
+
+// forward difference step, balancing truncation against cancellation
+double differenceStep(double value) {
+  static const double SQRT_EPSILON = std::sqrt(std::numeric_limits<double>::epsilon());
+  return SQRT_EPSILON * std::max(std::abs(value), 1.0);
+}
+
+}  // namespace
+
+SBMLSystemJacobi::SBMLSystemJacobi(SBMLSystem &system, JacobianMethod method)
+    : numStates(system.getInitialState().size()), method(method), constants(system.getConstants()),
+      stateSeed(numStates, 0.0), constantSeed(constants.size(), 0.0) {
+  prepareRateTerms(system);
+  prepareSparsityPattern();
+
+  if (this->method == JacobianMethod::FINITE_DIFFERENCE) {
+    this->terms.clear();
+    this->timeTerms.clear();
+    this->system = std::make_shared<SBMLSystem>(system);
+    this->f0.resize(this->numStates);
+    this->f1.resize(this->numStates);
+    this->perturbed.resize(this->numStates);
+    prepareColoring();
+  }
+}
+
+SBMLSystemJacobi::SBMLSystemJacobi(const SBMLSystemJacobi &jacobi)
+    : numStates(jacobi.numStates), method(jacobi.method), rowPointers(jacobi.rowPointers),
+      columnIndices(jacobi.columnIndices), values(jacobi.values), columns(jacobi.columns),
+      dependencies(jacobi.dependencies), terms(jacobi.terms), timeTerms(jacobi.timeTerms),
+      constants(jacobi.constants), stack(jacobi.stack), rates(jacobi.rates), tangents(jacobi.tangents),
+      stateSeed(jacobi.stateSeed), constantSeed(jacobi.constantSeed), system(jacobi.system),
+      colorColumns(jacobi.colorColumns), colorEntries(jacobi.colorEntries), f0(jacobi.f0), f1(jacobi.f1),
+      perturbed(jacobi.perturbed), assignmentRuleTargets(jacobi.assignmentRuleTargets),
+      inlinedAssignmentRules(jacobi.inlinedAssignmentRules) {
+  // nothing to do
+}
+
+SBMLSystemJacobi::~SBMLSystemJacobi() {
+  // nothing to do
+}
 
 void SBMLSystemJacobi::operator()(const state &x, matrix &J, const double &t, state &dfdt) {
-  // works with 00001-sbml-l2v4.xml only
-  J(0, 0) = -1.0;
-  J(0, 1) = 0.0;
-  J(1, 0) = 1.0;
-  J(1, 1) = 0.0;
-  dfdt[0] = 0.0;
-  dfdt[1] = 0.0;
+  evaluate(x, t);
+
+  J.clear();
+  for (auto i = 0; i < this->numStates; i++) {
+    for (auto k = this->rowPointers[i]; k < this->rowPointers[i + 1]; k++) {
+      J(i, this->columnIndices[k]) = this->values[k];
+    }
+  }
+
+  if (this->method == JacobianMethod::FINITE_DIFFERENCE) {
+    // f0 is left at f(x, t) by evaluate()
+    auto h = differenceStep(t);
+    (*this->system)(x, this->f1, t + h);
+    for (auto i = 0; i < this->numStates; i++) {
+      dfdt[i] = (this->f1[i] - this->f0[i]) / h;
+    }
+    return;
+  }
+
+  dfdt.clear();
+  const double *data = x.data().begin();
+  for (auto &term : this->timeTerms) {
+    auto value = evaluateTerm(term, data, t, true);
+    for (auto &entry : term.entries) {
+      dfdt[entry.first] += entry.second * value;
+    }
+  }
+}
+
+/*
+ * Evaluates the structural non-zeros of J into getValues().
+ */
+void SBMLSystemJacobi::evaluate(const state &x, double t) {
+  if (this->method == JacobianMethod::FINITE_DIFFERENCE) {
+    evaluateFiniteDifference(x, t);
+    return;
+  }
+
+  std::fill(this->values.begin(), this->values.end(), 0.0);
+
+  const double *data = x.data().begin();
+  for (auto &term : this->terms) {
+    auto value = evaluateTerm(term, data, t, false);
+    for (auto &entry : term.entries) {
+      this->values[entry.first] += entry.second * value;
+    }
+  }
+}
+
+/*
+ * df/dk_p for the constant at constantIndex (see SBMLSystem::getConstantIndexForVariable), i.e. the
+ * inhomogeneous term of the forward sensitivity equations ds/dt = J s + df/dk_p.
+ */
+void SBMLSystemJacobi::evaluateParameterDerivative(const state &x, double t, unsigned int constantIndex,
+                                                   state &dfdp) {
+  dfdp.clear();
+
+  const double *data = x.data().begin();
+  this->constantSeed[constantIndex] = 1.0;
+  TangentSeed seed = {nullptr, this->constantSeed.data(), 0.0};
+  for (auto c = 0; c < this->rates.size(); c++) {
+    double tangent;
+    this->rates[c].evaluateTangent(data, this->constants.data(), t, seed, this->stack.data(),
+                                   this->tangents.data(), &tangent);
+    if (tangent == 0.0) {
+      continue;
+    }
+    for (auto &entry : this->columns[c]) {
+      dfdp[entry.first] += entry.second * tangent;
+    }
+  }
+  this->constantSeed[constantIndex] = 0.0;
+}
+
+/*
+ * d{r_c}/d{x_j}, or d{r_c}/dt for a time term.
+ */
+double SBMLSystemJacobi::evaluateTerm(const JacobianTerm &term, const double *x, double t, bool time) {
+  if (this->method != JacobianMethod::AUTOMATIC_DIFFERENTIATION) {
+    return term.derivative.evaluate(x, this->constants.data(), t, this->stack.data());
+  }
+
+  TangentSeed seed = {nullptr, nullptr, 0.0};
+  if (time) {
+    seed.t = 1.0;
+  } else {
+    this->stateSeed[term.stateIndex] = 1.0;
+    seed.x = this->stateSeed.data();
+  }
+  double tangent;
+  this->rates[term.column].evaluateTangent(x, this->constants.data(), t, seed, this->stack.data(),
+                                           this->tangents.data(), &tangent);
+  if (!time) {
+    this->stateSeed[term.stateIndex] = 0.0;
+  }
+  return tangent;
+}
+
+unsigned int SBMLSystemJacobi::getNumStates() const {
+  return this->numStates;
+}
+
+unsigned int SBMLSystemJacobi::getNumNonZeros() const {
+  return this->values.size();
+}
+
+const std::vector<unsigned int> &SBMLSystemJacobi::getRowPointers() const {
+  return this->rowPointers;
+}
+
+const std::vector<unsigned int> &SBMLSystemJacobi::getColumnIndices() const {
+  return this->columnIndices;
+}
+
+const std::vector<double> &SBMLSystemJacobi::getValues() const {
+  return this->values;
+}
+
+JacobianMethod SBMLSystemJacobi::getMethod() const {
+  return this->method;
+}
+
+unsigned int SBMLSystemJacobi::getNumColors() const {
+  return this->colorColumns.size();
+}
+
+/*
+ * One forward difference per color: every column of the color is perturbed at once, and since no two of
+ * them share a row each difference f(x + h) - f(x) in a row belongs to exactly one column. Assignment rules
+ * are applied to x + h, so that their targets follow the perturbation.
+ */
+void SBMLSystemJacobi::evaluateFiniteDifference(const state &x, double t) {
+  auto &rhs = *this->system;
+  rhs(x, this->f0, t);
+  this->perturbed = x;
+
+  for (auto color = 0; color < this->colorColumns.size(); color++) {
+    for (auto j : this->colorColumns[color]) {
+      this->perturbed[j] += differenceStep(x[j]);
+    }
+    if (!this->assignmentRuleTargets.empty()) {
+      rhs.handleAssignmentRule(this->perturbed, t);
+    }
+    rhs(this->perturbed, this->f1, t);
+    for (auto &entry : this->colorEntries[color]) {
+      auto j = this->columnIndices[entry.first];
+      auto i = entry.second;
+      this->values[entry.first] = (this->f1[i] - this->f0[i]) / (this->perturbed[j] - x[j]);
+    }
+    for (auto j : this->colorColumns[color]) {
+      this->perturbed[j] = x[j];
+    }
+    for (auto &target : this->assignmentRuleTargets) {
+      this->perturbed[target.first] = x[target.first];
+    }
+  }
+}
+
+void SBMLSystemJacobi::prepareRateTerms(SBMLSystem &system) {
+  auto model = system.getModel();
+
+  // targets of assignment rules are not integrated; rates reading them are differentiated through the rules
+  for (auto assignmentRule : model->getAssignmentRules()) {
+    auto &variable = assignmentRule->getVariable();
+    this->assignmentRuleTargets[system.getSymbolTable().get(variable).index] = variable;
+  }
+  for (auto assignmentRule : model->getAssignmentRules()) {
+    this->inlinedAssignmentRules[assignmentRule->getVariable()] =
+        std::shared_ptr<ASTNode>(inlineAssignmentRules(system, assignmentRule->getMath()));
+  }
+
+  // same row layout as SBMLSystem::handleReaction
+  std::set<unsigned int> rateRuleRows;
+  std::set<unsigned int> fixedRows;
+  for (auto rateRule : model->getRateRules()) {
+    rateRuleRows.insert(system.getStateIndexForVariable(rateRule->getVariable()));
+  }
+  for (auto &species : model->getSpecieses()) {
+    if (species.hasBoundaryCondition() || species.isConstant()) {
+      fixedRows.insert(system.getStateIndexForVariable(species.getId()));
+    }
+  }
+  auto excluded = [&](unsigned int row) {
+    return rateRuleRows.count(row) > 0 || fixedRows.count(row) > 0;
+  };
+
+  for (auto &reaction : model->getReactions()) {
+    column entries;
+    for (auto &reactant : reaction.getReactants()) {
+      auto index = system.getStateIndexForVariable(reactant.getSpeciesId());
+      if (excluded(index)) {
+        continue;
+      }
+      if (reactant.hasStoichiometryMath()) {
+        auto rate = createBinaryNode(AST_TIMES, reactant.getStoichiometryMath()->deepCopy(),
+                                     reaction.getMath()->deepCopy());
+        auto binary = ASTNodeUtil::reduceToBinary(rate);
+        addRateTerm(system, binary, column {std::make_pair(index, -1.0)});
+        delete binary;
+        delete rate;
+      } else {
+        entries.push_back(std::make_pair(index, -reactant.getStoichiometry()));
+      }
+    }
+    for (auto &product : reaction.getProducts()) {
+      auto index = system.getStateIndexForVariable(product.getSpeciesId());
+      if (excluded(index)) {
+        continue;
+      }
+      if (product.hasStoichiometryMath()) {
+        auto rate = createBinaryNode(AST_TIMES, product.getStoichiometryMath()->deepCopy(),
+                                     reaction.getMath()->deepCopy());
+        auto binary = ASTNodeUtil::reduceToBinary(rate);
+        addRateTerm(system, binary, column {std::make_pair(index, 1.0)});
+        delete binary;
+        delete rate;
+      } else {
+        entries.push_back(std::make_pair(index, product.getStoichiometry()));
+      }
+    }
+    if (!entries.empty()) {
+      addRateTerm(system, reaction.getMath(), entries);
+    }
+  }
+
+  for (auto rateRule : model->getRateRules()) {
+    auto index = system.getStateIndexForVariable(rateRule->getVariable());
+    if (fixedRows.count(index) > 0) {
+      continue;
+    }
+    auto binary = ASTNodeUtil::reduceToBinary(rateRule->getMath());
+    addRateTerm(system, binary, column {std::make_pair(index, 1.0)});
+    delete binary;
+  }
+}
+
+void SBMLSystemJacobi::prepareSparsityPattern() {
+  std::set<std::pair<unsigned int, unsigned int> > pattern;
+  for (auto c = 0; c < this->columns.size(); c++) {
+    for (auto &entry : this->columns[c]) {
+      for (auto stateIndex : this->dependencies[c]) {
+        pattern.insert(std::make_pair(entry.first, stateIndex));
+      }
+    }
+  }
+
+  // std::set is ordered by (row, column), which is the CSR order
+  this->rowPointers.assign(this->numStates + 1, 0);
+  for (auto &position : pattern) {
+    this->columnIndices.push_back(position.second);
+    this->rowPointers[position.first + 1]++;
+  }
+  for (auto i = 0; i < this->numStates; i++) {
+    this->rowPointers[i + 1] += this->rowPointers[i];
+  }
+  this->values.assign(this->columnIndices.size(), 0.0);
+
+  for (auto &term : this->terms) {
+    for (auto &entry : this->columns[term.column]) {
+      auto begin = this->columnIndices.begin() + this->rowPointers[entry.first];
+      auto end = this->columnIndices.begin() + this->rowPointers[entry.first + 1];
+      auto position = std::lower_bound(begin, end, term.stateIndex) - this->columnIndices.begin();
+      term.entries.push_back(std::make_pair(position, entry.second));
+    }
+  }
+  for (auto &term : this->timeTerms) {
+    term.entries = this->columns[term.column];
+  }
+}
+
+/*
+ * Greedy Curtis-Powell-Reid coloring: two columns get different colors if they have a non-zero in the same row.
+ * Columns without structural non-zeros are never perturbed.
+ */
+void SBMLSystemJacobi::prepareColoring() {
+  const int NO_COLOR = -1;
+  std::vector<std::vector<unsigned int> > rowsOfColumn(this->numStates);
+  for (auto i = 0; i < this->numStates; i++) {
+    for (auto k = this->rowPointers[i]; k < this->rowPointers[i + 1]; k++) {
+      rowsOfColumn[this->columnIndices[k]].push_back(i);
+    }
+  }
+
+  std::vector<int> colors(this->numStates, NO_COLOR);
+  for (auto j = 0; j < this->numStates; j++) {
+    if (rowsOfColumn[j].empty()) {
+      continue;
+    }
+    std::set<int> used;
+    for (auto i : rowsOfColumn[j]) {
+      for (auto k = this->rowPointers[i]; k < this->rowPointers[i + 1]; k++) {
+        used.insert(colors[this->columnIndices[k]]);
+      }
+    }
+    auto color = 0;
+    while (used.count(color) > 0) {
+      color++;
+    }
+    colors[j] = color;
+    if (color == this->colorColumns.size()) {
+      this->colorColumns.push_back(std::vector<unsigned int>());
+      this->colorEntries.push_back(std::vector<std::pair<unsigned int, unsigned int> >());
+    }
+    this->colorColumns[color].push_back(j);
+  }
+
+  for (auto i = 0; i < this->numStates; i++) {
+    for (auto k = this->rowPointers[i]; k < this->rowPointers[i + 1]; k++) {
+      this->colorEntries[colors[this->columnIndices[k]]].push_back(std::make_pair(k, i));
+    }
+  }
+}
+
+void SBMLSystemJacobi::addRateTerm(SBMLSystem &system, const ASTNode *rate, const column &entries) {
+  unsigned int columnIndex = this->columns.size();
+  this->columns.push_back(entries);
+
+  auto &symbolTable = system.getSymbolTable();
+  auto inlined = inlineAssignmentRules(system, rate);
+  auto node = ASTNodeUtil::rewriteTimeToName(inlined, TIME_SYMBOL);
+  std::set<std::string> names;
+  ASTNodeUtil::collectNames(node, names);
+
+  // structure: every state variable the rate term reads
+  std::set<unsigned int> reads;
+  collectReads(system, names, reads);
+  this->dependencies.push_back(std::vector<unsigned int>(reads.begin(), reads.end()));
+
+  auto expression = ExpressionCompiler::compile(inlined, symbolTable);
+  delete inlined;
+  if (this->stack.size() < expression.getStackSize()) {
+    this->stack.resize(expression.getStackSize());
+    this->tangents.resize(expression.getStackSize());
+  }
+  this->rates.push_back(expression);
+
+  if (this->method == JacobianMethod::AUTOMATIC_DIFFERENTIATION) {
+    for (auto stateIndex : this->dependencies.back()) {
+      this->terms.push_back({columnIndex, stateIndex, CompiledExpression(), column()});
+    }
+    if (names.count(TIME_SYMBOL) > 0) {
+      this->timeTerms.push_back({columnIndex, 0, CompiledExpression(), column()});
+    }
+    delete node;
+    return;
+  }
+
+  if (this->method == JacobianMethod::SYMBOLIC_DIFFERENTIATION && !MathUtil::isDifferentiable(node)) {
+    this->method = JacobianMethod::FINITE_DIFFERENCE;
+  }
+  if (this->method == JacobianMethod::FINITE_DIFFERENCE) {
+    // only the structure is needed from here on
+    delete node;
+    return;
+  }
+
+  // d{rate}/d{x_j} = sum over names n of d{rate}/d{n} * d{n}/d{x_j}
+  std::map<unsigned int, ASTNode *> derivatives;
+  auto accumulate = [&](unsigned int stateIndex, ASTNode *term) {
+    auto it = derivatives.find(stateIndex);
+    if (it == derivatives.end()) {
+      derivatives[stateIndex] = term;
+    } else {
+      it->second = createBinaryNode(AST_PLUS, it->second, term);
+    }
+  };
+
+  for (auto &name : names) {
+    ASTNode *raw;
+    try {
+      raw = MathUtil::differentiate(node, name);
+    } catch (const std::runtime_error &) {
+      // e.g. a node type differentiate() does not know
+      for (auto &entry : derivatives) {
+        delete entry.second;
+      }
+      this->method = JacobianMethod::FINITE_DIFFERENCE;
+      delete node;
+      return;
+    }
+    auto derivative = MathUtil::simplify(raw);
+    delete raw;
+    if (isZero(derivative)) {
+      delete derivative;
+      continue;
+    }
+
+    if (name == TIME_SYMBOL) {
+      addDerivative(system, this->timeTerms, columnIndex, 0, derivative);
+      delete derivative;
+      continue;
+    }
+
+    auto &symbol = symbolTable.get(name);
+    switch (symbol.type) {
+      case SymbolType::VARIABLE:
+        accumulate(symbol.index, derivative);
+        break;
+      case SymbolType::CONCENTRATION:
+        accumulate(symbol.compartmentIndex, createBinaryNode(
+            AST_TIMES, derivative->deepCopy(), createChainRuleFactor(system, name, symbol.compartmentIndex)));
+        accumulate(symbol.index, createBinaryNode(
+            AST_TIMES, derivative, createChainRuleFactor(system, name, symbol.index)));
+        break;
+      case SymbolType::CONSTANT_SIZE_CONCENTRATION:
+        accumulate(symbol.index, createBinaryNode(
+            AST_TIMES, derivative, createChainRuleFactor(system, name, symbol.index)));
+        break;
+      case SymbolType::CONSTANT:
+        delete derivative;
+        break;
+    }
+  }
+
+  for (auto &entry : derivatives) {
+    auto simplified = MathUtil::simplify(entry.second);
+    addDerivative(system, this->terms, columnIndex, entry.first, simplified);
+    delete simplified;
+    delete entry.second;
+  }
+  delete node;
+}
+
+/*
+ * d{s}/d{x_j} for a species s read as a concentration, s = x_s / c:
+ * 1 / c for the amount of s, -s / c for the size of its compartment.
+ */
+ASTNode *SBMLSystemJacobi::createChainRuleFactor(SBMLSystem &system, const std::string &name,
+                                                 unsigned int stateIndex) {
+  std::string compartmentId;
+  for (auto &species : system.getModel()->getSpecieses()) {
+    if (species.getId() == name) {
+      compartmentId = species.getCompartmentId();
+      break;
+    }
+  }
+
+  if (stateIndex == system.getSymbolTable().get(name).index) {
+    auto one = new ASTNode(AST_INTEGER);
+    one->setValue(1);
+    return createBinaryNode(AST_DIVIDE, one, createNameNode(compartmentId));
+  }
+
+  auto ret = new ASTNode(AST_MINUS);
+  ret->addChild(createBinaryNode(AST_DIVIDE, createNameNode(name), createNameNode(compartmentId)));
+  return ret;
+}
+
+void SBMLSystemJacobi::addDerivative(SBMLSystem &system, std::vector<JacobianTerm> &target, unsigned int column,
+                                     unsigned int stateIndex, const ASTNode *derivative) {
+  if (isZero(derivative)) {
+    return;
+  }
+
+  auto node = ASTNodeUtil::rewriteNameToTime(derivative, TIME_SYMBOL);
+  auto expression = ExpressionCompiler::compile(node, system.getSymbolTable());
+  delete node;
+
+  if (this->stack.size() < expression.getStackSize()) {
+    this->stack.resize(expression.getStackSize());
+    this->tangents.resize(expression.getStackSize());
+  }
+  target.push_back({column, stateIndex, expression, SBMLSystemJacobi::column()});
+}
+
+/*
+ * Replaces every target of an assignment rule in node by the math of its rule, until none is left (assignment
+ * rules cannot be cyclic). The result evaluates to the same value on states where the rules hold.
+ */
+ASTNode *SBMLSystemJacobi::inlineAssignmentRules(SBMLSystem &system, const ASTNode *node) {
+  auto &assignmentRules = system.getModel()->getAssignmentRules();
+  ASTNode *ret = node->deepCopy();
+  for (auto pass = 0; pass <= assignmentRules.size(); pass++) {
+    std::set<std::string> names;
+    ASTNodeUtil::collectNames(ret, names);
+    bool replaced = false;
+    for (auto assignmentRule : assignmentRules) {
+      auto &variable = assignmentRule->getVariable();
+      if (names.count(variable) == 0) {
+        continue;
+      }
+      if (ret->getType() == AST_NAME && variable == ret->getName()) {
+        delete ret;
+        ret = assignmentRule->getMath()->deepCopy();
+      } else {
+        ret->replaceArgument(variable, const_cast<ASTNode *>(assignmentRule->getMath()));
+      }
+      replaced = true;
+    }
+    if (!replaced) {
+      break;
+    }
+  }
+
+  auto binary = ASTNodeUtil::reduceToBinary(ret);
+  delete ret;
+  return binary;
+}
+
+/*
+ * State variables read through names, which contain no assignment rule target after inlineAssignmentRules.
+ * A species in a compartment whose size is given by an assignment rule still reads the size implicitly;
+ * its reads are those of the rule, and since the derivative cannot be taken through the name the whole
+ * Jacobian falls back to finite differences.
+ */
+void SBMLSystemJacobi::collectReads(SBMLSystem &system, const std::set<std::string> &names,
+                                   std::set<unsigned int> &reads) {
+  auto &symbolTable = system.getSymbolTable();
+  for (auto &name : names) {
+    if (name == TIME_SYMBOL) {
+      continue;
+    }
+    auto &symbol = symbolTable.get(name);
+    switch (symbol.type) {
+      case SymbolType::CONCENTRATION: {
+        auto target = this->assignmentRuleTargets.find(symbol.compartmentIndex);
+        if (target == this->assignmentRuleTargets.end()) {
+          reads.insert(symbol.compartmentIndex);
+        } else {
+          std::set<std::string> compartmentNames;
+          ASTNodeUtil::collectNames(this->inlinedAssignmentRules[target->second].get(), compartmentNames);
+          collectReads(system, compartmentNames, reads);
+          this->method = JacobianMethod::FINITE_DIFFERENCE;
+        }
+        reads.insert(symbol.index);
+        break;
+      }
+      case SymbolType::VARIABLE:
+      case SymbolType::CONSTANT_SIZE_CONCENTRATION:
+        reads.insert(symbol.index);
+        break;
+      case SymbolType::CONSTANT:
+        break;
+    }
+  }
 }
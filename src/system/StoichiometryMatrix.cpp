@@ -0,0 +1,94 @@
+#include "sbmlsim/internal/system/StoichiometryMatrix.h"
+#include <algorithm>
+#include "sbmlsim/internal/util/RuntimeExceptionUtil.h"
+
+StoichiometryMatrix::StoichiometryMatrix() : numRows(0), numColumns(0), rowPointers(1, 0) {
+  // nothing to do
+}
+
+/*
+ * Entries with the same row and column (e.g. a species appearing twice in a reaction) are summed.
+ * Zero entries are kept, because they may be placeholders for variable stoichiometries.
+ */
+StoichiometryMatrix::StoichiometryMatrix(unsigned int numRows, unsigned int numColumns,
+                                         std::vector<StoichiometryEntry> entries)
+    : numRows(numRows), numColumns(numColumns), rowPointers(numRows + 1, 0) {
+  std::stable_sort(entries.begin(), entries.end(), [](const StoichiometryEntry &a, const StoichiometryEntry &b) {
+    return a.row < b.row || (a.row == b.row && a.column < b.column);
+  });
+
+  for (auto i = 0; i < entries.size(); i++) {
+    if (i > 0 && entries[i].row == entries[i - 1].row && entries[i].column == entries[i - 1].column) {
+      this->values.back() += entries[i].value;
+      continue;
+    }
+    this->columnIndices.push_back(entries[i].column);
+    this->values.push_back(entries[i].value);
+    this->rowPointers[entries[i].row + 1]++;
+  }
+
+  for (auto i = 0; i < numRows; i++) {
+    this->rowPointers[i + 1] += this->rowPointers[i];
+  }
+}
+
+StoichiometryMatrix::StoichiometryMatrix(const StoichiometryMatrix &matrix)
+    : numRows(matrix.numRows), numColumns(matrix.numColumns), rowPointers(matrix.rowPointers),
+      columnIndices(matrix.columnIndices), values(matrix.values) {
+  // nothing to do
+}
+
+StoichiometryMatrix::~StoichiometryMatrix() {
+  // nothing to do
+}
+
+unsigned int StoichiometryMatrix::getNumRows() const {
+  return this->numRows;
+}
+
+unsigned int StoichiometryMatrix::getNumColumns() const {
+  return this->numColumns;
+}
+
+unsigned int StoichiometryMatrix::getNumNonZeros() const {
+  return this->values.size();
+}
+
+const std::vector<unsigned int> &StoichiometryMatrix::getRowPointers() const {
+  return this->rowPointers;
+}
+
+const std::vector<unsigned int> &StoichiometryMatrix::getColumnIndices() const {
+  return this->columnIndices;
+}
+
+const std::vector<double> &StoichiometryMatrix::getValues() const {
+  return this->values;
+}
+
+unsigned int StoichiometryMatrix::findEntry(unsigned int row, unsigned int column) const {
+  for (auto k = this->rowPointers[row]; k < this->rowPointers[row + 1]; k++) {
+    if (this->columnIndices[k] == column) {
+      return k;
+    }
+  }
+  RuntimeExceptionUtil::throwInvalidFlowException();
+  return 0;
+}
+
+void StoichiometryMatrix::setValue(unsigned int entry, double value) {
+  this->values[entry] = value;
+}
+
+void StoichiometryMatrix::multiply(const double *v, double *y) const {
+  const unsigned int *rowPointers = this->rowPointers.data();
+  const unsigned int *columnIndices = this->columnIndices.data();
+  const double *values = this->values.data();
+  for (unsigned int i = 0; i < this->numRows; i++) {
+    double sum = 0.0;
+    for (unsigned int k = rowPointers[i]; k < rowPointers[i + 1]; k++) {
+      sum += values[k] * v[columnIndices[k]];
+    }
+    y[i] = sum;
+  }
+}
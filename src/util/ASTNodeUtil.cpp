@@ -65,8 +65,9 @@ ASTNode *ASTNodeUtil::reduceToBinary(const ASTNode *node) {
   auto type = node->getType();
   auto numChildren = node->getNumChildren();
 
-  // keep piecewise node
-  if (type == AST_FUNCTION_PIECEWISE) {
+  // keep piecewise and relational nodes (a < b < c is not (a < b) < c),
+  // binary, unary, variable or constant; reduce their children only
+  if (type == AST_FUNCTION_PIECEWISE || node->isRelational() || numChildren <= 2) {
     ASTNode *ret = node->deepCopy();
     for (auto i = 0; i < numChildren; i++) {
       auto newChild = reduceToBinary(ret->getChild(i));
@@ -75,11 +76,6 @@ ASTNode *ASTNodeUtil::reduceToBinary(const ASTNode *node) {
     return ret;
   }
 
-  // binary, unary, variable or constant
-  if (numChildren <= 2) {
-    return node->deepCopy();
-  }
-
   //
   //    F             F
   //  / | \          / \
@@ -90,10 +86,12 @@ ASTNode *ASTNodeUtil::reduceToBinary(const ASTNode *node) {
 
   auto rightNode = reduceToBinary(node->getRightChild());
 
-  auto leftNode = node->deepCopy();
-  auto rightOfLeftNode = leftNode->getRightChild();
-  leftNode->removeChild(leftNode->getNumChildren() - 1);
+  auto nodeWithoutLastChild = node->deepCopy();
+  auto rightOfLeftNode = nodeWithoutLastChild->getRightChild();
+  nodeWithoutLastChild->removeChild(nodeWithoutLastChild->getNumChildren() - 1);
   delete rightOfLeftNode;
+  auto leftNode = reduceToBinary(nodeWithoutLastChild);
+  delete nodeWithoutLastChild;
 
   auto *ret = node->deepCopy();
   while (ret->getNumChildren() > 0) {
@@ -107,3 +105,51 @@ ASTNode *ASTNodeUtil::reduceToBinary(const ASTNode *node) {
 
   return ret;
 }
+
+/*
+ * Turns csymbol time into an ordinary name so that MathUtil::differentiate can take d/dt.
+ */
+ASTNode *ASTNodeUtil::rewriteTimeToName(const ASTNode *node, const std::string &name) {
+  ASTNode *ret;
+
+  if (node->getType() == AST_NAME_TIME) {
+    ret = new ASTNode(AST_NAME);
+    ret->setName(name.c_str());
+    return ret;
+  }
+
+  ret = node->deepCopy();
+  for (auto i = 0; i < ret->getNumChildren(); i++) {
+    auto newChild = rewriteTimeToName(ret->getChild(i), name);
+    ret->replaceChild(i, newChild, DELETE_REPLACED_NODE);
+  }
+
+  return ret;
+}
+
+ASTNode *ASTNodeUtil::rewriteNameToTime(const ASTNode *node, const std::string &name) {
+  ASTNode *ret;
+
+  if (node->getType() == AST_NAME && name == node->getName()) {
+    ret = new ASTNode(AST_NAME_TIME);
+    ret->setName("time");
+    return ret;
+  }
+
+  ret = node->deepCopy();
+  for (auto i = 0; i < ret->getNumChildren(); i++) {
+    auto newChild = rewriteNameToTime(ret->getChild(i), name);
+    ret->replaceChild(i, newChild, DELETE_REPLACED_NODE);
+  }
+
+  return ret;
+}
+
+void ASTNodeUtil::collectNames(const ASTNode *node, std::set<std::string> &names) {
+  if (node->getType() == AST_NAME) {
+    names.insert(node->getName());
+  }
+  for (auto i = 0; i < node->getNumChildren(); i++) {
+    collectNames(node->getChild(i), names);
+  }
+}
@@ -1,5 +1,6 @@
 #include "sbmlsim/internal/util/MathUtil.h"
 #include <cmath>
+#include "sbmlsim/internal/util/RuntimeExceptionUtil.h"
 
 const unsigned long long FACTORIAL_TABLE[] = { // size 20
     1, 1, 2, 6, 24, 120, 720, 5040, 40320, 362880, 3628800, 39916800, 479001600, 6227020800,
@@ -51,9 +52,12 @@ ASTNode* MathUtil::differentiate(const ASTNode *ast, std::string target) {
       break;
     case AST_MINUS:
       /* d{u-v}/dx = du/dx - dv/dx */
+      /* d{-u}/dx = -du/dx */
       rtn->setType(AST_MINUS);
       rtn->addChild(differentiate(ast->getLeftChild(), target));
-      rtn->addChild(differentiate(ast->getRightChild(), target));
+      if (ast->getNumChildren() > 1) {
+        rtn->addChild(differentiate(ast->getRightChild(), target));
+      }
       break;
     case AST_TIMES: {
       /* d{u*v}/dx = u * dv/dx + v * du/dx */
@@ -703,6 +707,18 @@ ASTNode* MathUtil::differentiate(const ASTNode *ast, std::string target) {
     /**
      * Approximation block end.
      */
+    case AST_FUNCTION_PIECEWISE:
+      /* d{piecewise(u1, c1, u2, c2, ..., otherwise)}/dx = piecewise(du1/dx, c1, du2/dx, c2, ..., d{otherwise}/dx) */
+      /* Note: the derivative at the boundaries between pieces is not defined */
+      rtn->setType(AST_FUNCTION_PIECEWISE);
+      for (auto i = 0; i < ast->getNumChildren(); i++) {
+        if (i % 2 == 0) {
+          rtn->addChild(differentiate(ast->getChild(i), target));
+        } else {
+          rtn->addChild(ast->getChild(i)->deepCopy());
+        }
+      }
+      return rtn;
     case AST_REAL:
     case AST_INTEGER:
     case AST_NAME_TIME:
@@ -718,8 +734,7 @@ ASTNode* MathUtil::differentiate(const ASTNode *ast, std::string target) {
       }
       break;
     default:
-      std::cout << ast->getType() << " is unknown" << std::endl;
-      exit(1);
+      RuntimeExceptionUtil::throwUnknownNodeTypeException(ast->getType());
   }
   rtn->reduceToBinary();
   return rtn;
@@ -728,11 +743,8 @@ ASTNode* MathUtil::differentiate(const ASTNode *ast, std::string target) {
 bool MathUtil::containsTarget(const ASTNode *ast, std::string target)
 {
   bool found = false;
-  if (ast->getLeftChild() != nullptr) {
-    found |= containsTarget(ast->getLeftChild(), target);
-  }
-  if (ast->getRightChild() != nullptr) {
-    found |= containsTarget(ast->getRightChild(), target);
+  for (auto i = 0; i < ast->getNumChildren(); i++) {
+    found |= containsTarget(ast->getChild(i), target);
   }
   if (ast->getType() == AST_NAME) {
     std::string name = ast->getName();
@@ -743,6 +755,27 @@ bool MathUtil::containsTarget(const ASTNode *ast, std::string target)
   return found;
 }
 
+/*
+ * Whether differentiate() gives an exact derivative of ast. ceiling, floor and factorial are only
+ * approximated there, so callers that need a faithful Jacobian should fall back to finite differences.
+ */
+bool MathUtil::isDifferentiable(const ASTNode *ast) {
+  switch (ast->getType()) {
+    case AST_FUNCTION_CEILING:
+    case AST_FUNCTION_FLOOR:
+    case AST_FUNCTION_FACTORIAL:
+      return false;
+    default:
+      break;
+  }
+  for (auto i = 0; i < ast->getNumChildren(); i++) {
+    if (!isDifferentiable(ast->getChild(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 ASTNode* MathUtil::simplify(const ASTNode *ast) {
   ASTNodeType_t type = ast->getType();
   ASTNode *left, *right, *simplifiedRoot, *tmpl, *tmpr;
@@ -758,6 +791,19 @@ ASTNode* MathUtil::simplify(const ASTNode *ast) {
   left  = simplify(ast->getLeftChild());
   auto left_val = left->getValue();
 
+  // unary minus has no right child
+  if (type == AST_MINUS && ast->getNumChildren() == 1) {
+    if (left->isNumber()) {
+      simplifiedRoot = new ASTNode();
+      simplifiedRoot->setValue(-left_val);
+      delete left;
+    } else {
+      simplifiedRoot = new ASTNode(AST_MINUS);
+      simplifiedRoot->addChild(left);
+    }
+    return simplifiedRoot;
+  }
+
   // AST_FUNCTION_LN only has 1 argument
   if (ast->getType() == AST_FUNCTION_LN) {
     if (ast->getLeftChild()->getType() == AST_CONSTANT_E) {
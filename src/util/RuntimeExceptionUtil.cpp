@@ -20,6 +20,10 @@ void RuntimeExceptionUtil::throwArithmeticException() {
   throwRuntimeException("[RuntimeException] Arithmetic exception");
 }
 
+void RuntimeExceptionUtil::throwUnsupportedFeatureException(const std::string &feature) {
+  throwRuntimeException("[RuntimeException] Unsupported feature: " + feature);
+}
+
 void RuntimeExceptionUtil::throwRuntimeException(const std::string &message) {
   throw std::runtime_error(message);
 }
@@ -0,0 +1,78 @@
+#include "sbmlsim/internal/util/ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+    : task(NULL), count(0), next(0), generation(0), numBusy(0), stopping(false) {
+  if (numThreads == 0) {
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (unsigned int i = 0; i < numThreads; i++) {
+    this->workers.push_back(std::thread(&ThreadPool::work, this, i));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stopping = true;
+  }
+  this->started.notify_all();
+  for (auto &worker : this->workers) {
+    worker.join();
+  }
+}
+
+unsigned int ThreadPool::getNumThreads() const {
+  return this->workers.size();
+}
+
+// runs task(i, worker) for i in [0, count) and returns when all of them are done
+void ThreadPool::parallelFor(unsigned long count, const task_function &task) {
+  if (count == 0) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(this->mutex);
+  this->task = &task;
+  this->count = count;
+  this->next = 0;
+  this->error = std::exception_ptr();
+  this->numBusy = this->workers.size();
+  this->generation++;
+  this->started.notify_all();
+  this->finished.wait(lock, [this] { return this->numBusy == 0; });
+  this->task = NULL;
+  if (this->error) {
+    std::rethrow_exception(this->error);
+  }
+}
+
+void ThreadPool::work(unsigned int worker) {
+  unsigned long seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->started.wait(lock, [this, seen] { return this->stopping || this->generation != seen; });
+      if (this->stopping) {
+        return;
+      }
+      seen = this->generation;
+    }
+
+    for (auto i = this->next++; i < this->count; i = this->next++) {
+      try {
+        (*this->task)(i, worker);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (!this->error) {
+          this->error = std::current_exception();
+        }
+        this->next = this->count;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (--this->numBusy == 0) {
+      this->finished.notify_one();
+    }
+  }
+}
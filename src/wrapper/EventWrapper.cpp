@@ -1,22 +1,51 @@
 #include "sbmlsim/internal/wrapper/EventWrapper.h"
+#include "sbmlsim/internal/util/ASTNodeUtil.h"
 
 EventWrapper::EventWrapper(const Event *event) {
-  this->trigger = event->getTrigger()->getMath()->deepCopy();
-  this->triggerState = false;
+  auto trigger = event->getTrigger();
+  this->trigger = trigger->getMath()->deepCopy();
+
+  // Level 2 has neither attribute: triggers are persistent and start out false
+  this->persistent = trigger->isSetPersistent() ? trigger->getPersistent() : true;
+  this->initialValue = trigger->isSetInitialValue() ? trigger->getInitialValue() : false;
+  this->useValuesFromTriggerTime = event->getUseValuesFromTriggerTime();
+
+  auto functionDefinitions = event->getModel()->getListOfFunctionDefinitions();
+  if (event->isSetDelay()) {
+    this->delay = ASTNodeUtil::rewriteFunctionDefinition(event->getDelay()->getMath(), functionDefinitions);
+  } else {
+    this->delay = NULL;
+  }
+  if (event->isSetPriority()) {
+    this->priority = ASTNodeUtil::rewriteFunctionDefinition(event->getPriority()->getMath(), functionDefinitions);
+  } else {
+    this->priority = NULL;
+  }
 
   for (auto i = 0; i < event->getNumEventAssignments(); i++) {
     auto eventAssignment = event->getEventAssignment(i);
+    if (event->getModel()->getSpeciesReference(eventAssignment->getVariable()) != NULL) {
+      // stoichiometries of Level 3 species references are not simulated
+      continue;
+    }
     this->eventAssignments.push_back(EventAssignmentWrapper(eventAssignment));
   }
 }
 
 EventWrapper::EventWrapper(const EventWrapper &event) {
   this->trigger = event.trigger->deepCopy();
+  this->delay = event.delay != NULL ? event.delay->deepCopy() : NULL;
+  this->priority = event.priority != NULL ? event.priority->deepCopy() : NULL;
+  this->persistent = event.persistent;
+  this->initialValue = event.initialValue;
+  this->useValuesFromTriggerTime = event.useValuesFromTriggerTime;
   this->eventAssignments = event.eventAssignments;
 }
 
 EventWrapper::~EventWrapper() {
   delete this->trigger;
+  delete this->delay;
+  delete this->priority;
   this->eventAssignments.clear();
 }
 
@@ -24,14 +53,34 @@ const ASTNode *EventWrapper::getTrigger() const {
   return this->trigger;
 }
 
-const std::vector<EventAssignmentWrapper> &EventWrapper::getEventAssignments() const {
-  return this->eventAssignments;
+const ASTNode *EventWrapper::getDelay() const {
+  return this->delay;
+}
+
+const ASTNode *EventWrapper::getPriority() const {
+  return this->priority;
+}
+
+bool EventWrapper::hasDelay() const {
+  return this->delay != NULL;
+}
+
+bool EventWrapper::hasPriority() const {
+  return this->priority != NULL;
+}
+
+bool EventWrapper::isPersistent() const {
+  return this->persistent;
 }
 
-void EventWrapper::setTriggerState(bool triggerState) {
-  this->triggerState = triggerState;
+bool EventWrapper::getInitialValue() const {
+  return this->initialValue;
 }
 
-bool EventWrapper::getTriggerState() const {
-  return this->triggerState;
+bool EventWrapper::getUseValuesFromTriggerTime() const {
+  return this->useValuesFromTriggerTime;
+}
+
+const std::vector<EventAssignmentWrapper> &EventWrapper::getEventAssignments() const {
+  return this->eventAssignments;
 }
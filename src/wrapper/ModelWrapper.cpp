@@ -34,12 +34,19 @@ ModelWrapper::ModelWrapper(const Model *model) {
   // initial assignments
   for (auto i = 0; i < model->getNumInitialAssignments(); i++) {
     auto initialAssignment = model->getInitialAssignment(i);
+    if (model->getSpeciesReference(initialAssignment->getSymbol()) != NULL) {
+      // stoichiometries of Level 3 species references are not simulated
+      continue;
+    }
     this->initialAssignments.push_back(new InitialAssignmentWrapper(initialAssignment));
   }
 
   // rules
   for (auto i = 0; i < model->getNumRules(); i++) {
     auto rule = model->getRule(i);
+    if (model->getSpeciesReference(rule->getVariable()) != NULL) {
+      continue;
+    }
     if (rule->isAssignment()) {
       const AssignmentRule *assignmentRule = static_cast<const AssignmentRule *>(rule);
       this->assignmentRules.push_back(new AssignmentRuleWrapper(assignmentRule));
@@ -91,7 +98,7 @@ const std::vector<SpeciesWrapper> &ModelWrapper::getSpecieses() const {
   return this->specieses;
 }
 
-std::vector<ParameterWrapper *> &ModelWrapper::getParameters() {
+const std::vector<ParameterWrapper *> &ModelWrapper::getParameters() const {
   return this->parameters;
 }
 
@@ -103,18 +110,18 @@ const std::vector<ReactionWrapper> &ModelWrapper::getReactions() const {
   return this->reactions;
 }
 
-std::vector<EventWrapper *> &ModelWrapper::getEvents() {
+const std::vector<EventWrapper *> &ModelWrapper::getEvents() const {
   return this->events;
 }
 
-std::vector<InitialAssignmentWrapper *> &ModelWrapper::getInitialAssignments() {
+const std::vector<InitialAssignmentWrapper *> &ModelWrapper::getInitialAssignments() const {
   return this->initialAssignments;
 }
 
-std::vector<AssignmentRuleWrapper *> &ModelWrapper::getAssignmentRules() {
+const std::vector<AssignmentRuleWrapper *> &ModelWrapper::getAssignmentRules() const {
   return this->assignmentRules;
 }
 
-std::vector<RateRuleWrapper *> &ModelWrapper::getRateRules() {
+const std::vector<RateRuleWrapper *> &ModelWrapper::getRateRules() const {
   return this->rateRules;
 }
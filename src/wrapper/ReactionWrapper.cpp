@@ -3,6 +3,7 @@
 
 ReactionWrapper::ReactionWrapper(const Reaction *reaction) {
   this->id = reaction->getId();
+  this->reversible = reaction->getReversible();
   for (auto i = 0; i < reaction->getNumReactants(); i++) {
     auto reactant = reaction->getReactant(i);
     this->reactants.push_back(SpeciesReferenceWrapper(reactant));
@@ -16,12 +17,16 @@ ReactionWrapper::ReactionWrapper(const Reaction *reaction) {
   auto model = reaction->getModel();
 
   auto fdRewritedNode = ASTNodeUtil::rewriteFunctionDefinition(node, model->getListOfFunctionDefinitions());
-  this->math = ASTNodeUtil::rewriteLocalParameters(fdRewritedNode, reaction->getKineticLaw()->getListOfParameters());
+  auto lpRewritedNode = ASTNodeUtil::rewriteLocalParameters(fdRewritedNode,
+                                                            reaction->getKineticLaw()->getListOfParameters());
+  this->math = ASTNodeUtil::reduceToBinary(lpRewritedNode);
   delete fdRewritedNode;
+  delete lpRewritedNode;
 }
 
 ReactionWrapper::ReactionWrapper(const ReactionWrapper &reaction) {
   this->id = reaction.id;
+  this->reversible = reaction.reversible;
   this->reactants = reaction.reactants;
   this->products = reaction.products;
   this->math = reaction.math->deepCopy();
@@ -45,6 +50,10 @@ const std::vector<SpeciesReferenceWrapper> &ReactionWrapper::getProducts() const
   return this->products;
 }
 
-const ASTNode *ReactionWrapper::getMath() {
+const ASTNode *ReactionWrapper::getMath() const {
   return this->math;
 }
+
+bool ReactionWrapper::isReversible() const {
+  return this->reversible;
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+#include "sbmlsim/internal/integrate/AutoSwitchingStepper.h"
+
+namespace {
+
+  using state = AutoSwitchingStepper::state;
+  using matrix = AutoSwitchingStepper::matrix;
+
+  void oscillator(const state &x, state &dxdt, double t) {
+    dxdt[0] = x[1];
+    dxdt[1] = -x[0];
+  }
+
+  void oscillatorJacobian(const state &x, matrix &J, double t) {
+    J(0, 0) = 0.0;
+    J(0, 1) = 1.0;
+    J(1, 0) = -1.0;
+    J(1, 1) = 0.0;
+  }
+
+  // Robertson's chemical kinetics
+  void robertson(const state &x, state &dxdt, double t) {
+    dxdt[0] = -0.04 * x[0] + 1e4 * x[1] * x[2];
+    dxdt[1] = 0.04 * x[0] - 1e4 * x[1] * x[2] - 3e7 * x[1] * x[1];
+    dxdt[2] = 3e7 * x[1] * x[1];
+  }
+
+  void robertsonJacobian(const state &x, matrix &J, double t) {
+    J(0, 0) = -0.04;
+    J(0, 1) = 1e4 * x[2];
+    J(0, 2) = 1e4 * x[1];
+    J(1, 0) = 0.04;
+    J(1, 1) = -1e4 * x[2] - 6e7 * x[1];
+    J(1, 2) = -1e4 * x[1];
+    J(2, 0) = 0.0;
+    J(2, 1) = 6e7 * x[1];
+    J(2, 2) = 0.0;
+  }
+
+  // y' = -lambda(t) (y - cos t) - sin t with y = cos t, stiff at first and non-stiff once lambda has decayed
+  void decayingStiffness(const state &x, state &dxdt, double t) {
+    dxdt[0] = -1e5 * std::exp(-t) * (x[0] - std::cos(t)) - std::sin(t);
+  }
+
+  void decayingStiffnessJacobian(const state &x, matrix &J, double t) {
+    J(0, 0) = -1e5 * std::exp(-t);
+  }
+
+  class AutoSwitchingStepperTest : public ::testing::Test {};
+
+  TEST_F(AutoSwitchingStepperTest, staysExplicitForNonStiffProblems) {
+    AutoSwitchingStepper stepper(oscillatorJacobian, 1e-10, 1e-8);
+    state x(2);
+    x[0] = 1.0;
+    x[1] = 0.0;
+    odeint::integrate_adaptive(std::ref(stepper), oscillator, x, 0.0, 20.0, 0.1);
+
+    EXPECT_FALSE(stepper.isStiff());
+    EXPECT_EQ(0u, stepper.getNumSwitches());
+    EXPECT_NEAR(std::cos(20.0), x[0], 1e-6);
+  }
+
+  TEST_F(AutoSwitchingStepperTest, switchesToBDFForStiffProblems) {
+    AutoSwitchingStepper stepper(robertsonJacobian, 1e-10, 1e-6);
+    state x(3);
+    x[0] = 1.0;
+    x[1] = 0.0;
+    x[2] = 0.0;
+    odeint::integrate_adaptive(std::ref(stepper), robertson, x, 0.0, 40.0, 0.1);
+
+    EXPECT_TRUE(stepper.isStiff());
+    EXPECT_NEAR(0.7158270687, x[0], 1e-4);
+    EXPECT_NEAR(9.185534764e-6, x[1], 1e-8);
+    EXPECT_NEAR(0.2841637457, x[2], 1e-4);
+  }
+
+  TEST_F(AutoSwitchingStepperTest, switchesBackToExplicitForNonStiffProblems) {
+    AutoSwitchingStepper stepper(decayingStiffnessJacobian, 1e-8, 1e-6);
+    state x(1);
+    x[0] = 1.0;
+    odeint::integrate_adaptive(std::ref(stepper), decayingStiffness, x, 0.0, 30.0, 1e-4);
+
+    EXPECT_FALSE(stepper.isStiff());
+    EXPECT_GE(stepper.getNumSwitches(), 2u);
+    EXPECT_NEAR(std::cos(30.0), x[0], 1e-6);
+  }
+
+  TEST_F(AutoSwitchingStepperTest, restartsExplicitStepperWhenStateIsChanged) {
+    unsigned int evaluations = 0;
+    auto system = [&evaluations](const state &x, state &dxdt, double t) {
+      evaluations++;
+      oscillator(x, dxdt, t);
+    };
+    AutoSwitchingStepper stepper(oscillatorJacobian, 1e-10, 1e-8);
+    state x(2);
+    x[0] = 1.0;
+    x[1] = 0.0;
+    odeint::integrate_adaptive(std::ref(stepper), system, x, 0.0, 1.0, 0.1);
+
+    // an event moves the state between two calls, as sbmlsim::integrate_const does
+    x[0] = 2.0;
+    x[1] = 0.0;
+    evaluations = 0;
+    odeint::integrate_adaptive(std::ref(stepper), system, x, 1.0, 2.0, 0.1);
+    auto continued = evaluations;
+
+    AutoSwitchingStepper fresh(oscillatorJacobian, 1e-10, 1e-8);
+    state y(2);
+    y[0] = 2.0;
+    y[1] = 0.0;
+    evaluations = 0;
+    odeint::integrate_adaptive(std::ref(fresh), system, y, 1.0, 2.0, 0.1);
+
+    // a stale FSAL derivative would show up as rejected steps
+    EXPECT_EQ(evaluations, continued);
+    EXPECT_NEAR(2.0 * std::cos(1.0), x[0], 1e-6);
+    EXPECT_NEAR(-2.0 * std::sin(1.0), x[1], 1e-6);
+  }
+
+}  // namespace
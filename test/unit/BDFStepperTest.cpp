@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+#include "sbmlsim/internal/integrate/BDFStepper.h"
+
+namespace {
+
+  using state = BDFStepper::state;
+  using matrix = BDFStepper::matrix;
+
+  // y' = -1000 * (y - cos(t)) - sin(t), y(0) = 1; the solution is cos(t)
+  void prothero(const state &x, state &dxdt, double t) {
+    dxdt[0] = -1000.0 * (x[0] - std::cos(t)) - std::sin(t);
+  }
+
+  void protheroJacobian(const state &x, matrix &J, double t) {
+    J(0, 0) = -1000.0;
+  }
+
+  // Robertson's chemical kinetics
+  void robertson(const state &x, state &dxdt, double t) {
+    dxdt[0] = -0.04 * x[0] + 1e4 * x[1] * x[2];
+    dxdt[1] = 0.04 * x[0] - 1e4 * x[1] * x[2] - 3e7 * x[1] * x[1];
+    dxdt[2] = 3e7 * x[1] * x[1];
+  }
+
+  void robertsonJacobian(const state &x, matrix &J, double t) {
+    J(0, 0) = -0.04;
+    J(0, 1) = 1e4 * x[2];
+    J(0, 2) = 1e4 * x[1];
+    J(1, 0) = 0.04;
+    J(1, 1) = -1e4 * x[2] - 6e7 * x[1];
+    J(1, 2) = -1e4 * x[1];
+    J(2, 0) = 0.0;
+    J(2, 1) = 6e7 * x[1];
+    J(2, 2) = 0.0;
+  }
+
+  // prothero for x[0]; x[1] = x[0]^2 is held by the caller like the target of an assignment rule
+  void protheroWithRule(const state &x, state &dxdt, double t) {
+    dxdt[0] = -1000.0 * (x[0] - std::cos(t)) - std::sin(t);
+    dxdt[1] = 0.0;
+  }
+
+  void protheroWithRuleJacobian(const state &x, matrix &J, double t) {
+    J(0, 0) = -1000.0;
+    J(0, 1) = 0.0;
+    J(1, 0) = 0.0;
+    J(1, 1) = 0.0;
+  }
+
+  class BDFStepperTest : public ::testing::Test {};
+
+  TEST_F(BDFStepperTest, stiffLinear) {
+    BDFStepper stepper(protheroJacobian, 1e-8, 1e-6);
+    state x(1);
+    x[0] = 1.0;
+    odeint::integrate_adaptive(std::ref(stepper), prothero, x, 0.0, 10.0, 0.1);
+
+    EXPECT_NEAR(std::cos(10.0), x[0], 1e-5);
+    EXPECT_LT(stepper.getNumSteps(), 2000u);
+    EXPECT_GT(stepper.getOrder(), 1u);
+    // the LU factors are reused across steps
+    EXPECT_LT(stepper.getNumFactorizations(), stepper.getNumSteps() / 2);
+  }
+
+  TEST_F(BDFStepperTest, robertson) {
+    BDFStepper stepper(robertsonJacobian, 1e-10, 1e-6);
+    state x(3);
+    x[0] = 1.0;
+    x[1] = 0.0;
+    x[2] = 0.0;
+    odeint::integrate_adaptive(std::ref(stepper), robertson, x, 0.0, 40.0, 0.1);
+
+    EXPECT_NEAR(0.7158270687, x[0], 1e-4);
+    EXPECT_NEAR(9.185534764e-6, x[1], 1e-8);
+    EXPECT_NEAR(0.2841637457, x[2], 1e-4);
+    EXPECT_LT(stepper.getNumJacobianEvaluations(), stepper.getNumSteps());
+  }
+
+  TEST_F(BDFStepperTest, restartsAfterDiscontinuity) {
+    BDFStepper stepper(protheroJacobian, 1e-8, 1e-6);
+    state x(1);
+    x[0] = 1.0;
+    double t = 0.0;
+    double dt = 0.1;
+    odeint::integrate_adaptive(std::ref(stepper), prothero, x, t, 1.0, dt);
+    ASSERT_GT(stepper.getOrder(), 1u);
+
+    // an event assignment changes the state between two calls
+    x[0] += 1.0;
+    t = 1.0;
+    dt = 0.1;
+    while (stepper.try_step(prothero, x, t, dt) == odeint::fail) {
+      // the first attempt is refused with a smaller step
+    }
+    EXPECT_EQ(1u, stepper.getOrder());
+    odeint::integrate_adaptive(std::ref(stepper), prothero, x, t, 2.0, dt);
+    EXPECT_NEAR(std::cos(2.0), x[0], 1e-5);
+  }
+
+  // output points every 0.01 must neither shrink the steps nor restart the history
+  TEST_F(BDFStepperTest, outputPointsDoNotLimitSteps) {
+    BDFStepper free(protheroWithRuleJacobian, 1e-8, 1e-6);
+    state x(2);
+    x[0] = 1.0;
+    x[1] = 1.0;
+    odeint::integrate_adaptive(std::ref(free), protheroWithRule, x, 0.0, 10.0, 0.01);
+    ASSERT_GT(free.getOrder(), 1u);
+
+    BDFStepper stepper(protheroWithRuleJacobian, 1e-8, 1e-6);
+    stepper.setAlgebraicComponents({1});
+    x[0] = 1.0;
+    x[1] = 1.0;
+    double t = 0.0;
+    for (auto step = 1; step <= 1000; step++) {
+      double next = 0.01 * step;
+      odeint::integrate_adaptive(std::ref(stepper), protheroWithRule, x, t, next, 0.01);
+      t = next;
+      x[1] = x[0] * x[0];
+      EXPECT_NEAR(std::cos(t), x[0], 1e-5);
+    }
+
+    // 1000 output points against a few hundred free steps; every restart would evaluate J again
+    EXPECT_LT(stepper.getNumSteps(), free.getNumSteps() + free.getNumSteps() / 5);
+    EXPECT_LE(stepper.getNumJacobianEvaluations(), free.getNumJacobianEvaluations() + 2);
+    EXPECT_GT(stepper.getOrder(), 1u);
+    EXPECT_GT(stepper.getStepSize(), 0.01);
+  }
+
+}  // namespace
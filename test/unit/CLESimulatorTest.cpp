@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "sbmlsim/internal/stochastic/CLESimulator.h"
+#include "sbmlsim/internal/stochastic/StochasticEnsemble.h"
+
+namespace {
+
+  // A -> B with kf * A and B -> A with kb * B, in molecule counts
+  const char *MODEL_ISOMERIZATION =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"isomerization\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"A\" compartment=\"compartment\" initialAmount=\"1000\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"B\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"kf\" value=\"1\"/>"
+      "      <parameter id=\"kb\" value=\"0.5\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"forward\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> kf </ci><ci> A </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "      <reaction id=\"backward\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> kb </ci><ci> B </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  class CLESimulatorTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      SBMLReader reader;
+      document = reader.readSBMLFromString(MODEL_ISOMERIZATION);
+      model = new ModelWrapper(document->getModel());
+    }
+    void TearDown() override {
+      delete model;
+      delete document;
+    }
+    SBMLDocument *document;
+    ModelWrapper *model;
+  };
+
+  TEST_F(CLESimulatorTest, matchesTheMomentsOfTheIsomerization) {
+    SBMLSystem system(model);
+    std::vector<ObserveTarget> targets {ObserveTarget("A", system.getStateIndexForVariable("A")),
+                                        ObserveTarget("B", system.getStateIndexForVariable("B"))};
+    StochasticEnsemble ensemble(system, targets, 4);
+    for (auto scheme : {CLEScheme::EULER_MARUYAMA, CLEScheme::MILSTEIN}) {
+      std::function<CLESimulator(SBMLSystem &)> factory = [scheme](SBMLSystem &system) {
+        return CLESimulator(system, 12345, 0.01, scheme);
+      };
+      auto statistics = ensemble.run(400, 0.0, 1.0, 1.0, factory);
+
+      // binomial(1000, p) with p = 1 / 3 + 2 / 3 exp(-1.5), up to the O(h) bias of the schemes
+      double p = 1.0 / 3.0 + 2.0 / 3.0 * std::exp(-1.5);
+      EXPECT_NEAR(1000.0 * p, statistics.means[1][0], 6.0);
+      EXPECT_NEAR(1000.0, statistics.means[1][0] + statistics.means[1][1], 1e-6);
+      EXPECT_NEAR(1000.0 * p * (1.0 - p), statistics.variances[1][0], 60.0);
+    }
+  }
+
+  TEST_F(CLESimulatorTest, endsExactlyAtSampleTimes) {
+    SBMLSystem system(model);
+    CLESimulator simulator(system, 12345, 0.03, CLEScheme::MILSTEIN);
+    auto x = system.getInitialState();
+    double t = 0.0;
+    simulator.initialize(x, t);
+    while (simulator.step(x, t, 0.1)) {
+      // nothing to do
+    }
+    EXPECT_EQ(0.1, t);
+    EXPECT_EQ(4u, simulator.getNumSteps());
+  }
+
+}  // namespace
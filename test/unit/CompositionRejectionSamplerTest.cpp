@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "sbmlsim/internal/stochastic/CompositionRejectionSampler.h"
+
+namespace {
+
+  class CompositionRejectionSamplerTest : public ::testing::Test {};
+
+  TEST_F(CompositionRejectionSamplerTest, selectsProportionallyToPropensities) {
+    // propensities spread over several groups
+    const double propensities[] = {0.1, 3.0, 0.0, 12.5, 0.7, 40.0};
+    CompositionRejectionSampler sampler(6);
+    double total = 0.0;
+    for (auto j = 0; j < 6; j++) {
+      sampler.update(j, propensities[j]);
+      total += propensities[j];
+    }
+    EXPECT_DOUBLE_EQ(total, sampler.getTotal());
+
+    std::mt19937_64 engine(42);
+    std::vector<unsigned int> counts(6, 0);
+    const unsigned int n = 200000;
+    for (auto i = 0; i < n; i++) {
+      counts[sampler.select(engine)]++;
+    }
+    EXPECT_EQ(0u, counts[2]);
+    for (auto j = 0; j < 6; j++) {
+      double p = propensities[j] / total;
+      EXPECT_NEAR(p, static_cast<double>(counts[j]) / n, 4.0 * std::sqrt(p * (1.0 - p) / n) + 1e-12);
+    }
+  }
+
+  TEST_F(CompositionRejectionSamplerTest, updatesMoveReactionsBetweenGroups) {
+    CompositionRejectionSampler sampler(3);
+    sampler.update(0, 1.0);
+    sampler.update(1, 1000.0);
+    sampler.update(2, 5.0);
+    sampler.update(1, 0.0);
+    sampler.update(0, 1e-3);
+    sampler.update(2, 6.0);
+
+    EXPECT_NEAR(6.001, sampler.getTotal(), 1e-12);
+    EXPECT_DOUBLE_EQ(0.0, sampler.getPropensity(1));
+
+    std::mt19937_64 engine(7);
+    unsigned int first = 0;
+    for (auto i = 0; i < 10000; i++) {
+      auto j = sampler.select(engine);
+      ASSERT_NE(1u, j);
+      first += j == 0 ? 1 : 0;
+    }
+    EXPECT_LT(first, 20u);
+  }
+
+  TEST_F(CompositionRejectionSamplerTest, groupSumsDoNotDrift) {
+    // many in-group updates of widely different magnitudes leave the sums with no accumulated rounding
+    CompositionRejectionSampler sampler(4);
+    std::mt19937_64 engine(3);
+    std::uniform_real_distribution<double> uniform(1.0, 2.0);
+    std::vector<double> propensities(4);
+    for (auto i = 0; i < 100000; i++) {
+      auto j = i % 4;
+      propensities[j] = j == 0 ? 1e12 * uniform(engine) : uniform(engine);
+      sampler.update(j, propensities[j]);
+    }
+    for (auto j = 0; j < 4; j++) {
+      propensities[j] = 1.0;
+      sampler.update(j, 1.0);
+    }
+
+    EXPECT_DOUBLE_EQ(4.0, sampler.getTotal());
+  }
+
+}  // namespace
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "sbmlsim/internal/system/EventQueue.h"
+
+namespace {
+
+  class EventQueueTest : public ::testing::Test {};
+
+  TEST_F(EventQueueTest, popsInTimeOrder) {
+    EventQueue queue(3);
+    queue.schedule(2.0, 0, {});
+    queue.schedule(0.5, 1, {});
+    queue.schedule(1.0, 2, {1.5});
+    EXPECT_DOUBLE_EQ(0.5, queue.getNextTime());
+    EXPECT_EQ(1u, queue.pop().event);
+    auto scheduled = queue.pop();
+    EXPECT_EQ(2u, scheduled.event);
+    ASSERT_EQ(1u, scheduled.values.size());
+    EXPECT_DOUBLE_EQ(1.5, scheduled.values[0]);
+    EXPECT_EQ(0u, queue.pop().event);
+    EXPECT_TRUE(queue.empty());
+    EXPECT_TRUE(std::isinf(queue.getNextTime()));
+  }
+
+  TEST_F(EventQueueTest, simultaneousExecutionsKeepSchedulingOrder) {
+    EventQueue queue(3);
+    queue.schedule(1.0, 2, {});
+    queue.schedule(1.0, 0, {});
+    queue.schedule(1.0, 1, {});
+    EXPECT_EQ(2u, queue.pop().event);
+    EXPECT_EQ(0u, queue.pop().event);
+    EXPECT_EQ(1u, queue.pop().event);
+  }
+
+  TEST_F(EventQueueTest, cancelDropsPendingExecutionsOnly) {
+    EventQueue queue(2);
+    queue.schedule(1.0, 0, {});
+    queue.schedule(2.0, 1, {});
+    queue.schedule(3.0, 0, {});
+    queue.cancel(0);
+    queue.schedule(4.0, 0, {});
+
+    EXPECT_DOUBLE_EQ(2.0, queue.getNextTime());
+    EXPECT_EQ(1u, queue.pop().event);
+    auto scheduled = queue.pop();
+    EXPECT_EQ(0u, scheduled.event);
+    EXPECT_DOUBLE_EQ(4.0, scheduled.time);
+    EXPECT_FALSE(queue.isCancelled(scheduled));
+    EXPECT_TRUE(queue.empty());
+  }
+
+}  // namespace
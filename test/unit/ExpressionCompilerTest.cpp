@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "sbmlsim/internal/compiler/ExpressionCompiler.h"
+
+namespace {
+
+  class ExpressionCompilerTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      symbolTable.addVariable("x", 0);
+      symbolTable.addVariable("y", 1);
+      symbolTable.addVariable("c", 2);
+      symbolTable.addConcentration("s", 3, 2);
+      symbolTable.addConstant("k", 0);
+      symbolTable.addConstant("V", 1);
+      symbolTable.addConstantSizeConcentration("u", 3, 1);
+    }
+    double evaluate(const std::string &formula, double t = 0.0) {
+      ASTNode *ast = SBML_parseL3Formula(formula.c_str());
+      CompiledExpression expression = ExpressionCompiler::compile(ast, symbolTable);
+      delete ast;
+      std::vector<double> stack(expression.getStackSize());
+      return expression.evaluate(state.data(), constants.data(), t, stack.data());
+    }
+    double tangent(const std::string &formula, const TangentSeed &seed, double t = 0.0) {
+      ASTNode *ast = SBML_parseL3Formula(formula.c_str());
+      CompiledExpression expression = ExpressionCompiler::compile(ast, symbolTable);
+      delete ast;
+      std::vector<double> stack(expression.getStackSize());
+      std::vector<double> tangents(expression.getStackSize());
+      double ret;
+      expression.evaluateTangent(state.data(), constants.data(), t, seed, stack.data(), tangents.data(), &ret);
+      return ret;
+    }
+    SymbolTable symbolTable;
+    std::vector<double> state {2.0, 3.0, 4.0, 10.0};
+    std::vector<double> constants {0.5, 5.0};
+  };
+
+  TEST_F(ExpressionCompilerTest, arithmetic) {
+    EXPECT_DOUBLE_EQ(7.0, evaluate("x + y * 2 - 1"));
+    EXPECT_DOUBLE_EQ(-2.0, evaluate("-x"));
+    EXPECT_DOUBLE_EQ(8.0, evaluate("x ^ y"));
+    EXPECT_DOUBLE_EQ(1.0, evaluate("x / 2"));
+  }
+
+  TEST_F(ExpressionCompilerTest, concentration) {
+    EXPECT_DOUBLE_EQ(2.5, evaluate("s"));
+    EXPECT_DOUBLE_EQ(5.0, evaluate("s * x"));
+  }
+
+  TEST_F(ExpressionCompilerTest, constants) {
+    EXPECT_DOUBLE_EQ(1.0, evaluate("k * x"));
+    EXPECT_DOUBLE_EQ(2.0, evaluate("u"));
+    EXPECT_DOUBLE_EQ(2.5, evaluate("V * k"));
+  }
+
+  TEST_F(ExpressionCompilerTest, functions) {
+    EXPECT_DOUBLE_EQ(3.0, evaluate("root(3, 27)"));
+    EXPECT_DOUBLE_EQ(24.0, evaluate("factorial(4)"));
+    EXPECT_DOUBLE_EQ(3.0, evaluate("ceil(2.1)"));
+    EXPECT_DOUBLE_EQ(1.0, evaluate("exp(0) * cos(0)"));
+  }
+
+  TEST_F(ExpressionCompilerTest, time) {
+    EXPECT_DOUBLE_EQ(3.0, evaluate("time * 2", 1.5));
+  }
+
+  TEST_F(ExpressionCompilerTest, relational) {
+    EXPECT_DOUBLE_EQ(1.0, evaluate("x < y"));
+    EXPECT_DOUBLE_EQ(0.0, evaluate("x >= y"));
+    EXPECT_DOUBLE_EQ(1.0, evaluate("x > 1 && !(y > 5)"));
+  }
+
+  TEST_F(ExpressionCompilerTest, piecewise) {
+    EXPECT_DOUBLE_EQ(20.0, evaluate("piecewise(10, x > 3, 20, y > 2, 30)"));
+    EXPECT_DOUBLE_EQ(31.0, evaluate("piecewise(10, x > 3, 20, y > 5, 30) + 1"));
+  }
+
+  TEST_F(ExpressionCompilerTest, tangent) {
+    std::vector<double> dx {1.0, 0.0, 0.0, 0.0};
+    std::vector<double> dc {0.0, 0.0, 1.0, 0.0};
+    std::vector<double> dk {1.0, 0.0};
+    EXPECT_DOUBLE_EQ(12.0, tangent("x ^ y", {dx.data(), nullptr, 0.0}));
+    EXPECT_DOUBLE_EQ(3.0 * std::exp(6.0), tangent("exp(x * y)", {dx.data(), nullptr, 0.0}));
+    EXPECT_DOUBLE_EQ(-0.625, tangent("s", {dc.data(), nullptr, 0.0}));
+    EXPECT_DOUBLE_EQ(2.0, tangent("k * x", {nullptr, dk.data(), 0.0}));
+    EXPECT_DOUBLE_EQ(4.0, tangent("time * x", {nullptr, nullptr, 1.0}));
+    EXPECT_DOUBLE_EQ(0.0, tangent("piecewise(x, x > 3, 2 * x)", {nullptr, nullptr, 0.0}));
+    EXPECT_DOUBLE_EQ(2.0, tangent("piecewise(x, x > 3, 2 * x)", {dx.data(), nullptr, 0.0}));
+    EXPECT_DOUBLE_EQ(0.0, tangent("ceil(x) + factorial(y)", {dx.data(), nullptr, 0.0}));
+  }
+
+  TEST_F(ExpressionCompilerTest, stackSize) {
+    ASTNode *ast = SBML_parseL3Formula("x + (y + (x + (y + 1)))");
+    CompiledExpression expression = ExpressionCompiler::compile(ast, symbolTable);
+    delete ast;
+    EXPECT_EQ(5u, expression.getStackSize());
+  }
+
+}  // namespace
@@ -0,0 +1,19 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "sbmlsim/internal/util/HashUtil.h"
+
+namespace {
+
+  class HashUtilTest : public ::testing::Test {};
+
+  // test vectors of FIPS 180-4
+  TEST_F(HashUtilTest, sha256) {
+    EXPECT_EQ("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", HashUtil::sha256(""));
+    EXPECT_EQ("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", HashUtil::sha256("abc"));
+    EXPECT_EQ("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+              HashUtil::sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"));
+    EXPECT_EQ("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+              HashUtil::sha256(std::string(1000000, 'a')));
+  }
+
+}  // namespace
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include "sbmlsim/internal/stochastic/HybridSimulator.h"
+
+namespace {
+
+  // A -> B -> C with k1 * A and k2 * B, in molecule counts
+  const char *MODEL_CHAIN =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"hybridChain\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"A\" compartment=\"compartment\" initialAmount=\"10000\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"B\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"C\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"1\"/>"
+      "      <parameter id=\"k2\" value=\"0.01\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> A </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "      <reaction id=\"reaction2\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"C\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k2 </ci><ci> B </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  class HybridSimulatorTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      SBMLReader reader;
+      document = reader.readSBMLFromString(MODEL_CHAIN);
+      model = new ModelWrapper(document->getModel());
+    }
+    void TearDown() override {
+      delete model;
+      delete document;
+    }
+    SBMLDocument *document;
+    ModelWrapper *model;
+  };
+
+  TEST_F(HybridSimulatorTest, integratesAbundantSpeciesContinuously) {
+    SBMLSystem system(model);
+    HybridSimulator simulator(system, 12345, 1e-6, 1e-8);
+    auto x = system.getInitialState();
+    auto a = system.getStateIndexForVariable("A");
+    auto b = system.getStateIndexForVariable("B");
+    auto c = system.getStateIndexForVariable("C");
+    x[a] = 1e6;
+    double t = 0.0;
+    simulator.initialize(x, t);
+    EXPECT_EQ(1u, simulator.getNumFastReactions());
+    while (simulator.step(x, t, 1.0)) {
+      // nothing to do
+    }
+
+    // reaction2 fires slowly until B is abundant enough to join the rate equation
+    EXPECT_EQ(2u, simulator.getNumFastReactions());
+    EXPECT_NEAR(1e6, x[a] + x[b] + x[c], 1e-3);
+    EXPECT_NEAR(1e6 * std::exp(-1.0), x[a], 1.0);
+  }
+
+  TEST_F(HybridSimulatorTest, firesScarceSpeciesStochastically) {
+    SBMLSystem system(model);
+    HybridSimulator simulator(system, 12345, 1e-6, 1e-8);
+    auto x = system.getInitialState();
+    auto a = system.getStateIndexForVariable("A");
+    auto b = system.getStateIndexForVariable("B");
+    auto c = system.getStateIndexForVariable("C");
+    x[a] = 5.0;
+    double t = 0.0;
+    simulator.initialize(x, t);
+    while (simulator.step(x, t, 3000.0)) {
+      // nothing to do
+    }
+
+    EXPECT_EQ(0u, simulator.getNumFastReactions());
+    EXPECT_DOUBLE_EQ(0.0, x[a]);
+    EXPECT_DOUBLE_EQ(0.0, x[b]);
+    EXPECT_DOUBLE_EQ(5.0, x[c]);
+    EXPECT_EQ(10u, simulator.getNumFirings());
+  }
+
+  TEST_F(HybridSimulatorTest, repartitionsAsCountsChange) {
+    SBMLSystem system(model);
+    HybridSimulator simulator(system, 12345, 1e-6, 1e-8);
+    auto x = system.getInitialState();
+    auto a = system.getStateIndexForVariable("A");
+    auto b = system.getStateIndexForVariable("B");
+    auto c = system.getStateIndexForVariable("C");
+    double t = 0.0;
+    simulator.initialize(x, t);
+    std::vector<unsigned int> numFastReactions {simulator.getNumFastReactions()};
+    for (auto sample = 1; sample <= 20; sample++) {
+      while (simulator.step(x, t, 0.5 * sample)) {
+        // nothing to do
+      }
+      numFastReactions.push_back(simulator.getNumFastReactions());
+    }
+
+    // reaction1 alone at first, then both once B has built up, then reaction2 alone once A has run out
+    EXPECT_EQ(1u, numFastReactions.front());
+    EXPECT_EQ(2u, *std::max_element(numFastReactions.begin(), numFastReactions.end()));
+    EXPECT_EQ(1u, numFastReactions.back());
+    EXPECT_LT(x[a], 100.0);
+    EXPECT_NEAR(1e4, x[a] + x[b] + x[c], 1e-3);
+    EXPECT_NEAR(1e4 * (std::exp(-0.1) - std::exp(-10.0)) / 0.99, x[b], 20.0);
+  }
+
+  TEST_F(HybridSimulatorTest, repartitionsBetweenSampleTimes) {
+    SBMLSystem system(model);
+    HybridSimulator simulator(system, 12345, 1e-6, 1e-8);
+    auto x = system.getInitialState();
+    auto a = system.getStateIndexForVariable("A");
+    auto b = system.getStateIndexForVariable("B");
+    auto c = system.getStateIndexForVariable("C");
+    double t = 0.0;
+    simulator.initialize(x, t);
+    while (simulator.step(x, t, 10.0)) {
+      // nothing to do
+    }
+
+    // once reaction2 is fast no slow firing is left to stop at, yet reaction1 has to turn slow when A drops below
+    // 100 at t = 4.6 and fire its last molecules one at a time
+    EXPECT_EQ(1u, simulator.getNumFastReactions());
+    EXPECT_GT(simulator.getNumFirings(), 50u);
+    EXPECT_NEAR(1e4, x[a] + x[b] + x[c], 1e-3);
+  }
+
+}  // namespace
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "sbmlsim/internal/stochastic/IndexedPriorityQueue.h"
+
+namespace {
+
+  class IndexedPriorityQueueTest : public ::testing::Test {};
+
+  TEST_F(IndexedPriorityQueueTest, startsWithInfiniteTimes) {
+    IndexedPriorityQueue queue(3);
+    EXPECT_EQ(3u, queue.size());
+    EXPECT_TRUE(std::isinf(queue.getTime(queue.top())));
+  }
+
+  TEST_F(IndexedPriorityQueueTest, topFollowsUpdates) {
+    IndexedPriorityQueue queue(4);
+    queue.update(0, 3.0);
+    queue.update(1, 1.0);
+    queue.update(2, 2.0);
+    queue.update(3, 4.0);
+    EXPECT_EQ(1u, queue.top());
+
+    queue.update(1, 5.0);
+    EXPECT_EQ(2u, queue.top());
+    queue.update(3, 0.5);
+    EXPECT_EQ(3u, queue.top());
+    EXPECT_DOUBLE_EQ(5.0, queue.getTime(1));
+  }
+
+  TEST_F(IndexedPriorityQueueTest, randomUpdatesKeepTheMinimumOnTop) {
+    const unsigned int n = 100;
+    IndexedPriorityQueue queue(n);
+    std::vector<double> times(n);
+    std::mt19937_64 engine(1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::uniform_int_distribution<unsigned int> index(0, n - 1);
+    for (auto i = 0; i < n; i++) {
+      times[i] = uniform(engine);
+      queue.update(i, times[i]);
+    }
+    for (auto k = 0; k < 10000; k++) {
+      auto i = index(engine);
+      times[i] = uniform(engine);
+      queue.update(i, times[i]);
+      auto minimum = *std::min_element(times.begin(), times.end());
+      ASSERT_DOUBLE_EQ(minimum, queue.getTime(queue.top()));
+    }
+  }
+
+}  // namespace
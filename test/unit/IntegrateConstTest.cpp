@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstddef>
+#include <boost/numeric/ublas/vector.hpp>
+#include "sbmlsim/internal/integrate/IntegrateConst.h"
+
+namespace {
+
+  // x' = -x, with an event adding 1 to x at t = 5
+  class DecaySystem {
+   public:
+    using state = boost::numeric::ublas::vector<double>;
+    DecaySystem() : triggered(false) {}
+    void operator()(const state &x, state &dxdt, double t) {
+      dxdt[0] = -x[0];
+    }
+    void handleInitialAssignment(state &x, double t) {}
+    void handleAssignmentRule(state &x, double t) {}
+    void handleEvent(state &x, double t) {
+      if (evaluateEventFunction(0, x, t) > 0.0 && !triggered) {
+        x[0] += 1.0;
+      }
+      triggered = evaluateEventFunction(0, x, t) > 0.0;
+    }
+    std::size_t getNumEvents() const {
+      return 1;
+    }
+    virtual double evaluateEventFunction(unsigned int i, const state &x, double t) {
+      return t - 5.0;
+    }
+   private:
+    bool triggered;
+  };
+
+  // the same decay, with an event adding 1 to x when it drops below 0.3
+  class ThresholdSystem : public DecaySystem {
+   public:
+    double evaluateEventFunction(unsigned int i, const state &x, double t) override {
+      return 0.3 - x[0];
+    }
+  };
+
+  // x0' = -x0 written in terms of x1 := 2 x0 + t, which is set by an assignment rule
+  class RuleSystem {
+   public:
+    using state = boost::numeric::ublas::vector<double>;
+    void operator()(const state &x, state &dxdt, double t) {
+      dxdt[0] = -(x[1] - t) / 2.0;
+      dxdt[1] = 0.0;
+    }
+    void handleInitialAssignment(state &x, double t) {}
+    void handleAssignmentRule(state &x, double t) {
+      x[1] = 2.0 * x[0] + t;
+    }
+    void handleEvent(state &x, double t) {}
+    std::size_t getNumEvents() const {
+      return 0;
+    }
+    double evaluateEventFunction(unsigned int i, const state &x, double t) {
+      return 0.0;
+    }
+  };
+
+  // x0' = -x0 with x1 := x0, and an event adding 1 to x0 when x1 drops below 0.3
+  class RuleThresholdSystem {
+   public:
+    using state = boost::numeric::ublas::vector<double>;
+    RuleThresholdSystem() : triggered(false) {}
+    void operator()(const state &x, state &dxdt, double t) {
+      dxdt[0] = -x[0];
+      dxdt[1] = 0.0;
+    }
+    void handleInitialAssignment(state &x, double t) {}
+    void handleAssignmentRule(state &x, double t) {
+      x[1] = x[0];
+    }
+    void handleEvent(state &x, double t) {
+      if (evaluateEventFunction(0, x, t) > 0.0 && !triggered) {
+        x[0] += 1.0;
+        handleAssignmentRule(x, t);
+      }
+      triggered = evaluateEventFunction(0, x, t) > 0.0;
+    }
+    std::size_t getNumEvents() const {
+      return 1;
+    }
+    double evaluateEventFunction(unsigned int i, const state &x, double t) {
+      return 0.3 - x[1];
+    }
+   private:
+    bool triggered;
+  };
+
+  class IntegrateConstTest : public ::testing::Test {};
+
+  TEST_F(IntegrateConstTest, denseOutputIsNotLimitedByTheOutputInterval) {
+    DecaySystem system;
+    DecaySystem::state x(1);
+    x[0] = 1.0;
+    auto stepper = odeint::make_dense_output(1e-10, 1e-8, odeint::runge_kutta_dopri5<DecaySystem::state>());
+    unsigned int observations = 0;
+    double last = 0.0;
+    auto observer = [&](const DecaySystem::state &x, double t) {
+      observations++;
+      last = x[0];
+    };
+
+    auto steps = sbmlsim::integrate_const(stepper, system, x, 0.0, 10.0, 0.001, observer);
+
+    EXPECT_EQ(10001u, observations);
+    EXPECT_LT(steps, 1000u);
+    // restarted after the event at t = 5
+    EXPECT_NEAR(std::exp(-10.0) + std::exp(-5.0), last, 1e-8);
+  }
+
+  TEST_F(IntegrateConstTest, eventsAreLocatedBetweenOutputPoints) {
+    ThresholdSystem system;
+    ThresholdSystem::state x(1);
+    x[0] = 1.0;
+    auto stepper = odeint::make_dense_output(1e-10, 1e-8, odeint::runge_kutta_dopri5<ThresholdSystem::state>());
+    double last = 0.0;
+    auto observer = [&](const ThresholdSystem::state &x, double t) {
+      last = x[0];
+    };
+
+    sbmlsim::integrate_const(stepper, system, x, 0.0, 3.0, 1.0, observer);
+
+    // x reaches 0.3 at t = ln(1 / 0.3) and again ln(1.3 / 0.3) later, both between output points
+    double eventTime = std::log(1.0 / 0.3) + std::log(1.3 / 0.3);
+    EXPECT_NEAR(1.3 * std::exp(-(3.0 - eventTime)), last, 1e-7);
+  }
+
+  TEST_F(IntegrateConstTest, assignmentRulesDoNotRestartDenseOutput) {
+    RuleSystem system;
+    RuleSystem::state x(2);
+    x[0] = 1.0;
+    x[1] = 0.0;
+    auto stepper = odeint::make_dense_output(1e-10, 1e-8, odeint::runge_kutta_dopri5<RuleSystem::state>());
+    double last = 0.0;
+    auto observer = [&](const RuleSystem::state &x, double t) {
+      last = x[0];
+    };
+
+    auto steps = sbmlsim::integrate_const(stepper, system, x, 0.0, 10.0, 0.001, observer, {1});
+
+    // the rule changes x1 at every output point, which must not restart the stepper
+    EXPECT_LT(steps, 1000u);
+    // the right-hand side sees x1 of the current state, not the one of the last restart
+    EXPECT_NEAR(std::exp(-10.0), last, 1e-8);
+    EXPECT_DOUBLE_EQ(2.0 * x[0] + 10.0, x[1]);
+  }
+
+  TEST_F(IntegrateConstTest, triggersReadingRuleTargetsAreLocatedBetweenOutputPoints) {
+    RuleThresholdSystem system;
+    RuleThresholdSystem::state x(2);
+    x[0] = 1.0;
+    x[1] = 1.0;
+    auto stepper = odeint::make_dense_output(1e-10, 1e-8, odeint::runge_kutta_dopri5<RuleThresholdSystem::state>());
+    double last = 0.0;
+    auto observer = [&](const RuleThresholdSystem::state &x, double t) {
+      last = x[0];
+    };
+
+    sbmlsim::integrate_const(stepper, system, x, 0.0, 3.0, 1.0, observer, {1});
+
+    // the interpolated x1 stays at its initial value; the rule has to be applied to see the crossings
+    double eventTime = std::log(1.0 / 0.3) + std::log(1.3 / 0.3);
+    EXPECT_NEAR(1.3 * std::exp(-(3.0 - eventTime)), last, 1e-7);
+  }
+
+}  // namespace
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include "sbmlsim/internal/codegen/JITCompiler.h"
+
+namespace {
+
+  const char *SOURCE = R"(
+extern "C" void sbmlsim_rhs(const double *x, double *dxdt, double t) { dxdt[0] = -2.0 * x[0]; }
+extern "C" void sbmlsim_assignment_rules(double *x, double t) {}
+extern "C" double sbmlsim_trigger(unsigned int event, const double *x, double t) { return 0.0; }
+)";
+
+  class JITCompilerTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      char dir[] = "/tmp/sbmlsim-jit-test-XXXXXX";
+      ASSERT_NE(nullptr, mkdtemp(dir));
+      this->cacheDirectory = dir;
+      setenv("SBMLSIM_JIT_CACHE_DIR", dir, 1);
+
+      // a compiler wrapper that counts its invocations, to tell cache hits from misses
+      this->logPath = this->cacheDirectory + "/cxx.log";
+      auto wrapper = this->cacheDirectory + "/cxx.sh";
+      std::ofstream ofs(wrapper);
+      ofs << "#!/bin/sh\necho >> '" << this->logPath << "'\nexec c++ \"$@\"\n";
+      ofs.close();
+      setenv("SBMLSIM_JIT_CXX", ("sh " + wrapper).c_str(), 1);
+    }
+
+    void TearDown() override {
+      unsetenv("SBMLSIM_JIT_CACHE_DIR");
+      unsetenv("SBMLSIM_JIT_CXX");
+      std::system(("rm -rf '" + this->cacheDirectory + "'").c_str());
+    }
+
+    int countCompilations() {
+      std::ifstream ifs(this->logPath);
+      std::string line;
+      int count = 0;
+      while (std::getline(ifs, line)) {
+        count++;
+      }
+      return count;
+    }
+
+    std::string cacheDirectory;
+    std::string logPath;
+  };
+
+  TEST_F(JITCompilerTest, cacheMiss) {
+    auto nativeModel = JITCompiler::compile(SOURCE);
+    ASSERT_TRUE(nativeModel != nullptr);
+    EXPECT_EQ(1, countCompilations());
+
+    double x = 3.0, dxdt = 0.0;
+    nativeModel->rhs(&x, &dxdt, 0.0);
+    EXPECT_DOUBLE_EQ(-6.0, dxdt);
+  }
+
+  TEST_F(JITCompilerTest, cacheHit) {
+    ASSERT_TRUE(JITCompiler::compile(SOURCE) != nullptr);
+    auto nativeModel = JITCompiler::compile(SOURCE);
+    ASSERT_TRUE(nativeModel != nullptr);
+    EXPECT_EQ(1, countCompilations());
+
+    // a different source is a different key
+    ASSERT_TRUE(JITCompiler::compile(std::string(SOURCE) + "\n") != nullptr);
+    EXPECT_EQ(2, countCompilations());
+  }
+
+  TEST_F(JITCompilerTest, compileFailure) {
+    EXPECT_TRUE(JITCompiler::compile("this is not C++") == nullptr);
+    EXPECT_EQ(1, countCompilations());
+
+    // missing entry points
+    EXPECT_TRUE(JITCompiler::compile("extern \"C\" void f() {}") == nullptr);
+  }
+
+  TEST_F(JITCompilerTest, writableCacheEntryIsRecompiled) {
+    ASSERT_TRUE(JITCompiler::compile(SOURCE) != nullptr);
+    std::system(("chmod 0666 '" + this->cacheDirectory + "'/sbmlsim-*.so").c_str());
+
+    ASSERT_TRUE(JITCompiler::compile(SOURCE) != nullptr);
+    EXPECT_EQ(2, countCompilations());
+  }
+
+  TEST_F(JITCompilerTest, sharedCacheDirectoryIsRejected) {
+    chmod(this->cacheDirectory.c_str(), 0777);
+    EXPECT_TRUE(JITCompiler::compile(SOURCE) == nullptr);
+    EXPECT_EQ(0, countCompilations());
+  }
+
+}  // namespace
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <boost/numeric/odeint.hpp>
+#include "sbmlsim/internal/stochastic/LinearNoiseApproximation.h"
+
+namespace {
+
+  // A -> B with k1 * A and B -> with k2 * B, in molecule counts
+  const char *MODEL_TWO_STEP_DECAY =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"twoStepDecay\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"A\" compartment=\"compartment\" initialAmount=\"1000\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"B\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"1\"/>"
+      "      <parameter id=\"k2\" value=\"0.5\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> A </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "      <reaction id=\"reaction2\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfReactants>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k2 </ci><ci> B </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  // the same, with A refilled to 1000 whenever it drops below 500
+  const char *MODEL_TWO_STEP_DECAY_WITH_EVENT =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"twoStepDecayWithEvent\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"A\" compartment=\"compartment\" initialAmount=\"1000\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"B\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"1\"/>"
+      "      <parameter id=\"k2\" value=\"0.5\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> A </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "      <reaction id=\"reaction2\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfReactants>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k2 </ci><ci> B </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "    <listOfEvents>"
+      "      <event id=\"event1\">"
+      "        <trigger>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><lt/><ci> A </ci><cn> 500 </cn></apply>"
+      "          </math>"
+      "        </trigger>"
+      "        <listOfEventAssignments>"
+      "          <eventAssignment variable=\"A\">"
+      "            <math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 1000 </cn></math>"
+      "          </eventAssignment>"
+      "        </listOfEventAssignments>"
+      "      </event>"
+      "    </listOfEvents>"
+      "  </model>"
+      "</sbml>";
+
+  class LinearNoiseApproximationTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      SBMLReader reader;
+      document = reader.readSBMLFromString(MODEL_TWO_STEP_DECAY);
+      model = new ModelWrapper(document->getModel());
+    }
+    void TearDown() override {
+      delete model;
+      delete document;
+    }
+    SBMLDocument *document;
+    ModelWrapper *model;
+  };
+
+  TEST_F(LinearNoiseApproximationTest, isExactForFirstOrderReactions) {
+    SBMLSystem system(model);
+    auto a = system.getStateIndexForVariable("A");
+    auto b = system.getStateIndexForVariable("B");
+    LinearNoiseApproximation lna(system);
+    auto y = lna.createInitialState(system.getInitialState());
+    auto stepper = odeint::make_controlled(1e-10, 1e-10, odeint::runge_kutta_dopri5<SBMLSystem::state>());
+    odeint::integrate_adaptive(stepper, std::ref(lna), y, 0.0, 1.0, 0.01);
+
+    // every molecule is independently A, B or gone: multinomial(1000, pA, pB), and A + B is not conserved
+    double pA = std::exp(-1.0);
+    double pB = 1.0 / (0.5 - 1.0) * (std::exp(-1.0) - std::exp(-0.5));
+    LinearNoiseApproximation::state x;
+    LinearNoiseApproximation::matrix covariance;
+    lna.getMean(y, x);
+    lna.getCovariance(y, covariance);
+    EXPECT_NEAR(1000.0 * pA, x[a], 1e-6);
+    EXPECT_NEAR(1000.0 * pB, x[b], 1e-6);
+    EXPECT_NEAR(1000.0 * pA * (1.0 - pA), covariance(a, a), 1e-6);
+    EXPECT_NEAR(1000.0 * pB * (1.0 - pB), covariance(b, b), 1e-6);
+    EXPECT_NEAR(-1000.0 * pA * pB, covariance(a, b), 1e-6);
+  }
+
+  TEST(LinearNoiseApproximationEventTest, rejectsEvents) {
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(MODEL_TWO_STEP_DECAY_WITH_EVENT);
+    ModelWrapper model(document->getModel());
+    SBMLSystem system(&model);
+
+    EXPECT_THROW(LinearNoiseApproximation lna(system), std::runtime_error);
+    delete document;
+  }
+
+}  // namespace
@@ -478,6 +478,26 @@ namespace {
     EXPECT_EQ(s, "0");
   }
 
+  TEST_F(MathUtilTest, differentiateTestUnaryMinus) {
+    ASTNode* ast = SBML_parseFormula("-x");
+    ast->reduceToBinary();
+    ASTNode* diff = MathUtil::simplify(MathUtil::differentiate(ast, "x"));
+    std::string s = SBML_formulaToString(diff);
+    EXPECT_EQ(s, "-1");
+  }
+
+  TEST_F(MathUtilTest, containsTargetPiecewiseCondition) {
+    std::string s = "x";
+    ASTNode* ast = SBML_parseL3Formula("piecewise(1, x > 0, 2)");
+    EXPECT_TRUE(MathUtil::containsTarget(ast, s));
+  }
+
+  TEST_F(MathUtilTest, isDifferentiable) {
+    EXPECT_TRUE(MathUtil::isDifferentiable(SBML_parseL3Formula("k * x + piecewise(x, x > 0, 0)")));
+    EXPECT_FALSE(MathUtil::isDifferentiable(SBML_parseL3Formula("k * ceil(x)")));
+    EXPECT_FALSE(MathUtil::isDifferentiable(SBML_parseL3Formula("factorial(x) + 1")));
+  }
+
   /*
   TEST_F(MathUtilTest, differentiateTestFactorial) {
     ASTNode* ast = SBML_parseFormula("factorial(x)");
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "sbmlsim/internal/stochastic/NextReactionSimulator.h"
+#include "sbmlsim/internal/stochastic/StochasticEnsemble.h"
+
+namespace {
+
+  // S1 -> S2 -> S3 with k1 * S1 and k2 * S2, in molecule counts
+  const char *MODEL_CHAIN =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"chain\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"S1\" compartment=\"compartment\" initialAmount=\"1000\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"S2\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"S3\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"0.5\"/>"
+      "      <parameter id=\"k2\" value=\"0.2\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"S1\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"S2\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> S1 </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "      <reaction id=\"reaction2\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"S2\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"S3\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k2 </ci><ci> S2 </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  class NextReactionSimulatorTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      SBMLReader reader;
+      document = reader.readSBMLFromString(MODEL_CHAIN);
+      model = new ModelWrapper(document->getModel());
+    }
+    void TearDown() override {
+      delete model;
+      delete document;
+    }
+    SBMLDocument *document;
+    ModelWrapper *model;
+  };
+
+  TEST_F(NextReactionSimulatorTest, dependencyGraph) {
+    SBMLSystem system(model);
+    ReactionNetwork network(system);
+    ASSERT_EQ(2u, network.getNumReactions());
+    // reaction1 changes S1 and S2, read by both propensities; reaction2 changes S2 and S3, read by itself only
+    EXPECT_EQ(std::vector<unsigned int>({0, 1}), network.getDependents(0));
+    EXPECT_EQ(std::vector<unsigned int>({1}), network.getDependents(1));
+    EXPECT_TRUE(network.getVolatileReactions().empty());
+  }
+
+  TEST_F(NextReactionSimulatorTest, updatesDependentFiringTimes) {
+    SBMLSystem system(model);
+    NextReactionSimulator simulator(system, 12345);
+    auto x = system.getInitialState();
+    auto s1 = system.getStateIndexForVariable("S1");
+    auto s2 = system.getStateIndexForVariable("S2");
+    auto s3 = system.getStateIndexForVariable("S3");
+    double t = 0.0;
+    simulator.initialize(x, t);
+    while (simulator.step(x, t, 2.0)) {
+      // nothing to do
+    }
+
+    // reaction2 starts with a zero propensity and only ever fires if reaction1 reschedules it
+    EXPECT_GT(x[s3], 0.0);
+    EXPECT_DOUBLE_EQ(1000.0, x[s1] + x[s2] + x[s3]);
+    EXPECT_EQ(x[s2] + 2.0 * x[s3], simulator.getNumFirings());
+  }
+
+  TEST_F(NextReactionSimulatorTest, matchesTheMeansOfTheChain) {
+    SBMLSystem system(model);
+    std::vector<ObserveTarget> targets {ObserveTarget("S1", system.getStateIndexForVariable("S1")),
+                                        ObserveTarget("S2", system.getStateIndexForVariable("S2"))};
+    std::function<NextReactionSimulator(SBMLSystem &)> factory = [](SBMLSystem &system) {
+      return NextReactionSimulator(system, 12345);
+    };
+    StochasticEnsemble ensemble(system, targets, 4);
+    auto statistics = ensemble.run(200, 0.0, 2.0, 1.0, factory);
+
+    // every molecule moves on independently: binomial(1000, p1) and binomial(1000, p2) at t = 2
+    double p1 = std::exp(-1.0);
+    double p2 = 0.5 / (0.2 - 0.5) * (std::exp(-1.0) - std::exp(-0.4));
+    EXPECT_NEAR(1000.0 * p1, statistics.means[2][0], 5.0);
+    EXPECT_NEAR(1000.0 * p2, statistics.means[2][1], 5.0);
+  }
+
+}  // namespace
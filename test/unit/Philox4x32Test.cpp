@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "sbmlsim/internal/stochastic/Philox4x32.h"
+
+namespace {
+
+  class Philox4x32Test : public ::testing::Test {};
+
+  // known-answer vectors of the Random123 distribution
+  TEST_F(Philox4x32Test, matchesKnownAnswers) {
+    Philox4x32::counter_type zero = {{0, 0, 0, 0}};
+    Philox4x32::counter_type expected = {{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}};
+    EXPECT_EQ(expected, Philox4x32::generateBlock(zero, {{0, 0}}));
+
+    Philox4x32::counter_type ones = {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}};
+    expected = {{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}};
+    EXPECT_EQ(expected, Philox4x32::generateBlock(ones, {{0xffffffff, 0xffffffff}}));
+
+    Philox4x32::counter_type pi = {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}};
+    expected = {{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+    EXPECT_EQ(expected, Philox4x32::generateBlock(pi, {{0xa4093822, 0x299f31d0}}));
+  }
+
+  TEST_F(Philox4x32Test, streamsAreReproducibleAndDistinct) {
+    Philox4x32 a(42, 7);
+    Philox4x32 b(42, 0);
+    b.setStream(7);
+    Philox4x32 c(42, 8);
+    bool differs = false;
+    for (auto i = 0; i < 100; i++) {
+      auto value = a();
+      EXPECT_EQ(value, b());
+      differs = differs || value != c();
+    }
+    EXPECT_TRUE(differs);
+  }
+
+  TEST_F(Philox4x32Test, discardSkipsOutputs) {
+    for (unsigned long long n = 0; n < 7; n++) {
+      Philox4x32 a(1, 2);
+      Philox4x32 b(1, 2);
+      a();
+      b();
+      for (unsigned long long k = 0; k < n; k++) {
+        a();
+      }
+      b.discard(n);
+      EXPECT_EQ(a(), b());
+    }
+  }
+
+  TEST_F(Philox4x32Test, drivesStandardDistributions) {
+    Philox4x32 engine(12345);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    double sum = 0.0;
+    auto n = 100000;
+    for (auto i = 0; i < n; i++) {
+      double u = uniform(engine);
+      EXPECT_LE(0.0, u);
+      EXPECT_GT(1.0, u);
+      sum += u;
+    }
+    EXPECT_NEAR(0.5, sum / n, 0.005);
+  }
+
+}  // namespace
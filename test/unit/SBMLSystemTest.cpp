@@ -0,0 +1,491 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include "sbmlsim/internal/system/SBMLSystem.h"
+#include "sbmlsim/internal/system/SBMLSystemJacobi.h"
+
+namespace {
+
+  unsigned long long allocationCount = 0;
+
+  // S1 -> S2, k1 * S1 * compartment (same as 00001 in the SBML test suite)
+  const char *MODEL_00001 =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"case00001\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"S1\" compartment=\"compartment\" initialAmount=\"0.00015\"/>"
+      "      <species id=\"S2\" compartment=\"compartment\" initialAmount=\"0\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"1\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"S1\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"S2\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> compartment </ci><ci> k1 </ci><ci> S1 </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  // S2 = S1 one time unit after time exceeds 0.5, with the value of S1 at the trigger time
+  const char *MODEL_DELAYED_EVENT =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"delayedEvent\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"S1\" compartment=\"compartment\" initialAmount=\"1\"/>"
+      "      <species id=\"S2\" compartment=\"compartment\" initialAmount=\"0\"/>"
+      "    </listOfSpecies>"
+      "    <listOfEvents>"
+      "      <event id=\"event1\">"
+      "        <trigger>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><gt/>"
+      "              <csymbol encoding=\"text\" definitionURL=\"http://www.sbml.org/sbml/symbols/time\"> t </csymbol>"
+      "              <cn> 0.5 </cn>"
+      "            </apply>"
+      "          </math>"
+      "        </trigger>"
+      "        <delay>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 1 </cn></math>"
+      "        </delay>"
+      "        <listOfEventAssignments>"
+      "          <eventAssignment variable=\"S2\">"
+      "            <math xmlns=\"http://www.w3.org/1998/Math/MathML\"><ci> S1 </ci></math>"
+      "          </eventAssignment>"
+      "        </listOfEventAssignments>"
+      "      </event>"
+      "    </listOfEvents>"
+      "  </model>"
+      "</sbml>";
+
+  // S1 -> S2 in Level 3, with an initial assignment and an assignment rule to the id of a species reference
+  const char *MODEL_SPECIES_REFERENCE_TARGETS =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">"
+      "  <model id=\"speciesReferenceTargets\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\" constant=\"true\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"S1\" compartment=\"compartment\" initialAmount=\"1\" hasOnlySubstanceUnits=\"true\""
+      "               boundaryCondition=\"false\" constant=\"false\"/>"
+      "      <species id=\"S2\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\""
+      "               boundaryCondition=\"false\" constant=\"false\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"0.5\" constant=\"true\"/>"
+      "    </listOfParameters>"
+      "    <listOfInitialAssignments>"
+      "      <initialAssignment symbol=\"sr1\">"
+      "        <math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 2 </cn></math>"
+      "      </initialAssignment>"
+      "    </listOfInitialAssignments>"
+      "    <listOfRules>"
+      "      <assignmentRule variable=\"sr2\">"
+      "        <math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 1 </cn></math>"
+      "      </assignmentRule>"
+      "    </listOfRules>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\" fast=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference id=\"sr1\" species=\"S1\" stoichiometry=\"1\" constant=\"true\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference id=\"sr2\" species=\"S2\" stoichiometry=\"1\" constant=\"false\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> S1 </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  // S1 -> S2 at k1 * S1^2 * p / (Km + S2) and S2 -> at k1 * S2 * exp(-S1), with p = S1 * S2 + 1 by an assignment rule
+  const char *MODEL_NONLINEAR_ASSIGNMENT_RULE =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"nonlinearAssignmentRule\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"S1\" compartment=\"compartment\" initialAmount=\"2\"/>"
+      "      <species id=\"S2\" compartment=\"compartment\" initialAmount=\"1\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"0.7\"/>"
+      "      <parameter id=\"Km\" value=\"0.5\"/>"
+      "      <parameter id=\"p\" value=\"0\" constant=\"false\"/>"
+      "    </listOfParameters>"
+      "    <listOfRules>"
+      "      <assignmentRule variable=\"p\">"
+      "        <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "          <apply><plus/><apply><times/><ci> S1 </ci><ci> S2 </ci></apply><cn> 1 </cn></apply>"
+      "        </math>"
+      "      </assignmentRule>"
+      "    </listOfRules>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"S1\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"S2\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><divide/>"
+      "              <apply><times/><ci> k1 </ci><apply><power/><ci> S1 </ci><cn> 2 </cn></apply><ci> p </ci></apply>"
+      "              <apply><plus/><ci> Km </ci><ci> S2 </ci></apply>"
+      "            </apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "      <reaction id=\"reaction2\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"S2\"/>"
+      "        </listOfReactants>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> S2 </ci>"
+      "              <apply><exp/><apply><minus/><ci> S1 </ci></apply></apply>"
+      "            </apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  // S1 := k1 * S2 * 2 + exp(0) + 1 as an initial assignment with n-ary operators
+  const char *MODEL_INITIAL_ASSIGNMENT =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"initialAssignment\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"S1\" compartment=\"compartment\" initialAmount=\"0\"/>"
+      "      <species id=\"S2\" compartment=\"compartment\" initialAmount=\"3\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"0.5\"/>"
+      "    </listOfParameters>"
+      "    <listOfInitialAssignments>"
+      "      <initialAssignment symbol=\"S1\">"
+      "        <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "          <apply><plus/>"
+      "            <apply><times/><ci> k1 </ci><ci> S2 </ci><cn> 2 </cn></apply>"
+      "            <apply><exp/><cn> 0 </cn></apply>"
+      "            <cn> 1 </cn>"
+      "          </apply>"
+      "        </math>"
+      "      </initialAssignment>"
+      "    </listOfInitialAssignments>"
+      "  </model>"
+      "</sbml>";
+
+  class SBMLSystemTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      SBMLReader reader;
+      document = reader.readSBMLFromString(MODEL_00001);
+      model = new ModelWrapper(document->getModel());
+    }
+    void TearDown() override {
+      delete model;
+      delete document;
+    }
+    SBMLDocument *document;
+    ModelWrapper *model;
+  };
+
+  TEST_F(SBMLSystemTest, handleReaction) {
+    SBMLSystem system(model);
+    auto x = system.getInitialState();
+    SBMLSystem::state dxdt(x.size());
+    system(x, dxdt, 0.0);
+    EXPECT_DOUBLE_EQ(-0.00015, dxdt[system.getStateIndexForVariable("S1")]);
+    EXPECT_DOUBLE_EQ(0.00015, dxdt[system.getStateIndexForVariable("S2")]);
+  }
+
+  TEST_F(SBMLSystemTest, constantsAreNotIntegrated) {
+    SBMLSystem system(model);
+    EXPECT_EQ(2, system.getInitialState().size());
+    EXPECT_TRUE(system.isConstant("k1"));
+    EXPECT_TRUE(system.isConstant("compartment"));
+    EXPECT_FALSE(system.isConstant("S1"));
+    EXPECT_DOUBLE_EQ(1.0, system.getConstants()[system.getConstantIndexForVariable("k1")]);
+  }
+
+  TEST_F(SBMLSystemTest, analyticJacobian) {
+    SBMLSystem system(model);
+    SBMLSystemJacobi jacobi(system);
+    auto x = system.getInitialState();
+    SBMLSystemJacobi::matrix J(x.size(), x.size());
+    SBMLSystemJacobi::state dfdt(x.size());
+    jacobi(x, J, 0.0, dfdt);
+
+    auto s1 = system.getStateIndexForVariable("S1");
+    auto s2 = system.getStateIndexForVariable("S2");
+    EXPECT_DOUBLE_EQ(-1.0, J(s1, s1));
+    EXPECT_DOUBLE_EQ(0.0, J(s1, s2));
+    EXPECT_DOUBLE_EQ(1.0, J(s2, s1));
+    EXPECT_DOUBLE_EQ(0.0, J(s2, s2));
+    EXPECT_DOUBLE_EQ(0.0, dfdt[s1]);
+    EXPECT_DOUBLE_EQ(0.0, dfdt[s2]);
+  }
+
+  TEST_F(SBMLSystemTest, symbolicJacobian) {
+    SBMLSystem system(model);
+    SBMLSystemJacobi jacobi(system, JacobianMethod::SYMBOLIC_DIFFERENTIATION);
+    auto x = system.getInitialState();
+    jacobi.evaluate(x, 0.0);
+
+    auto s1 = system.getStateIndexForVariable("S1");
+    auto s2 = system.getStateIndexForVariable("S2");
+    auto &rowPointers = jacobi.getRowPointers();
+    auto &values = jacobi.getValues();
+    EXPECT_EQ(JacobianMethod::SYMBOLIC_DIFFERENTIATION, jacobi.getMethod());
+    EXPECT_DOUBLE_EQ(-1.0, values[rowPointers[s1]]);
+    EXPECT_DOUBLE_EQ(1.0, values[rowPointers[s2]]);
+  }
+
+  TEST_F(SBMLSystemTest, parameterDerivative) {
+    SBMLSystem system(model);
+    SBMLSystemJacobi jacobi(system);
+    auto x = system.getInitialState();
+    SBMLSystemJacobi::state dfdp(x.size());
+    jacobi.evaluateParameterDerivative(x, 0.0, system.getConstantIndexForVariable("k1"), dfdp);
+
+    // d/dk1 of -+ k1 * S1 * compartment
+    auto s1 = system.getStateIndexForVariable("S1");
+    auto s2 = system.getStateIndexForVariable("S2");
+    EXPECT_DOUBLE_EQ(-0.00015, dfdp[s1]);
+    EXPECT_DOUBLE_EQ(0.00015, dfdp[s2]);
+  }
+
+  TEST_F(SBMLSystemTest, sparseJacobianPattern) {
+    SBMLSystem system(model);
+    SBMLSystemJacobi jacobi(system);
+    auto x = system.getInitialState();
+    jacobi.evaluate(x, 0.0);
+
+    // S1 -> S2 with rate k1 * S1 * compartment: only d/dS1 is structurally non-zero
+    auto s1 = system.getStateIndexForVariable("S1");
+    auto s2 = system.getStateIndexForVariable("S2");
+    ASSERT_EQ(2, jacobi.getNumNonZeros());
+    auto &rowPointers = jacobi.getRowPointers();
+    auto &columnIndices = jacobi.getColumnIndices();
+    auto &values = jacobi.getValues();
+    EXPECT_EQ(1, rowPointers[s1 + 1] - rowPointers[s1]);
+    EXPECT_EQ(1, rowPointers[s2 + 1] - rowPointers[s2]);
+    EXPECT_EQ(s1, columnIndices[rowPointers[s1]]);
+    EXPECT_EQ(s1, columnIndices[rowPointers[s2]]);
+    EXPECT_DOUBLE_EQ(-1.0, values[rowPointers[s1]]);
+    EXPECT_DOUBLE_EQ(1.0, values[rowPointers[s2]]);
+  }
+
+  TEST_F(SBMLSystemTest, finiteDifferenceJacobian) {
+    SBMLSystem system(model);
+    SBMLSystemJacobi jacobi(system, JacobianMethod::FINITE_DIFFERENCE);
+    auto x = system.getInitialState();
+    SBMLSystemJacobi::matrix J(x.size(), x.size());
+    SBMLSystemJacobi::state dfdt(x.size());
+    jacobi(x, J, 0.0, dfdt);
+
+    // only the S1 column is structurally non-zero, so a single RHS difference suffices
+    EXPECT_EQ(JacobianMethod::FINITE_DIFFERENCE, jacobi.getMethod());
+    EXPECT_EQ(1, jacobi.getNumColors());
+    auto s1 = system.getStateIndexForVariable("S1");
+    auto s2 = system.getStateIndexForVariable("S2");
+    EXPECT_NEAR(-1.0, J(s1, s1), 1e-6);
+    EXPECT_NEAR(1.0, J(s2, s1), 1e-6);
+    EXPECT_DOUBLE_EQ(0.0, J(s1, s2));
+    EXPECT_NEAR(0.0, dfdt[s1], 1e-6);
+  }
+
+  TEST(SBMLSystemEventTest, delayedEventUsesValuesFromTriggerTime) {
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(MODEL_DELAYED_EVENT);
+    ModelWrapper model(document->getModel());
+    SBMLSystem system(&model);
+    auto x = system.getInitialState();
+    auto s1 = system.getStateIndexForVariable("S1");
+    auto s2 = system.getStateIndexForVariable("S2");
+
+    // time > 0.5 is scheduled analytically: a single event function crossing zero at the next scheduled time
+    ASSERT_EQ(1, system.getNumEvents());
+    system.handleEvent(x, 0.0);
+    EXPECT_DOUBLE_EQ(-0.3, system.evaluateEventFunction(0, x, 0.2));
+
+    // the trigger fires at 0.6, the execution is scheduled for 1.6
+    system.handleEvent(x, 0.6);
+    EXPECT_DOUBLE_EQ(0.0, x[s2]);
+    EXPECT_DOUBLE_EQ(-0.6, system.evaluateEventFunction(0, x, 1.0));
+
+    x[s1] = 5.0;
+    system.handleEvent(x, 1.0);
+    EXPECT_DOUBLE_EQ(0.0, x[s2]);
+    system.handleEvent(x, 1.6);
+    EXPECT_DOUBLE_EQ(1.0, x[s2]);
+    EXPECT_DOUBLE_EQ(-1.0, system.evaluateEventFunction(0, x, 2.0));
+    delete document;
+  }
+
+  TEST(SBMLSystemEventTest, resetEventsDropsPendingExecutions) {
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(MODEL_DELAYED_EVENT);
+    ModelWrapper model(document->getModel());
+    SBMLSystem system(&model);
+    auto x = system.getInitialState();
+    auto s2 = system.getStateIndexForVariable("S2");
+    system.handleEvent(x, 0.0);
+    system.handleEvent(x, 0.6);
+    EXPECT_DOUBLE_EQ(1.6, system.getNextScheduledTime());
+
+    // a second trajectory from the start: the trigger is pending again and nothing is queued
+    system.resetEvents();
+    x = system.getInitialState();
+    EXPECT_GT(system.getNextScheduledTime(), 0.5);
+    EXPECT_LT(system.getNextScheduledTime(), 0.6);
+    system.handleEvent(x, 0.0);
+    system.handleEvent(x, 0.7);
+    EXPECT_DOUBLE_EQ(1.7, system.getNextScheduledTime());
+    system.handleEvent(x, 1.7);
+    EXPECT_DOUBLE_EQ(1.0, x[s2]);
+    delete document;
+  }
+
+  // the baseline skipped these targets; they must not abort loading
+  TEST(SBMLSystemSpeciesReferenceTest, speciesReferenceTargetsAreSkipped) {
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(MODEL_SPECIES_REFERENCE_TARGETS);
+    ModelWrapper model(document->getModel());
+    EXPECT_TRUE(model.getInitialAssignments().empty());
+    EXPECT_TRUE(model.getAssignmentRules().empty());
+
+    SBMLSystem system(&model);
+    auto x = system.getInitialState();
+    system.handleInitialAssignment(x, 0.0);
+    system.handleAssignmentRule(x, 0.0);
+    SBMLSystem::state dxdt(x.size());
+    system(x, dxdt, 0.0);
+    EXPECT_DOUBLE_EQ(1.0, x[system.getStateIndexForVariable("S1")]);
+    EXPECT_DOUBLE_EQ(-0.5, dxdt[system.getStateIndexForVariable("S1")]);
+    EXPECT_DOUBLE_EQ(0.5, dxdt[system.getStateIndexForVariable("S2")]);
+    delete document;
+  }
+
+  TEST(SBMLSystemInitialAssignmentTest, compiledInitialAssignments) {
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(MODEL_INITIAL_ASSIGNMENT);
+    ModelWrapper model(document->getModel());
+    SBMLSystem system(&model);
+    auto x = system.getInitialState();
+
+    testing::internal::CaptureStdout();
+    system.handleInitialAssignment(x, 0.0);
+    EXPECT_EQ("", testing::internal::GetCapturedStdout());
+    EXPECT_DOUBLE_EQ(5.0, x[system.getStateIndexForVariable("S1")]);
+    EXPECT_DOUBLE_EQ(3.0, x[system.getStateIndexForVariable("S2")]);
+    delete document;
+  }
+
+  // J of every method against central differences of f with the assignment rule applied
+  TEST(SBMLSystemJacobianTest, chainRuleThroughAssignmentRules) {
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(MODEL_NONLINEAR_ASSIGNMENT_RULE);
+    ModelWrapper model(document->getModel());
+    SBMLSystem system(&model);
+    auto x = system.getInitialState();
+    system.handleAssignmentRule(x, 0.0);
+    auto s1 = system.getStateIndexForVariable("S1");
+    auto s2 = system.getStateIndexForVariable("S2");
+    auto p = system.getStateIndexForVariable("p");
+
+    auto f = [&](SBMLSystem::state y, SBMLSystem::state &dydt) {
+      system.handleAssignmentRule(y, 0.0);
+      system(y, dydt, 0.0);
+    };
+    SBMLSystemJacobi::matrix reference(x.size(), x.size(), 0.0);
+    for (auto j : {s1, s2}) {
+      const double h = 1e-6;
+      auto forward = x, backward = x;
+      forward[j] += h;
+      backward[j] -= h;
+      SBMLSystem::state fForward(x.size()), fBackward(x.size());
+      f(forward, fForward);
+      f(backward, fBackward);
+      for (auto i = 0; i < x.size(); i++) {
+        reference(i, j) = (fForward[i] - fBackward[i]) / (2 * h);
+      }
+    }
+    // the rule contributes to d/dS2 of reaction1, which is non-zero only through p
+    ASSERT_GT(std::abs(reference(s1, s2)), 0.1);
+
+    for (auto method : {JacobianMethod::AUTOMATIC_DIFFERENTIATION, JacobianMethod::SYMBOLIC_DIFFERENTIATION,
+                        JacobianMethod::FINITE_DIFFERENCE}) {
+      SBMLSystemJacobi jacobi(system, method);
+      SBMLSystemJacobi::matrix J(x.size(), x.size());
+      SBMLSystemJacobi::state dfdt(x.size());
+      jacobi(x, J, 0.0, dfdt);
+      for (auto i : {s1, s2}) {
+        for (auto j : {s1, s2}) {
+          EXPECT_NEAR(reference(i, j), J(i, j), 1e-6) << "method " << static_cast<int>(method);
+        }
+        EXPECT_DOUBLE_EQ(0.0, J(i, p));
+      }
+    }
+    delete document;
+  }
+
+  TEST_F(SBMLSystemTest, handleReactionDoesNotAllocate) {
+    SBMLSystem system(model);
+    auto x = system.getInitialState();
+    SBMLSystem::state dxdt(x.size());
+
+    auto before = allocationCount;
+    for (auto i = 0; i < 100; i++) {
+      system(x, dxdt, 0.01 * i);
+    }
+    EXPECT_EQ(before, allocationCount);
+  }
+
+}  // namespace
+
+void *operator new(std::size_t size) {
+  allocationCount++;
+  void *p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
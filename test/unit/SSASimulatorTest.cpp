@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include "sbmlsim/internal/stochastic/SSASimulator.h"
+
+namespace {
+
+  // S1 -> S2 with k1 * S1, in molecule counts
+  const char *MODEL_DECAY =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"decay\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"S1\" compartment=\"compartment\" initialAmount=\"1000\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"S2\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"0.1\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"S1\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"S2\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> S1 </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  // S1 -> S2 with k1 * S1, where k1 switches from 0 to 1 at time 0.5
+  const char *MODEL_SWITCHED_DECAY =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"switchedDecay\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"S1\" compartment=\"compartment\" initialAmount=\"1000\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"S2\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"0\" constant=\"false\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"S1\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"S2\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> S1 </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "    <listOfEvents>"
+      "      <event id=\"event1\">"
+      "        <trigger>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><geq/><csymbol encoding=\"text\" definitionURL=\"http://www.sbml.org/sbml/symbols/time\">"
+      "              t </csymbol><cn> 0.5 </cn></apply>"
+      "          </math>"
+      "        </trigger>"
+      "        <listOfEventAssignments>"
+      "          <eventAssignment variable=\"k1\">"
+      "            <math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 1 </cn></math>"
+      "          </eventAssignment>"
+      "        </listOfEventAssignments>"
+      "      </event>"
+      "    </listOfEvents>"
+      "  </model>"
+      "</sbml>";
+
+  class SSASimulatorTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      SBMLReader reader;
+      document = reader.readSBMLFromString(MODEL_DECAY);
+      model = new ModelWrapper(document->getModel());
+    }
+    void TearDown() override {
+      delete model;
+      delete document;
+    }
+    SBMLDocument *document;
+    ModelWrapper *model;
+  };
+
+  TEST_F(SSASimulatorTest, dependencyGraph) {
+    SBMLSystem system(model);
+    ReactionNetwork network(system);
+    ASSERT_EQ(1u, network.getNumReactions());
+    EXPECT_EQ(2u, network.getStateChanges(0).size());
+    // firing changes S1, which the propensity reads
+    ASSERT_EQ(1u, network.getDependents(0).size());
+    EXPECT_EQ(0u, network.getDependents(0)[0]);
+    EXPECT_TRUE(network.getVolatileReactions().empty());
+  }
+
+  TEST_F(SSASimulatorTest, decayMatchesTheMeanAndConservesMolecules) {
+    SBMLSystem system(model);
+    SSASimulator simulator(system, 12345);
+    auto x = system.getInitialState();
+    auto s1 = system.getStateIndexForVariable("S1");
+    auto s2 = system.getStateIndexForVariable("S2");
+    double t = 0.0;
+    simulator.initialize(x, t);
+    while (simulator.step(x, t, 1.0)) {
+      // nothing to do
+    }
+
+    // binomial(1000, exp(-0.1)): mean 904.8, standard deviation 9.3
+    EXPECT_DOUBLE_EQ(1.0, t);
+    EXPECT_DOUBLE_EQ(1000.0, x[s1] + x[s2]);
+    EXPECT_DOUBLE_EQ(std::floor(x[s1]), x[s1]);
+    EXPECT_NEAR(1000.0 * std::exp(-0.1), x[s1], 50.0);
+    EXPECT_EQ(x[s2], simulator.getNumFirings());
+  }
+
+  TEST(SSASimulatorRejectionTest, reversibleReactionsAreRejected) {
+    std::string sbml(MODEL_DECAY);
+    sbml.replace(sbml.find("reversible=\"false\""), 18, "reversible=\"true\"");
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(sbml);
+    ModelWrapper model(document->getModel());
+    SBMLSystem system(&model);
+
+    EXPECT_THROW(SSASimulator(system, 12345), std::runtime_error);
+    delete document;
+  }
+
+  TEST(SSASimulatorRejectionTest, negativePropensitiesAreRejected) {
+    std::string sbml(MODEL_DECAY);
+    sbml.replace(sbml.find("value=\"0.1\""), 11, "value=\"-0.1\"");
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(sbml);
+    ModelWrapper model(document->getModel());
+    SBMLSystem system(&model);
+    SSASimulator simulator(system, 12345);
+    auto x = system.getInitialState();
+
+    EXPECT_THROW(simulator.initialize(x, 0.0), std::runtime_error);
+    delete document;
+  }
+
+  TEST(SSASimulatorEventTest, stepsStopAtScheduledEvents) {
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(MODEL_SWITCHED_DECAY);
+    ModelWrapper model(document->getModel());
+    SBMLSystem system(&model);
+    SSASimulator simulator(system, 12345);
+    auto x = system.getInitialState();
+    auto s1 = system.getStateIndexForVariable("S1");
+    double t = 0.0;
+    simulator.initialize(x, t);
+    unsigned int steps = 0;
+    while (simulator.step(x, t, 1.0)) {
+      steps++;
+    }
+
+    // no propensity until the event at 0.5, which must not be skipped up to the sample time:
+    // binomial(1000, exp(-0.5)) over the remaining half, mean 606.5, standard deviation 15.5
+    EXPECT_DOUBLE_EQ(1.0, t);
+    EXPECT_EQ(simulator.getNumFirings() + 1, steps);
+    EXPECT_NEAR(1000.0 * std::exp(-0.5), x[s1], 80.0);
+    delete document;
+  }
+
+}  // namespace
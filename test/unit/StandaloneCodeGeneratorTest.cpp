@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sbmlsim/internal/codegen/StandaloneCodeGenerator.h"
+
+namespace {
+
+  // S1 -> S2, k1 * S1 * compartment (same as 00001 in the SBML test suite)
+  const char *MODEL_00001 =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"case00001\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"S1\" compartment=\"compartment\" initialAmount=\"0.00015\"/>"
+      "      <species id=\"S2\" compartment=\"compartment\" initialAmount=\"0\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"1\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"S1\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"S2\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> compartment </ci><ci> k1 </ci><ci> S1 </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+#define SPECIES(id, amount) \
+      "      <species id=\"" id "\" compartment=\"compartment\" initialAmount=\"" amount "\"" \
+      " hasOnlySubstanceUnits=\"true\" boundaryCondition=\"false\" constant=\"false\"/>"
+#define EVENT(id, initialValue, useValuesFromTriggerTime, trigger, priority, variable, math) \
+      "      <event id=\"" id "\" useValuesFromTriggerTime=\"" useValuesFromTriggerTime "\">" \
+      "        <trigger initialValue=\"" initialValue "\" persistent=\"true\">" \
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">" trigger "</math>" \
+      "        </trigger>" \
+      priority \
+      "        <listOfEventAssignments>" \
+      "          <eventAssignment variable=\"" variable "\">" \
+      "            <math xmlns=\"http://www.w3.org/1998/Math/MathML\">" math "</math>" \
+      "          </eventAssignment>" \
+      "        </listOfEventAssignments>" \
+      "      </event>"
+#define PRIORITY(value) \
+      "        <priority><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> " value " </cn></math></priority>"
+
+  // all events but e2 fire at t = 0: e1 first, e3 and e4 next (e3 sees S2 after e1, e4 sees S2 at the
+  // trigger time), and e5, triggered by e1, last
+  const char *MODEL_EVENTS =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level3/version1/core\" level=\"3\" version=\"1\">"
+      "  <model id=\"events\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\" constant=\"true\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      SPECIES("S1", "1") SPECIES("S2", "0") SPECIES("S3", "0") SPECIES("S4", "0") SPECIES("S5", "0")
+      "    </listOfSpecies>"
+      "    <listOfEvents>"
+      EVENT("e1", "false", "true", "<apply><gt/><ci> S1 </ci><cn> 0 </cn></apply>", PRIORITY("1"), "S2",
+            "<apply><plus/><ci> S2 </ci><cn> 1 </cn></apply>")
+      EVENT("e2", "true", "true", "<apply><gt/><ci> S1 </ci><cn> 0 </cn></apply>", "", "S5", "<cn> 1 </cn>")
+      EVENT("e3", "false", "false", "<apply><gt/><ci> S1 </ci><cn> 0 </cn></apply>", PRIORITY("0"), "S3",
+            "<ci> S2 </ci>")
+      EVENT("e4", "false", "true", "<apply><gt/><ci> S1 </ci><cn> 0 </cn></apply>", PRIORITY("0"), "S4",
+            "<ci> S2 </ci>")
+      EVENT("e5", "true", "true", "<apply><gt/><ci> S2 </ci><cn> 0.5 </cn></apply>", "", "S1", "<cn> 3 </cn>")
+      "    </listOfEvents>"
+      "  </model>"
+      "</sbml>";
+
+  const char *MODEL_DELAYED_EVENT =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"delayedEvent\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"S1\" compartment=\"compartment\" initialAmount=\"1\"/>"
+      "    </listOfSpecies>"
+      "    <listOfEvents>"
+      "      <event id=\"event1\">"
+      "        <trigger>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><gt/><csymbol encoding=\"text\" definitionURL=\"http://www.sbml.org/sbml/symbols/time\">"
+      "              t </csymbol><cn> 0.5 </cn></apply>"
+      "          </math>"
+      "        </trigger>"
+      "        <delay><math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 1 </cn></math></delay>"
+      "        <listOfEventAssignments>"
+      "          <eventAssignment variable=\"S1\">"
+      "            <math xmlns=\"http://www.w3.org/1998/Math/MathML\"><cn> 0 </cn></math>"
+      "          </eventAssignment>"
+      "        </listOfEventAssignments>"
+      "      </event>"
+      "    </listOfEvents>"
+      "  </model>"
+      "</sbml>";
+
+  // prints the state after the events at t = 0 and the derivative there, one value per line
+  const char *DRIVER =
+      "#include <cstdio>\n"
+      "#include \"model.h\"\n"
+      "int main() {\n"
+      "  generated::Model model;\n"
+      "  auto x = generated::Model::getInitialState();\n"
+      "  generated::Model::state dxdt;\n"
+      "  model.handleInitialAssignment(x, 0.0);\n"
+      "  model.handleAssignmentRule(x, 0.0);\n"
+      "  model.handleEvent(x, 0.0);\n"
+      "  model(x, dxdt, 0.0);\n"
+      "  for (auto value : x) std::printf(\"%.17g\\n\", value);\n"
+      "  for (auto value : dxdt) std::printf(\"%.17g\\n\", value);\n"
+      "  return 0;\n"
+      "}\n";
+
+  class StandaloneCodeGeneratorTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      char dir[] = "/tmp/sbmlsim-codegen-test-XXXXXX";
+      ASSERT_NE(nullptr, mkdtemp(dir));
+      this->directory = dir;
+      this->document = nullptr;
+      this->model = nullptr;
+    }
+
+    void TearDown() override {
+      delete this->model;
+      delete this->document;
+      std::system(("rm -rf '" + this->directory + "'").c_str());
+    }
+
+    void load(const char *sbml) {
+      SBMLReader reader;
+      this->document = reader.readSBMLFromString(sbml);
+      this->model = new ModelWrapper(this->document->getModel());
+    }
+
+    // builds the generated header with the host compiler and returns what DRIVER prints
+    std::vector<double> runGenerated(SBMLSystem &system) {
+      std::ofstream header(this->directory + "/model.h");
+      StandaloneCodeGenerator::generateHeader(header, system, "model", "generated");
+      header.close();
+      std::ofstream driver(this->directory + "/main.cpp");
+      driver << DRIVER;
+      driver.close();
+
+      const char *compiler = std::getenv("CXX");
+      auto binary = this->directory + "/main";
+      auto command = std::string(compiler != nullptr ? compiler : "c++") + " -std=c++11 -o '" + binary + "' '"
+          + this->directory + "/main.cpp'";
+      std::vector<double> ret;
+      if (std::system(command.c_str()) != 0) {
+        return ret;
+      }
+
+      FILE *pipe = popen(binary.c_str(), "r");
+      double value;
+      while (std::fscanf(pipe, "%lf", &value) == 1) {
+        ret.push_back(value);
+      }
+      pclose(pipe);
+      return ret;
+    }
+
+    // the same as DRIVER with the interpreter
+    std::vector<double> runInterpreted(SBMLSystem &system) {
+      auto x = system.getInitialState();
+      SBMLSystem::state dxdt(x.size());
+      system.handleInitialAssignment(x, 0.0);
+      system.handleAssignmentRule(x, 0.0);
+      system.handleEvent(x, 0.0);
+      system(x, dxdt, 0.0);
+      std::vector<double> ret(x.begin(), x.end());
+      ret.insert(ret.end(), dxdt.begin(), dxdt.end());
+      return ret;
+    }
+
+    std::string directory;
+    SBMLDocument *document;
+    ModelWrapper *model;
+  };
+
+  TEST_F(StandaloneCodeGeneratorTest, rhsMatchesInterpreter) {
+    load(MODEL_00001);
+    SBMLSystem system(model);
+    auto generated = runGenerated(system);
+    auto interpreted = runInterpreted(system);
+    ASSERT_EQ(interpreted.size(), generated.size());
+    for (auto i = 0; i < interpreted.size(); i++) {
+      EXPECT_DOUBLE_EQ(interpreted[i], generated[i]);
+    }
+  }
+
+  TEST_F(StandaloneCodeGeneratorTest, eventsMatchInterpreter) {
+    load(MODEL_EVENTS);
+    SBMLSystem system(model);
+    auto generated = runGenerated(system);
+    auto interpreted = runInterpreted(system);
+    ASSERT_EQ(interpreted.size(), generated.size());
+    for (auto i = 0; i < interpreted.size(); i++) {
+      EXPECT_DOUBLE_EQ(interpreted[i], generated[i]);
+    }
+
+    EXPECT_DOUBLE_EQ(3.0, generated[system.getStateIndexForVariable("S1")]);  // e5 after e1
+    EXPECT_DOUBLE_EQ(1.0, generated[system.getStateIndexForVariable("S2")]);  // e1
+    EXPECT_DOUBLE_EQ(1.0, generated[system.getStateIndexForVariable("S3")]);  // e3 after e1
+    EXPECT_DOUBLE_EQ(0.0, generated[system.getStateIndexForVariable("S4")]);  // e4 at the trigger time
+    EXPECT_DOUBLE_EQ(0.0, generated[system.getStateIndexForVariable("S5")]);  // e2 is true initially
+  }
+
+  TEST_F(StandaloneCodeGeneratorTest, delayedEventsAreRejected) {
+    load(MODEL_DELAYED_EVENT);
+    SBMLSystem system(model);
+    std::ostringstream os;
+    EXPECT_THROW(StandaloneCodeGenerator::generateHeader(os, system, "model", "generated"), std::runtime_error);
+  }
+
+}  // namespace
@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "sbmlsim/SBMLSim.h"
+#include "sbmlsim/internal/solver/SteadyStateSolver.h"
+
+namespace {
+
+  using state = SteadyStateSolver::state;
+  using matrix = SteadyStateSolver::matrix;
+
+  // -> S at k0 * p and S -> at k1 * S, with the feedback p = 1 / (1 + S^2) by an assignment rule; S = 1 at steady state
+  const char *MODEL_FEEDBACK_ASSIGNMENT_RULE =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"feedbackAssignmentRule\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"S\" compartment=\"compartment\" initialAmount=\"0\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k0\" value=\"2\"/>"
+      "      <parameter id=\"k1\" value=\"1\"/>"
+      "      <parameter id=\"p\" value=\"0\" constant=\"false\"/>"
+      "    </listOfParameters>"
+      "    <listOfRules>"
+      "      <assignmentRule variable=\"p\">"
+      "        <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "          <apply><divide/><cn> 1 </cn>"
+      "            <apply><plus/><cn> 1 </cn><apply><power/><ci> S </ci><cn> 2 </cn></apply></apply>"
+      "          </apply>"
+      "        </math>"
+      "      </assignmentRule>"
+      "    </listOfRules>"
+      "    <listOfReactions>"
+      "      <reaction id=\"production\" reversible=\"false\">"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"S\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k0 </ci><ci> p </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "      <reaction id=\"degradation\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"S\"/>"
+      "        </listOfReactants>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> S </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  // A -> B at k1 * A and B -> A at k2 * B; A + B = 3 is conserved and A = 1 at steady state
+  const char *MODEL_CONSERVED_TOTAL =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"conservedTotal\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"A\" compartment=\"compartment\" initialAmount=\"3\"/>"
+      "      <species id=\"B\" compartment=\"compartment\" initialAmount=\"0\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"2\"/>"
+      "      <parameter id=\"k2\" value=\"1\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"forward\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> A </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "      <reaction id=\"backward\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k2 </ci><ci> B </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  class SteadyStateSolverTest : public ::testing::Test {};
+
+  TEST_F(SteadyStateSolverTest, newtonOnNonlinearSystem) {
+    // x' = 2 - x^2, y' = x - y
+    auto system = [](const state &x, state &dxdt, double t) {
+      dxdt[0] = 2.0 - x[0] * x[0];
+      dxdt[1] = x[0] - x[1];
+    };
+    auto jacobian = [](const state &x, matrix &J, double t) {
+      J(0, 0) = -2.0 * x[0];
+      J(0, 1) = 0.0;
+      J(1, 0) = 1.0;
+      J(1, 1) = -1.0;
+    };
+    SteadyStateSolver solver(system, jacobian, 1e-12, 1e-10, 1e6);
+    state x0(2);
+    x0[0] = 1.0;
+    x0[1] = 0.0;
+
+    auto result = solver.solve(x0);
+
+    EXPECT_EQ(SteadyStateMethod::NEWTON, result.method);
+    EXPECT_NEAR(std::sqrt(2.0), result.x[0], 1e-9);
+    EXPECT_NEAR(std::sqrt(2.0), result.x[1], 1e-9);
+    EXPECT_LT(result.newtonIterations, 10u);
+    EXPECT_LE(result.residualNorm, 1.0);
+  }
+
+  TEST_F(SteadyStateSolverTest, pseudoTransientContinuationKeepsConservedMoieties) {
+    // A <-> B with k1 = 2, k2 = 1: J is singular, A + B = 1 is conserved
+    auto system = [](const state &x, state &dxdt, double t) {
+      double v = 2.0 * x[0] - x[1];
+      dxdt[0] = -v;
+      dxdt[1] = v;
+    };
+    auto jacobian = [](const state &x, matrix &J, double t) {
+      J(0, 0) = -2.0;
+      J(0, 1) = 1.0;
+      J(1, 0) = 2.0;
+      J(1, 1) = -1.0;
+    };
+    SteadyStateSolver solver(system, jacobian, 1e-12, 1e-10, 1e6);
+    state x0(2);
+    x0[0] = 1.0;
+    x0[1] = 0.0;
+
+    auto result = solver.solve(x0);
+
+    EXPECT_EQ(SteadyStateMethod::PSEUDO_TRANSIENT_CONTINUATION, result.method);
+    EXPECT_NEAR(1.0 / 3.0, result.x[0], 1e-9);
+    EXPECT_NEAR(2.0 / 3.0, result.x[1], 1e-9);
+  }
+
+  TEST_F(SteadyStateSolverTest, newtonReplacesDependentRowsByConservationLaws) {
+    // 2 A <-> B with v = A^2 - B: J is singular, A + 2 B = 1 is conserved, A = 1 / 2 and B = 1 / 4 at steady state
+    auto system = [](const state &x, state &dxdt, double t) {
+      double v = x[0] * x[0] - x[1];
+      dxdt[0] = -2.0 * v;
+      dxdt[1] = v;
+    };
+    auto jacobian = [](const state &x, matrix &J, double t) {
+      J(0, 0) = -4.0 * x[0];
+      J(0, 1) = 2.0;
+      J(1, 0) = 2.0 * x[0];
+      J(1, 1) = -1.0;
+    };
+    SteadyStateSolver solver(system, jacobian, 1e-12, 1e-10, 1e6);
+    matrix stoichiometry(2, 1);
+    stoichiometry(0, 0) = -2.0;
+    stoichiometry(1, 0) = 1.0;
+    solver.setStoichiometryMatrix(stoichiometry);
+    state x0(2);
+    x0[0] = 1.0;
+    x0[1] = 0.0;
+
+    auto result = solver.solve(x0);
+
+    EXPECT_EQ(SteadyStateMethod::NEWTON, result.method);
+    EXPECT_NEAR(0.5, result.x[0], 1e-9);
+    EXPECT_NEAR(0.25, result.x[1], 1e-9);
+    EXPECT_NEAR(1.0, result.x[0] + 2.0 * result.x[1], 1e-12);
+    EXPECT_LT(result.newtonIterations, 10u);
+  }
+
+  TEST_F(SteadyStateSolverTest, fixedVariablesStayPut) {
+    // x' = k - x with k held in the state as a fixed species
+    auto system = [](const state &x, state &dxdt, double t) {
+      dxdt[0] = x[1] - x[0];
+      dxdt[1] = 0.0;
+    };
+    auto jacobian = [](const state &x, matrix &J, double t) {
+      J(0, 0) = -1.0;
+      J(0, 1) = 1.0;
+      J(1, 0) = 0.0;
+      J(1, 1) = 0.0;
+    };
+    SteadyStateSolver solver(system, jacobian, 1e-12, 1e-10, 1e6);
+    state x0(2);
+    x0[0] = 0.0;
+    x0[1] = 3.0;
+
+    auto result = solver.solve(x0);
+
+    EXPECT_EQ(SteadyStateMethod::NEWTON, result.method);
+    EXPECT_NEAR(3.0, result.x[0], 1e-9);
+    EXPECT_DOUBLE_EQ(3.0, result.x[1]);
+  }
+
+  TEST_F(SteadyStateSolverTest, newtonDifferentiatesThroughAssignmentRules) {
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(MODEL_FEEDBACK_ASSIGNMENT_RULE);
+    ModelWrapper model(document->getModel());
+    auto s = SBMLSystem(&model).getStateIndexForVariable("S");
+
+    for (auto method : {JacobianMethod::AUTOMATIC_DIFFERENTIATION, JacobianMethod::SYMBOLIC_DIFFERENTIATION,
+                        JacobianMethod::FINITE_DIFFERENCE}) {
+      RunConfiguration conf(1e6, 1.0, {OutputField("S", OutputType::AMOUNT)}, 1e-12, 1e-10);
+      conf.setJacobianMethod(method);
+
+      auto result = SBMLSim::findSteadyState(document, conf);
+
+      // the feedback through p doubles df/dS at the root; without it Newton stalls and continuation takes over
+      EXPECT_EQ(SteadyStateMethod::NEWTON, result.method) << "method " << static_cast<int>(method);
+      EXPECT_NEAR(1.0, result.x[s], 1e-9) << "method " << static_cast<int>(method);
+      EXPECT_LT(result.newtonIterations, 10u) << "method " << static_cast<int>(method);
+      ASSERT_EQ(std::vector<std::string>({"S"}), result.ids);
+      EXPECT_EQ(result.x[s], result.values[0]);
+    }
+    delete document;
+  }
+
+  TEST_F(SteadyStateSolverTest, newtonKeepsConservedTotalsOfModels) {
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(MODEL_CONSERVED_TOTAL);
+    ModelWrapper model(document->getModel());
+    SBMLSystem system(&model);
+    auto a = system.getStateIndexForVariable("A");
+    auto b = system.getStateIndexForVariable("B");
+    RunConfiguration conf(1e6, 1.0, {OutputField("A", OutputType::AMOUNT)}, 1e-12, 1e-10);
+
+    auto result = SBMLSim::findSteadyState(document, conf);
+
+    EXPECT_EQ(SteadyStateMethod::NEWTON, result.method);
+    EXPECT_NEAR(1.0, result.x[a], 1e-9);
+    EXPECT_NEAR(2.0, result.x[b], 1e-9);
+    delete document;
+  }
+
+}  // namespace
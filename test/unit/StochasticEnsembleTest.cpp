@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "sbmlsim/internal/stochastic/SSASimulator.h"
+#include "sbmlsim/internal/stochastic/StochasticEnsemble.h"
+
+namespace {
+
+  // A -> B with kf * A and B -> A with kb * B, in molecule counts
+  const char *MODEL_ISOMERIZATION =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"isomerization\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"A\" compartment=\"compartment\" initialAmount=\"1000\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"B\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"kf\" value=\"1\"/>"
+      "      <parameter id=\"kb\" value=\"0.5\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"forward\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> kf </ci><ci> A </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "      <reaction id=\"backward\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> kb </ci><ci> B </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  class StochasticEnsembleTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      SBMLReader reader;
+      document = reader.readSBMLFromString(MODEL_ISOMERIZATION);
+      model = new ModelWrapper(document->getModel());
+    }
+    void TearDown() override {
+      delete model;
+      delete document;
+    }
+    SBMLDocument *document;
+    ModelWrapper *model;
+  };
+
+  TEST_F(StochasticEnsembleTest, isIndependentOfThreadCount) {
+    SBMLSystem system(model);
+    std::vector<ObserveTarget> targets {ObserveTarget("A", system.getStateIndexForVariable("A")),
+                                        ObserveTarget("B", system.getStateIndexForVariable("B"))};
+    std::function<SSASimulator(SBMLSystem &)> factory = [](SBMLSystem &system) {
+      return SSASimulator(system, 12345);
+    };
+    StochasticEnsemble serial(system, targets, 1);
+    StochasticEnsemble parallel(system, targets, 4);
+    auto expected = serial.run(500, 0.0, 1.0, 0.5, factory);
+    auto actual = parallel.run(500, 0.0, 1.0, 0.5, factory);
+
+    ASSERT_EQ(3u, actual.times.size());
+    EXPECT_EQ(std::vector<std::string>({"A", "B"}), actual.ids);
+    EXPECT_EQ(500u, actual.numTrajectories);
+    EXPECT_EQ(expected.means, actual.means);
+    EXPECT_EQ(expected.variances, actual.variances);
+    EXPECT_DOUBLE_EQ(1000.0, actual.means[0][0]);
+    EXPECT_DOUBLE_EQ(0.0, actual.variances[0][0]);
+    // every molecule is A with p = kb / (kf + kb) + kf / (kf + kb) exp(-(kf + kb) t): binomial(1000, p)
+    double p = 1.0 / 3.0 + 2.0 / 3.0 * std::exp(-1.5);
+    EXPECT_NEAR(1000.0 * p, actual.means[2][0], 3.0);
+    EXPECT_NEAR(1000.0 * (1.0 - p), actual.means[2][1], 3.0);
+    EXPECT_NEAR(1000.0 * p * (1.0 - p), actual.variances[2][0], 60.0);
+    EXPECT_NEAR(actual.variances[2][0], actual.variances[2][1], 1e-6);
+  }
+
+  TEST_F(StochasticEnsembleTest, trajectoryZeroMatchesASingleRun) {
+    SBMLSystem system(model);
+    auto a = system.getStateIndexForVariable("A");
+    std::vector<ObserveTarget> targets {ObserveTarget("A", a)};
+    std::function<SSASimulator(SBMLSystem &)> factory = [](SBMLSystem &system) {
+      return SSASimulator(system, 12345);
+    };
+    StochasticEnsemble ensemble(system, targets, 2);
+    auto statistics = ensemble.run(1, 0.0, 1.0, 1.0, factory);
+
+    SSASimulator simulator(system, 12345);
+    auto x = system.getInitialState();
+    double t = 0.0;
+    simulator.initialize(x, t);
+    while (simulator.step(x, t, 1.0)) {
+      // nothing to do
+    }
+    EXPECT_EQ(x[a], statistics.means[1][0]);
+  }
+
+}  // namespace
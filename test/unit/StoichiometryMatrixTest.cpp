@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "sbmlsim/internal/system/StoichiometryMatrix.h"
+
+namespace {
+
+  class StoichiometryMatrixTest : public ::testing::Test{};
+
+  TEST_F(StoichiometryMatrixTest, compressedRows) {
+    // S1 -> S2 (r0), S2 -> 2 S3 (r1); state 3 is not touched by any reaction
+    std::vector<StoichiometryEntry> entries {
+        {0, 0, -1.0}, {1, 0, 1.0}, {1, 1, -1.0}, {2, 1, 2.0}
+    };
+    StoichiometryMatrix matrix(4, 2, entries);
+    EXPECT_EQ(4, matrix.getNumNonZeros());
+    EXPECT_EQ(std::vector<unsigned int>({0, 1, 3, 4, 4}), matrix.getRowPointers());
+    EXPECT_EQ(std::vector<unsigned int>({0, 0, 1, 1}), matrix.getColumnIndices());
+  }
+
+  TEST_F(StoichiometryMatrixTest, mergeDuplicates) {
+    // 2 A -> ... written as A + A
+    std::vector<StoichiometryEntry> entries {{0, 0, -1.0}, {0, 0, -1.0}, {1, 0, 0.0}};
+    StoichiometryMatrix matrix(2, 1, entries);
+    EXPECT_EQ(2, matrix.getNumNonZeros());
+    EXPECT_DOUBLE_EQ(-2.0, matrix.getValues()[matrix.findEntry(0, 0)]);
+    EXPECT_DOUBLE_EQ(0.0, matrix.getValues()[matrix.findEntry(1, 0)]);
+  }
+
+  TEST_F(StoichiometryMatrixTest, multiply) {
+    std::vector<StoichiometryEntry> entries {
+        {0, 0, -1.0}, {1, 0, 1.0}, {1, 1, -1.0}, {2, 1, 2.0}
+    };
+    StoichiometryMatrix matrix(4, 2, entries);
+    std::vector<double> v {3.0, 5.0};
+    std::vector<double> y(4, 42.0);
+    matrix.multiply(v.data(), y.data());
+    EXPECT_DOUBLE_EQ(-3.0, y[0]);
+    EXPECT_DOUBLE_EQ(-2.0, y[1]);
+    EXPECT_DOUBLE_EQ(10.0, y[2]);
+    EXPECT_DOUBLE_EQ(0.0, y[3]);
+
+    matrix.setValue(matrix.findEntry(2, 1), 1.0);
+    matrix.multiply(v.data(), y.data());
+    EXPECT_DOUBLE_EQ(5.0, y[2]);
+  }
+
+}  // namespace
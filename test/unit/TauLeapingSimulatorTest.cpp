@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "sbmlsim/internal/stochastic/TauLeapingSimulator.h"
+
+namespace {
+
+  // A -> B with k1 * A and C -> D with k2 * C, in molecule counts
+  const char *MODEL_TWO_DECAYS =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"twoDecays\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"A\" compartment=\"compartment\" initialAmount=\"100000\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"B\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"C\" compartment=\"compartment\" initialAmount=\"5\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"D\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"0.1\"/>"
+      "      <parameter id=\"k2\" value=\"1\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> A </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "      <reaction id=\"reaction2\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"C\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"D\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k2 </ci><ci> C </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  // A -> B with k1 * A and A -> C with k2 * A, in molecule counts
+  const char *MODEL_COMPETING_DECAYS =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+      "<sbml xmlns=\"http://www.sbml.org/sbml/level2/version4\" level=\"2\" version=\"4\">"
+      "  <model id=\"competingDecays\">"
+      "    <listOfCompartments>"
+      "      <compartment id=\"compartment\" size=\"1\"/>"
+      "    </listOfCompartments>"
+      "    <listOfSpecies>"
+      "      <species id=\"A\" compartment=\"compartment\" initialAmount=\"12\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"B\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "      <species id=\"C\" compartment=\"compartment\" initialAmount=\"0\" hasOnlySubstanceUnits=\"true\"/>"
+      "    </listOfSpecies>"
+      "    <listOfParameters>"
+      "      <parameter id=\"k1\" value=\"1\"/>"
+      "      <parameter id=\"k2\" value=\"1\"/>"
+      "    </listOfParameters>"
+      "    <listOfReactions>"
+      "      <reaction id=\"reaction1\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"B\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k1 </ci><ci> A </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "      <reaction id=\"reaction2\" reversible=\"false\">"
+      "        <listOfReactants>"
+      "          <speciesReference species=\"A\"/>"
+      "        </listOfReactants>"
+      "        <listOfProducts>"
+      "          <speciesReference species=\"C\"/>"
+      "        </listOfProducts>"
+      "        <kineticLaw>"
+      "          <math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+      "            <apply><times/><ci> k2 </ci><ci> A </ci></apply>"
+      "          </math>"
+      "        </kineticLaw>"
+      "      </reaction>"
+      "    </listOfReactions>"
+      "  </model>"
+      "</sbml>";
+
+  class TauLeapingSimulatorTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+      SBMLReader reader;
+      document = reader.readSBMLFromString(MODEL_TWO_DECAYS);
+      model = new ModelWrapper(document->getModel());
+    }
+    void TearDown() override {
+      delete model;
+      delete document;
+    }
+    SBMLDocument *document;
+    ModelWrapper *model;
+  };
+
+  TEST_F(TauLeapingSimulatorTest, leapsOverLargeCounts) {
+    SBMLSystem system(model);
+    TauLeapingSimulator simulator(system, 12345);
+    auto x = system.getInitialState();
+    auto a = system.getStateIndexForVariable("A");
+    auto b = system.getStateIndexForVariable("B");
+    auto c = system.getStateIndexForVariable("C");
+    x[a] = 1e6;
+    x[c] = 0.0;
+    double t = 0.0;
+    simulator.initialize(x, t);
+    while (simulator.step(x, t, 1.0)) {
+      // nothing to do
+    }
+
+    // binomial(1e6, exp(-0.1)): standard deviation 293
+    EXPECT_DOUBLE_EQ(1e6, x[a] + x[b]);
+    EXPECT_NEAR(1e6 * std::exp(-0.1), x[a], 3000.0);
+    EXPECT_EQ(x[b], simulator.getNumFirings());
+    EXPECT_LT(simulator.getNumLeaps(), simulator.getNumFirings() / 100);
+    EXPECT_EQ(0u, simulator.getNumExactSteps());
+  }
+
+  TEST_F(TauLeapingSimulatorTest, firesCriticalReactionsOneAtATime) {
+    SBMLSystem system(model);
+    TauLeapingSimulator simulator(system, 12345);
+    auto x = system.getInitialState();
+    auto a = system.getStateIndexForVariable("A");
+    auto b = system.getStateIndexForVariable("B");
+    auto c = system.getStateIndexForVariable("C");
+    auto d = system.getStateIndexForVariable("D");
+    double t = 0.0;
+    simulator.initialize(x, t);
+    bool running = true;
+    while (running) {
+      double before = x[c];
+      running = simulator.step(x, t, 10.0);
+      // with fewer molecules of C than CRITICAL_FIRINGS its decay is critical, while A keeps leaping
+      EXPECT_LE(before - x[c], 1.0);
+      EXPECT_GE(x[c], 0.0);
+    }
+
+    EXPECT_DOUBLE_EQ(0.0, x[c]);
+    EXPECT_DOUBLE_EQ(5.0, x[d]);
+    EXPECT_DOUBLE_EQ(1e5, x[a] + x[b]);
+    EXPECT_EQ(x[b] + x[d], simulator.getNumFirings());
+    EXPECT_LT(simulator.getNumLeaps(), simulator.getNumFirings() / 100);
+  }
+
+  TEST(TauLeapingSimulatorHalvingTest, switchesToExactStepsWhenTheHalvedTauIsTooShort) {
+    SBMLReader reader;
+    SBMLDocument *document = reader.readSBMLFromString(MODEL_COMPETING_DECAYS);
+    ModelWrapper model(document->getModel());
+    SBMLSystem system(&model);
+    auto a = system.getStateIndexForVariable("A");
+
+    // with epsilon = 1 the first tau is 0.5, just above EXACT_THRESHOLD / a_0 = 10 / 24; both reactions may fire
+    // up to 12 times, so the leap overdraws A with probability 0.42 and the halved tau is below the threshold
+    unsigned int numExact = 0;
+    for (unsigned long stream = 0; stream < 50; stream++) {
+      TauLeapingSimulator simulator(system, 12345, 1.0);
+      simulator.setStream(stream);
+      auto x = system.getInitialState();
+      double t = 0.0;
+      simulator.initialize(x, t);
+      simulator.step(x, t, 100.0);
+
+      EXPECT_GE(x[a], 0.0);
+      if (simulator.getNumExactSteps() > 0) {
+        EXPECT_EQ(1u, simulator.getNumFirings());
+        EXPECT_EQ(0u, simulator.getNumLeaps());
+        numExact++;
+      }
+    }
+    EXPECT_GT(numExact, 5u);
+    delete document;
+  }
+
+}  // namespace
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include "sbmlsim/internal/util/ThreadPool.h"
+
+namespace {
+
+  class ThreadPoolTest : public ::testing::Test {};
+
+  TEST_F(ThreadPoolTest, runsEveryIndexOnce) {
+    ThreadPool pool(4);
+    EXPECT_EQ(4u, pool.getNumThreads());
+    std::vector<std::atomic<unsigned int> > runs(1000);
+    for (auto &r : runs) {
+      r = 0;
+    }
+    std::vector<unsigned long> workers(1000);
+    for (auto loop = 0; loop < 3; loop++) {
+      pool.parallelFor(runs.size(), [&](unsigned long i, unsigned int worker) {
+        runs[i]++;
+        workers[i] = worker;
+      });
+    }
+    for (auto i = 0; i < runs.size(); i++) {
+      EXPECT_EQ(3u, runs[i]);
+      EXPECT_GT(4u, workers[i]);
+    }
+  }
+
+  TEST_F(ThreadPoolTest, rethrowsTheFirstException) {
+    ThreadPool pool(2);
+    EXPECT_THROW(pool.parallelFor(100, [](unsigned long i, unsigned int) {
+      if (i == 10) {
+        throw std::runtime_error("task failed");
+      }
+    }), std::runtime_error);
+
+    // the pool stays usable
+    std::atomic<unsigned long> sum(0);
+    pool.parallelFor(10, [&](unsigned long i, unsigned int) {
+      sum += i;
+    });
+    EXPECT_EQ(45u, sum);
+  }
+
+}  // namespace
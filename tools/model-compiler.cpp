@@ -0,0 +1,62 @@
+#include <sbml/SBMLTypes.h>
+#include <sbmlsim/internal/codegen/StandaloneCodeGenerator.h>
+#include <sbmlsim/internal/system/SBMLSystem.h>
+#include <sbmlsim/internal/wrapper/ModelWrapper.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+void usage(const string &bin);
+
+int main(int argc, const char* argv[]) {
+  if (argc < 4) {
+    usage(string(argv[0]));
+    return 1;
+  }
+
+  string sbmlPath(argv[1]);
+  string outputDir(argv[2]);
+  string name(argv[3]);
+  string ns = argc > 4 ? string(argv[4]) : name;
+
+  SBMLReader reader;
+  SBMLDocument *document = reader.readSBMLFromFile(sbmlPath);
+  if (document->getModel() == NULL) {
+    cerr << "cannot read a model from " << sbmlPath << endl;
+    delete document;
+    return 1;
+  }
+
+  ModelWrapper *model = new ModelWrapper(document->getModel());
+  SBMLSystem system(model);
+
+  ostringstream header, source;
+  try {
+    StandaloneCodeGenerator::generateHeader(header, system, name, ns);
+    StandaloneCodeGenerator::generateSource(source, system, name, ns);
+  } catch (const runtime_error &e) {
+    cerr << sbmlPath << ": " << e.what() << endl;
+    delete model;
+    delete document;
+    return 1;
+  }
+
+  ofstream headerFile(outputDir + "/" + name + ".h");
+  headerFile << header.str();
+  ofstream sourceFile(outputDir + "/" + name + ".cpp");
+  sourceFile << source.str();
+
+  delete model;
+  delete document;
+
+  return headerFile && sourceFile ? 0 : 1;
+}
+
+void usage(const string &bin) {
+  cout << "Usage: " << bin << " [sbml] [outputDir] [name] [namespace]" << endl;
+  cout << "Example: " << bin << " 00001-sbml-l2v4.xml ./generated model00001" << endl;
+}